@@ -0,0 +1,289 @@
+#include <ipinfo/ipinfo.hpp>
+#include <fmt/core.h>
+#include <string>
+#include <vector>
+#include <thread>
+#include <latch>
+#include <chrono>
+#include <memory>
+#include <random>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+namespace app
+{
+    const std::size_t IPS_NUM{ 100000u };
+    const std::size_t LOOKUPS_PER_THREAD{ 500000u };
+    const std::vector<std::size_t> THREADS_NUMS{ 1u, 2u, 4u, 8u, 16u, 32u, 64u };
+
+    // Traces of the hit ratio: repeat visitors are drawn by Zipf's law
+    // from a set of IPs, a scan is a run of IPs which are seen once.
+
+    const std::size_t TRACE_LEN{ 2000000u };
+    const std::size_t VISITORS_NUM{ 200000u };
+    const double ZIPF_EXPONENT{ 0.9 };
+    const std::size_t SCAN_PERIOD{ 50000u }; // visits between scans
+    const std::size_t SCAN_LEN{ 20000u };
+    const std::size_t HIT_RATIO_CACHE_ENTRIES{ 16384u };
+
+    std::vector<std::string> make_ips();
+
+    // the scan's length is zero for the trace without scans
+    std::vector<std::string> make_trace(const std::size_t scan_len);
+
+    ipinfo::usr::informer make_informer(
+        const std::shared_ptr<ipinfo::usr::cache> &cache);
+
+    void warm_cache(
+        const std::shared_ptr<ipinfo::usr::cache> &cache,
+        const std::vector<std::string> &ips);
+
+    double run_lookups(
+        const std::shared_ptr<ipinfo::usr::cache> &cache,
+        const std::vector<std::string> &ips,
+        const std::size_t threads_num);
+
+    void bench_cache(
+        const std::vector<std::string> &ips,
+        const std::size_t shards_num);
+
+    double run_trace(
+        const std::vector<std::string> &trace,
+        const std::uint8_t admission_id);
+
+    void bench_hit_ratio();
+}
+
+int
+main(void)
+{
+    // Every thread has its own informer, all of them share one cache.
+    // Hosts are excluded, thus nothing goes to the network: results are
+    // empty, but a lookup takes the same path through the cache.
+
+    const std::vector<std::string> ips{ app::make_ips() };
+
+    app::bench_cache(ips, 1u); // one lock for the whole cache
+    app::bench_cache(ips, ipi::als::C::DEFAULT_CACHE_SHARDS_NUM);
+
+    app::bench_hit_ratio();
+
+    return 0;
+}
+
+std::vector<std::string>
+app::make_ips()
+{
+    std::vector<std::string> ips{};
+    ips.reserve(IPS_NUM);
+
+    // public IPs, private ones are answered by the classifier
+    // before the cache is looked up
+
+    for (std::size_t i{ 0u }; i < IPS_NUM; i++)
+    {
+        ips.push_back(fmt::format("13.{}.{}.{}",
+            (i >> 16u) & 0xFFu, (i >> 8u) & 0xFFu, i & 0xFFu));
+    }
+
+    return ips;
+}
+
+std::vector<std::string>
+app::make_trace(const std::size_t scan_len)
+{
+    std::mt19937_64 rng{ 42u }; // traces are the same from run to run
+    std::vector<double> cdf(VISITORS_NUM);
+    double sum{ 0.0 };
+
+    for (std::size_t i{ 0u }; i < VISITORS_NUM; i++)
+    {
+        sum += 1.0 / std::pow(static_cast<double>(i + 1u), ZIPF_EXPONENT);
+        cdf[i] = sum;
+    }
+
+    std::uniform_real_distribution<double> dist{ 0.0, sum };
+    std::vector<std::string> trace{};
+    std::size_t scanned{ 0u };
+
+    trace.reserve(TRACE_LEN);
+
+    while (trace.size() < TRACE_LEN)
+    {
+        const std::size_t rank {
+            static_cast<std::size_t>(std::lower_bound(cdf.begin(), cdf.end(), dist(rng)) - cdf.begin())
+        };
+
+        trace.push_back(fmt::format("11.{}.{}.{}",
+            (rank >> 16u) & 0xFFu, (rank >> 8u) & 0xFFu, rank & 0xFFu));
+
+        if (0u == scan_len or 0u != trace.size() % SCAN_PERIOD)
+        {
+            continue;
+        }
+
+        for (std::size_t i{ 0u }; i < scan_len and trace.size() < TRACE_LEN; i++, scanned++)
+        {
+            trace.push_back(fmt::format("12.{}.{}.{}",
+                (scanned >> 16u) & 0xFFu, (scanned >> 8u) & 0xFFu, scanned & 0xFFu));
+        }
+    }
+
+    return trace;
+}
+
+ipinfo::usr::informer
+app::make_informer(const std::shared_ptr<ipinfo::usr::cache> &cache)
+{
+    ipinfo::usr::informer infr{};
+
+    infr.set_lang(ipi::als::C::AVAILABLE_LANGS_IDS::ENGLISH);
+    infr.exclude_hosts({
+        ipi::als::C::AVAILABLE_HOSTS_IDS::IP_API_COM,
+        ipi::als::C::AVAILABLE_HOSTS_IDS::IPWHOIS_APP
+    });
+    infr.set_cache(cache);
+
+    return infr;
+}
+
+void
+app::warm_cache(
+    const std::shared_ptr<ipinfo::usr::cache> &cache,
+    const std::vector<std::string> &ips)
+{
+    ipinfo::usr::informer infr{ make_informer(cache) };
+
+    for (const std::string &ip : ips)
+    {
+        infr.set_ip(ip);
+        infr.run();
+    }
+}
+
+double
+app::run_lookups(
+    const std::shared_ptr<ipinfo::usr::cache> &cache,
+    const std::vector<std::string> &ips,
+    const std::size_t threads_num)
+{
+    std::vector<std::thread> threads{};
+    std::latch start{ static_cast<std::ptrdiff_t>(threads_num + 1u) };
+
+    for (std::size_t i{ 0u }; i < threads_num; i++)
+    {
+        threads.emplace_back([&, i] ()
+        {
+            ipinfo::usr::informer infr{ make_informer(cache) };
+            std::uint64_t x{ 0x9E3779B97F4A7C15u * (i + 1u) };
+
+            start.arrive_and_wait();
+
+            for (std::size_t n{ 0u }; n < LOOKUPS_PER_THREAD; n++)
+            {
+                // xorshift, so the IPs' order isn't the same for threads
+                x ^= x << 13u;
+                x ^= x >> 7u;
+                x ^= x << 17u;
+
+                infr.set_ip(ips[x % ips.size()]);
+                infr.run();
+            }
+        });
+    }
+
+    const auto begin{ std::chrono::steady_clock::now() };
+    start.arrive_and_wait();
+
+    for (std::thread &thrd : threads)
+    {
+        thrd.join();
+    }
+
+    const std::chrono::duration<double> elapsed {
+        std::chrono::steady_clock::now() - begin
+    };
+
+    return static_cast<double>(threads_num * LOOKUPS_PER_THREAD) / elapsed.count();
+}
+
+void
+app::bench_cache(
+    const std::vector<std::string> &ips,
+    const std::size_t shards_num)
+{
+    const auto cache {
+        std::make_shared<ipinfo::usr::cache>(
+            ipi::als::C::DEFAULT_CACHE_MAX_ENTRIES * 2u,
+            ipi::als::C::DEFAULT_CACHE_MAX_BYTES * 4u,
+            ipi::als::C::DEFAULT_CACHE_TTL,
+            shards_num)
+    };
+
+    warm_cache(cache, ips);
+
+    fmt::print("shards: {}\n", shards_num);
+    fmt::print("{:>8} {:>16} {:>16}\n", "threads", "lookups/s", "per thread");
+
+    for (const std::size_t threads_num : THREADS_NUMS)
+    {
+        const double rate{ run_lookups(cache, ips, threads_num) };
+
+        fmt::print("{:>8} {:>16.0f} {:>16.0f}\n",
+            threads_num, rate, rate / static_cast<double>(threads_num));
+    }
+
+    const ipinfo::usr::types::cache_stats stats{ cache->get_stats() };
+
+    fmt::print("hits: {}, misses: {}, evictions: {}\n\n",
+        stats.hits, stats.misses, stats.evictions);
+}
+
+double
+app::run_trace(
+    const std::vector<std::string> &trace,
+    const std::uint8_t admission_id)
+{
+    const auto cache {
+        std::make_shared<ipinfo::usr::cache>(
+            HIT_RATIO_CACHE_ENTRIES,
+            ipi::als::C::DEFAULT_CACHE_MAX_BYTES,
+            ipi::als::C::DEFAULT_CACHE_TTL)
+    };
+
+    // neighbours would be hits by their network's result
+    cache->set_range_prefixes(0u, 0u);
+    cache->set_admission(admission_id);
+
+    ipinfo::usr::informer infr{ make_informer(cache) };
+
+    for (const std::string &ip : trace)
+    {
+        infr.set_ip(ip);
+        infr.run();
+    }
+
+    const ipinfo::usr::types::cache_stats stats{ cache->get_stats() };
+
+    return static_cast<double>(stats.hits) / static_cast<double>(stats.hits + stats.misses);
+}
+
+void
+app::bench_hit_ratio()
+{
+    const std::vector<std::string> zipf{ make_trace(0u) };
+    const std::vector<std::string> zipf_scan{ make_trace(SCAN_LEN) };
+
+    fmt::print("hit ratio, {} entries\n", HIT_RATIO_CACHE_ENTRIES);
+    fmt::print("{:>12} {:>10} {:>10}\n", "trace", "always", "tinylfu");
+
+    fmt::print("{:>12} {:>10.4f} {:>10.4f}\n", "zipf",
+        run_trace(zipf, ipi::als::C::CACHE_ADMISSIONS_IDS::ALWAYS),
+        run_trace(zipf, ipi::als::C::CACHE_ADMISSIONS_IDS::TINY_LFU));
+
+    fmt::print("{:>12} {:>10.4f} {:>10.4f}\n", "zipf+scan",
+        run_trace(zipf_scan, ipi::als::C::CACHE_ADMISSIONS_IDS::ALWAYS),
+        run_trace(zipf_scan, ipi::als::C::CACHE_ADMISSIONS_IDS::TINY_LFU));
+}
@@ -0,0 +1,4 @@
+#!/bin/env bash
+
+make prepare &&
+make
@@ -0,0 +1,163 @@
+#include <ipinfo/ipinfo.hpp>
+#include <fmt/core.h>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+// Compiles looked up results to the database of 'usr::database':
+//
+//   ipinfo_builder -o <file> [-l <lang>] [-g]
+//                  [-d <database>] [-c <cache file>] [-a <host> <answers>] ...
+//
+//   -o  the database to write, it's replaced atomically
+//   -l  only results in the language are taken from the cache's file
+//   -g  IPs of a network with the same record are merged over the gaps
+//   -d  a database which is built before (the incremental rebuild)
+//   -c  a file of the cache ('cache::open_file()')
+//   -a  a dump of the host's answers, one JSON answer per line
+//
+// Sources are added in the order of the arguments, later ones override
+// earlier ones, so the previous database goes first.
+
+namespace app
+{
+    enum SOURCES_IDS : std::uint8_t
+    {
+        DATABASE = 0u,
+        CACHE_FILE,
+        ANSWERS
+    };
+
+    struct source
+    {
+        std::uint8_t id{ SOURCES_IDS::DATABASE };
+        std::string path{};
+        std::string host{}; // of answers
+    };
+
+    struct options
+    {
+        std::string out_path{};
+        std::string lang{};
+        bool is_gaps_filling{ false };
+        std::vector<source> sources{};
+    };
+
+    void print_usage();
+    bool parse_args(const std::vector<std::string_view> &args, options &opts);
+    bool add_source(ipinfo::usr::database_builder &builder, const source &src);
+}
+
+int
+main(int argc, char **argv)
+{
+    app::options opts{};
+
+    if (not app::parse_args({ argv + 1, argv + argc }, opts))
+    {
+        app::print_usage();
+        return 1;
+    }
+
+    ipinfo::usr::database_builder builder{};
+
+    builder.set_lang(opts.lang);
+    builder.set_gaps_filling(opts.is_gaps_filling);
+
+    for (const app::source &src : opts.sources)
+    {
+        const std::size_t added_num{ builder.get_added_num() };
+
+        if (not app::add_source(builder, src))
+        {
+            fmt::print(stderr, "{:s}: {:s}\n", src.path, builder.get_last_error().desc);
+            return 1;
+        }
+
+        fmt::print("{:s}: {:d} added\n", src.path, builder.get_added_num() - added_num);
+    }
+
+    if (not builder.write(opts.out_path))
+    {
+        fmt::print(stderr, "{:s}: {:s}\n", opts.out_path, builder.get_last_error().desc);
+        return 1;
+    }
+
+    fmt::print("{:s}: {:d} ranges, {:d} records\n",
+        opts.out_path, builder.get_ranges_num(), builder.get_records_num());
+
+    return 0;
+}
+
+void
+app::print_usage()
+{
+    fmt::print(stderr,
+        "usage: ipinfo_builder -o <file> [-l <lang>] [-g]\n"
+        "                      [-d <database>] [-c <cache file>] [-a <host> <answers>] ...\n");
+}
+
+bool
+app::parse_args(
+    const std::vector<std::string_view> &args,
+    app::options &opts)
+{
+    for (std::size_t i{ 0u }; i < args.size(); i++)
+    {
+        const std::string_view arg{ args[i] };
+        const std::size_t rest{ args.size() - i - 1u };
+
+        if ("-g" == arg)
+        {
+            opts.is_gaps_filling = true;
+        }
+        else if ("-a" == arg and 2u <= rest)
+        {
+            opts.sources.push_back({
+                .id{ SOURCES_IDS::ANSWERS },
+                .path{ std::string{ args[i + 2u] } },
+                .host{ std::string{ args[i + 1u] } }
+            });
+
+            i += 2u;
+        }
+        else if ("-o" == arg and 1u <= rest)
+        {
+            opts.out_path = args[++i];
+        }
+        else if ("-l" == arg and 1u <= rest)
+        {
+            opts.lang = args[++i];
+        }
+        else if (1u <= rest and ("-d" == arg or "-c" == arg))
+        {
+            opts.sources.push_back({
+                .id{ "-d" == arg ? SOURCES_IDS::DATABASE : SOURCES_IDS::CACHE_FILE },
+                .path{ std::string{ args[++i] } }
+            });
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    return not opts.out_path.empty() and not opts.sources.empty();
+}
+
+bool
+app::add_source(
+    ipinfo::usr::database_builder &builder,
+    const app::source &src)
+{
+    switch (src.id)
+    {
+        case SOURCES_IDS::DATABASE:   return builder.add_database(src.path);
+        case SOURCES_IDS::CACHE_FILE: return builder.add_cache_file(src.path);
+        case SOURCES_IDS::ANSWERS:    return builder.add_answers(src.path, src.host);
+
+        default: return false;
+    }
+}
@@ -1,6 +1,9 @@
 #include <ipinfo/ipinfo.hpp>
 #include <fmt/core.h>
 #include <string>
+#include <vector>
+#include <future>
+#include <memory>
 #include <cstdint>
 
 namespace app
@@ -12,12 +15,27 @@ namespace app
     void show_ip_info_ex(
         const std::string &ip,
         const std::string &lang);
+
+    void show_batch_info(
+        const std::vector<std::string> &ips,
+        const std::string &lang);
+
+    void show_engine_info(
+        const std::vector<std::string> &ips,
+        const std::string &lang);
+
+    void show_cached_info(
+        const std::string &ip,
+        const std::string &lang);
 }
 
 int
 main(void)
 {
     // app::show_ip_info("8.8.8.8", "english");
+    // app::show_batch_info({ "8.8.8.8", "1.1.1.1" }, "english");
+    // app::show_engine_info({ "8.8.8.8", "1.1.1.1" }, "english");
+    // app::show_cached_info("8.8.8.8", "english");
     app::show_ip_info_ex("2001:4860:4860::888", "russian");
 
     return 0;
@@ -43,6 +61,9 @@ app::show_ip_info(
         { ipi::als::C::AVAILABLE_HOSTS_IDS::IPWHOIS_APP, {} }
     });
 
+    // All hosts are requested at the same time in the concurrent mode.
+    infr.set_run_mode(ipi::als::C::RUN_MODES_IDS::CONCURRENT);
+
     infr.run();
 
     fmt::print("IP: {:s}\n", infr.get_ip());
@@ -79,6 +100,9 @@ app::show_ip_info(
     fmt::print("Currency exc. rate to USD: {:.2f}\n", infr.get_currency_rates());
     fmt::print("Currency plural: {:s}\n", infr.get_currency_plural());
 
+    // Private and reserved IPs are answered without requests.
+    fmt::print("Reserved: {:d}\n", infr.get_reserved_status());
+
     return;
 }
 
@@ -246,5 +270,93 @@ app::show_ip_info_ex(
     fmt::print(str_fmt, str_cont.desc, str_cont.val,
                bool{ str_cont.is_parsed }, str_cont.host);
 
+    bool_cont = informer.get_reserved_status_ex();
+    fmt::print(bool_fmt, bool_cont.desc, bool_cont.val,
+               bool{ bool_cont.is_parsed }, bool_cont.host);
+
+    return;
+}
+
+void
+app::show_batch_info(
+    const std::vector<std::string> &ips,
+    const std::string &lang)
+{
+    // Up to 100 IPs are looked up by a single HTTP request.
+    ipinfo::usr::batch_informer binfr{ ips, lang };
+
+    binfr.run();
+
+    for (const ipinfo::usr::informer &infr : binfr.get_results())
+    {
+        fmt::print("{:s}: {:s}, {:s}\n",
+                   infr.get_ip(), infr.get_country(), infr.get_city());
+    }
+
+    return;
+}
+
+void
+app::show_engine_info(
+    const std::vector<std::string> &ips,
+    const std::string &lang)
+{
+    // Lookups are made by the engine's threads, the calling
+    // thread only waits for the futures at the end.
+
+    ipinfo::usr::engine eng{};
+    std::vector<std::future<ipinfo::usr::informer>> results{};
+
+    for (const std::string &ip : ips)
+    {
+        results.push_back(eng.submit(ipinfo::usr::informer{ ip, lang }));
+    }
+
+    for (auto &res : results)
+    {
+        const ipinfo::usr::informer infr{ res.get() };
+
+        fmt::print("{:s}: {:s}, {:s}\n",
+                   infr.get_ip(), infr.get_country(), infr.get_city());
+    }
+
+    return;
+}
+
+void
+app::show_cached_info(
+    const std::string &ip,
+    const std::string &lang)
+{
+    // The second run is answered by the cache without any request.
+
+    const auto cache{ std::make_shared<ipinfo::usr::cache>() };
+    ipinfo::usr::informer infr{ ip, lang };
+
+    // Results survive a restart, if the cache is backed by a file.
+    // if (not cache->open_file("ipinfo_cache.bin"))
+    // {
+    //     fmt::print("{:s}\n", cache->get_last_error().desc);
+    // }
+
+    infr.set_cache(cache);
+
+    // IPs of an offline database are answered before the cache.
+    // const auto db{ std::make_shared<ipinfo::usr::database>() };
+    //
+    // if (db->open("ipinfo.db"))
+    // {
+    //     infr.set_database(db, ipi::als::C::DATABASE_MODES_IDS::PREFERRED);
+    // }
+
+    for (std::uint8_t i{ 0u }; i < 2u; i++)
+    {
+        infr.run();
+        fmt::print("{:s}: {:s}\n", infr.get_ip(), infr.get_country());
+    }
+
+    const ipinfo::usr::types::cache_stats stats{ cache->get_stats() };
+    fmt::print("Cache hits: {}, misses: {}\n", stats.hits, stats.misses);
+
     return;
 }
@@ -5,5 +5,10 @@
 #include "ipinfo_types.hpp"
 #include "ipinfo_aliases.hpp"
 #include "ipinfo_informer.hpp"
+#include "ipinfo_batch_informer.hpp"
+#include "ipinfo_engine.hpp"
+#include "ipinfo_cache.hpp"
+#include "ipinfo_database.hpp"
+#include "ipinfo_database_builder.hpp"
 
 #endif // IPINFO_HPP
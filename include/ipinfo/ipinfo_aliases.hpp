@@ -18,7 +18,9 @@ namespace ipinfo::srv
 {
     class requester;
     class parser;
+    class stream_parser;
     class utiler;
+    class store;
 }
 
 // We couldn't include 'ipinfo_types.hpp' to
@@ -30,11 +32,16 @@ namespace ipinfo::srv::types
 {
     struct info;
     struct request_attributes;
+    struct batch_request_attributes;
+    struct response;
+    struct address;
 }
 
 namespace ipinfo::usr::types
 {
     struct error;
+    struct quota;
+    struct cache_stats;
     template<typename T> struct node;
 }
 
@@ -44,7 +51,11 @@ namespace ipinfo::als
 
     using info = srv::types::info;
     using req_attrs = srv::types::request_attributes;
+    using batch_req_attrs = srv::types::batch_request_attributes;
+    using resp = srv::types::response;
     using err = usr::types::error;
+    using quota = usr::types::quota;
+    using cache_stats = usr::types::cache_stats;
 
     using u8 = std::uint8_t;
     using str = std::string;
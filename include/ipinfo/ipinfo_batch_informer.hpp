@@ -0,0 +1,74 @@
+#ifndef IPINFO_BATCH_INFORMER_HPP
+    #define IPINFO_BATCH_INFORMER_HPP
+
+#include "ipinfo_constants.hpp"
+#include "ipinfo_types.hpp"
+#include "ipinfo_aliases.hpp"
+#include "ipinfo_informer.hpp"
+
+#include <cstdint>
+#include <cstddef>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace ipinfo::usr
+{
+    class batch_informer;
+    class database;
+}
+
+// The batch informer looks up a lot of IPs at once using the batch
+// endpoint of ip-api.com. IPs are splitted into batches of the
+// 'constants::BATCH_MAX_SIZE' size, every batch is sent by one
+// HTTP request. There is one informer per IP in the results.
+// A batch is refused by a failing host and counted by its breaker,
+// as single requests are, its failure is given to its informers.
+
+class ipinfo::usr::batch_informer
+{
+  private:
+    std::vector<std::string> __ips{};
+    std::string __lang{};
+    std::string __api_key{};
+    std::uint8_t __parser_id{ constants::PARSERS_IDS::STREAMING };
+
+    std::shared_ptr<usr::database> __database{};
+    std::uint8_t __database_mode{ constants::DATABASE_MODES_IDS::PREFERRED };
+
+    std::vector<usr::informer> __results{};
+    usr::types::error __error{};
+
+    void __run_batch(
+        const std::vector<std::string>::const_iterator first,
+        const std::vector<std::string>::const_iterator last);
+
+  public:
+    batch_informer() = default;
+
+    batch_informer(
+        const std::vector<std::string> &ips,
+        const std::string &lang);
+
+    void set_ips(const std::vector<std::string> &ips);
+    void add_ip(const std::string &ip);
+
+    void set_lang(const std::string &lang);
+    void set_lang(const std::uint8_t lang_id);
+
+    void set_api_key(const std::string &key);
+    void set_parser(const std::uint8_t parser_id);
+
+    // IPs of the database aren't sent, as reserved ones
+    void set_database(
+        const std::shared_ptr<usr::database> &db,
+        const std::uint8_t mode_id = constants::DATABASE_MODES_IDS::PREFERRED);
+
+    void run();
+
+    const std::vector<usr::informer> &get_results() const;
+    usr::types::error get_last_error() const;
+};
+
+#endif // IPINFO_BATCH_INFORMER_HPP
@@ -0,0 +1,63 @@
+#ifndef IPINFO_BREAKER_HPP
+    #define IPINFO_BREAKER_HPP
+
+#include "ipinfo_constants.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace ipinfo::srv
+{
+    class breaker;
+}
+
+// The breaker keeps a health state of every host for all informers
+// of the process. A failing host is skipped until the cooldown is
+// over, so lookups don't wait for a host which is known to be down.
+
+class ipinfo::srv::breaker
+{
+  public:
+    using clock = std::chrono::steady_clock;
+
+  private:
+    struct __circuit
+    {
+        std::uint8_t state{ constants::BREAKER_STATES_IDS::CLOSED };
+        std::uint32_t failures{ 0u };
+        clock::time_point opened_at{};
+        bool is_probing : (1u) { false };
+    };
+
+    std::mutex __mtx{};
+    std::map<std::string, __circuit> __circuits{};
+
+    std::uint32_t __threshold{ constants::BREAKER_FAILURES_THRESHOLD };
+    std::chrono::milliseconds __cooldown{ constants::BREAKER_COOLDOWN };
+
+    breaker() = default;
+
+  public:
+    breaker(const breaker &) = delete;
+    breaker &operator=(const breaker &) = delete;
+
+    static breaker &instance();
+
+    // Whether the host may be requested now. The caller must
+    // report the result by 'on_success()' or 'on_failure()'.
+    bool allow(const std::string &host);
+
+    void on_success(const std::string &host);
+    void on_failure(const std::string &host);
+    void on_abort(const std::string &host); // the result is unknown
+
+    std::uint8_t get_state(const std::string &host);
+
+    void set_threshold(const std::uint32_t failures);
+    void set_cooldown(const std::chrono::milliseconds &cooldown);
+};
+
+#endif // IPINFO_BREAKER_HPP
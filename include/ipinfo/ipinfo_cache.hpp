@@ -0,0 +1,340 @@
+#ifndef IPINFO_CACHE_HPP
+    #define IPINFO_CACHE_HPP
+
+#include "ipinfo_constants.hpp"
+#include "ipinfo_types.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace ipinfo::srv
+{
+    class loop;
+    class store;
+    class sketch;
+}
+
+namespace ipinfo::usr
+{
+    class cache;
+    class informer;
+}
+
+namespace ipinfo::test
+{
+    struct cache_access; // the cache's check of 'make check'
+}
+
+// The cache keeps results of lookups in memory, thus a repeated lookup
+// doesn't go to the network. A result is keyed by the IP, the language
+// and the set of hosts which are asked, because the set defines which
+// fields are filled.
+//
+// The cache is attached to informers by 'informer::set_cache()', one
+// cache may be shared by many informers on many threads.
+//
+// Entries are spread over shards by the IP's hash, every shard has its
+// own lock, so threads don't wait for each other unless they hit the
+// same shard. A hit takes the shard's lock in the shared mode: instead
+// of being moved to the list's head, the entry is marked as referenced,
+// and the eviction gives a referenced entry a second chance.
+//
+// Besides the IP's own entry, the result is stored for the IP's network
+// (a /24 for IPv4 and a /48 for IPv6 by default), so a neighbouring IP
+// is answered without a request. Fields which belong to the address
+// (the IP and its reverse DNS) aren't taken from the neighbour.
+//
+// The cache may be backed by a file, so results survive a restart: the
+// file is mapped when it's opened, a result which isn't in memory is read
+// from the file, and new results are appended to it.
+//
+// Failed lookups are kept in memory with the TTL of their errors' class
+// ('NEGATIVE_CACHE_CLASSES_IDS'), a hit gives the same errors back.
+//
+// A result is stale after the soft TTL: a hit returns it at once and
+// schedules a refresh of it on the cache's own thread, the refreshed
+// result replaces the stale one unless the refresh fails.
+//
+// An admission policy may be set ('CACHE_ADMISSIONS_IDS'), TinyLFU
+// keeps a frequency sketch of every shard's lookups: a new result
+// of a full shard is dropped if the eviction's victim is more popular.
+//
+// Concurrent misses of the same key are coalesced: the first informer
+// sends requests, others wait for its result instead of sending their
+// own ones (a "flight" of the key).
+
+class ipinfo::usr::cache
+{
+    friend class usr::informer;
+    friend class srv::loop;
+    friend struct test::cache_access;
+
+  private:
+    using clock = std::chrono::steady_clock;
+    using errors_map = std::map<std::string, usr::types::error>;
+
+    struct __entry
+    {
+        std::string key{};
+        srv::types::info info{};
+        errors_map errors{}; // the failed lookup's errors by hosts
+        std::size_t bytes{ 0u };
+        clock::time_point refresh_at{}; // it's the expiration for failed lookups
+        clock::time_point expires_at{};
+        mutable std::atomic<bool> is_referenced{ false };
+        mutable std::atomic<bool> is_refreshing{ false };
+    };
+
+    using entry_it = std::list<__entry>::iterator;
+
+    // the result of the flight is set once, under its lock
+    struct __flight
+    {
+        std::mutex mtx{};
+        std::condition_variable cv{};
+        bool is_landed{ false };
+        bool is_abandoned{ false }; // landed without a result
+        srv::types::info info{};
+        errors_map errors{};
+    };
+
+    using flight_ptr = std::shared_ptr<__flight>;
+
+    struct alignas(64) __shard
+    {
+        mutable std::shared_mutex mtx{};
+
+        // the newest entry is the first one, keys of the
+        // index refer to keys of the entries
+        std::list<__entry> entries{};
+        std::unordered_map<std::string_view, entry_it> index{};
+
+        std::size_t entries_num{ 0u };
+        std::size_t bytes{ 0u };
+
+        // hits and misses are counted under the shared lock
+        mutable std::atomic<std::uint64_t> hits{ 0u };
+        mutable std::atomic<std::uint64_t> misses{ 0u };
+        mutable std::atomic<std::uint64_t> expirations{ 0u };
+        mutable std::atomic<std::uint64_t> range_hits{ 0u };
+        mutable std::atomic<std::uint64_t> file_hits{ 0u };
+        mutable std::atomic<std::uint64_t> negative_hits{ 0u };
+        mutable std::atomic<std::uint64_t> refreshes{ 0u };
+        std::uint64_t evictions{ 0u };
+        std::uint64_t rejections{ 0u };
+
+        // frequencies of the keys' lookups, it's null unless
+        // the admission is TinyLFU, it's set under the lock
+        std::unique_ptr<srv::sketch> sketch{};
+
+        // flights of the shard's keys, they have their own lock,
+        // so a flight doesn't hold the entries' one
+        std::mutex flights_mtx{};
+        std::unordered_map<std::string, flight_ptr> flights{};
+        std::atomic<std::uint64_t> coalesced{ 0u };
+    };
+
+    std::unique_ptr<__shard[]> __shards{};
+    std::size_t __shards_num{ 0u };
+
+    // limits of a shard
+    std::atomic<std::size_t> __max_entries{ 0u };
+    std::atomic<std::size_t> __max_bytes{ 0u };
+    std::atomic<clock::duration::rep> __ttl{ 0 };
+    std::atomic<clock::duration::rep> __soft_ttl{ 0 };
+    std::array<std::atomic<clock::duration::rep>, constants::NEGATIVE_CACHE_CLASSES_NUM> __negative_ttls{};
+
+    std::atomic<std::uint8_t> __v4_prefix_len{ constants::DEFAULT_CACHE_V4_PREFIX_LEN };
+    std::atomic<std::uint8_t> __v6_prefix_len{ constants::DEFAULT_CACHE_V6_PREFIX_LEN };
+
+    std::unique_ptr<srv::store> __store{};
+
+    std::atomic<std::size_t> __max_refreshes{ constants::DEFAULT_CACHE_MAX_REFRESHES };
+    std::atomic<std::size_t> __refreshes_num{ 0u }; // in flight
+
+    // It's started by the first refresh. It's the last member, so it's
+    // stopped before the members which its callbacks use are destroyed.
+    std::once_flag __refresher_once{};
+    std::unique_ptr<srv::loop> __refresher{};
+
+    static void __get_key(
+        const std::string &ip,
+        const std::string &lang,
+        const std::uint8_t hosts_mask,
+        std::string &key);
+
+    static std::size_t __get_bytes(const __entry &entry);
+
+    // returns 'NEGATIVE_CACHE_CLASSES_NUM' if the error isn't cached
+    static std::uint8_t __get_error_class(const usr::types::error &err);
+
+    // returns false if the range cache is disabled for the IP's family
+    bool __get_network(const std::string &ip, std::string &network) const;
+
+    __shard &__get_shard(const std::string &ip) const;
+
+    void __erase(__shard &shard, entry_it it);
+    void __erase_prefix(__shard &shard, const std::string &prefix);
+    void __shrink(__shard &shard);
+
+    // The shard's lock is taken. A new entry is admitted if the shard
+    // isn't full or the entry's key is more popular than the victim's.
+    bool __admit(const __shard &shard, const __entry &entry) const;
+
+    // A slot of refreshes is taken for the stale entry, returns
+    // false if there is no free one or the entry is refreshed.
+    bool __reserve_refresh(const __entry &entry);
+
+    // The shard's lock is taken inside, expired entries aren't
+    // returned. A result of the file is moved to the memory.
+    bool __find_key(
+        __shard &shard,
+        const std::string &key,
+        srv::types::info &info,
+        errors_map &errors,
+        bool &is_stale);
+
+    void __insert_key(
+        __shard &shard,
+        const std::string &key,
+        const srv::types::info &info,
+        const errors_map &errors,
+        const clock::duration &ttl);
+
+    // The errors are empty, unless it's a failed lookup's result. If
+    // the result is stale, the caller should pass it to '__refresh()'.
+    bool __find(
+        const std::string &ip,
+        const std::string &lang,
+        const std::uint8_t hosts_mask,
+        srv::types::info &info,
+        errors_map &errors,
+        bool &is_stale);
+
+    // the lookup of the informer is made again in the background
+    void __refresh(
+        const usr::informer &infr,
+        const std::uint8_t hosts_mask);
+
+    void __insert(
+        const std::string &ip,
+        const std::string &lang,
+        const std::uint8_t hosts_mask,
+        const srv::types::info &info,
+        const errors_map &errors);
+
+    // The flight of the key, 'is_leader' is true if it's a new one:
+    // then the caller sends requests and lands it, whatever happens.
+    flight_ptr __join(
+        const std::string &ip,
+        const std::string &lang,
+        const std::uint8_t hosts_mask,
+        bool &is_leader);
+
+    // The result is inserted as by '__insert()' and given to waiters.
+    void __land(
+        const std::string &ip,
+        const std::string &lang,
+        const std::uint8_t hosts_mask,
+        const flight_ptr &flight,
+        const srv::types::info &info,
+        const errors_map &errors);
+
+    // The leader has failed to run the lookup (e.g. it has thrown),
+    // the waiters are woken up without a result.
+    void __abandon(
+        const std::string &ip,
+        const std::string &lang,
+        const std::uint8_t hosts_mask,
+        const flight_ptr &flight);
+
+    void __remove_flight(
+        const std::string &ip,
+        const std::string &lang,
+        const std::uint8_t hosts_mask,
+        const flight_ptr &flight);
+
+    // Returns false if the deadline is passed before
+    // the flight is landed, or if the flight is abandoned.
+    static bool __wait(
+        __flight &flight,
+        const clock::time_point &deadline,
+        srv::types::info &info,
+        errors_map &errors);
+
+  public:
+    cache();
+
+    cache(
+        const std::size_t max_entries,
+        const std::size_t max_bytes,
+        const std::chrono::milliseconds &ttl,
+        const std::size_t shards_num = constants::DEFAULT_CACHE_SHARDS_NUM);
+
+    ~cache();
+
+    cache(const cache &) = delete;
+    cache &operator=(const cache &) = delete;
+
+    // The process-wide cache with default limits, it's created
+    // on the first call. Informers don't use it unless it's set.
+    static std::shared_ptr<usr::cache> instance();
+
+    void set_max_entries(const std::size_t n);
+    void set_max_bytes(const std::size_t n);
+    void set_ttl(const std::chrono::milliseconds &ttl);
+
+    // Results aren't refreshed if the soft TTL isn't less than the TTL.
+    // Zero limit of refreshes in flight disables them.
+    void set_soft_ttl(const std::chrono::milliseconds &ttl);
+    void set_max_refreshes(const std::size_t n);
+
+    // Sketches are reset when the policy or the entries limit is set.
+    void set_admission(const std::uint8_t admission_id);
+
+    // the TTL of failed lookups of the 'NEGATIVE_CACHE_CLASSES_IDS' class
+    void set_negative_ttl(
+        const std::uint8_t class_id,
+        const std::chrono::milliseconds &ttl);
+
+    // Results of other lengths aren't found after the change, they're
+    // evicted in time. Zero disables the range cache for the family.
+    void set_range_prefixes(
+        const std::uint8_t v4_prefix_len,
+        const std::uint8_t v6_prefix_len);
+
+    // The file is created if there is no one, results which are already
+    // in memory aren't written to it. Returns false on failure, the
+    // error is given by 'get_last_error()'. A torn record at the end
+    // of the file is dropped silently.
+    bool open_file(const std::string &path);
+    void close_file();
+
+    // Expired and replaced results are dropped from the file. The file
+    // is rewritten next to the old one, so it isn't lost on a crash.
+    bool compact_file();
+
+    usr::types::error get_last_error() const;
+
+    // All results of the IP are dropped, whatever the language is,
+    // including the results of the IP's network. Both are dropped
+    // from the file too.
+    void invalidate(const std::string &ip);
+    void clear();
+
+    usr::types::cache_stats get_stats() const;
+};
+
+#endif // IPINFO_CACHE_HPP
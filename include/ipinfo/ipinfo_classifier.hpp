@@ -0,0 +1,30 @@
+#ifndef IPINFO_CLASSIFIER_HPP
+    #define IPINFO_CLASSIFIER_HPP
+
+#include "ipinfo_types.hpp"
+
+#include <string>
+
+namespace ipinfo::srv
+{
+    class classifier;
+}
+
+// The classifier recognizes private, reserved and special addresses
+// by the IANA special-purpose registries (RFC 6890 and its updates).
+// Hosts have nothing to say about such addresses, so they're answered
+// locally without requests. The ranges are compiled in, they are
+// looked up by a trie (see 'srv::trie').
+
+class ipinfo::srv::classifier
+{
+  public:
+    bool is_reserved(const srv::types::address &addr) const;
+
+    // If the IP is reserved, the local source of the info gets the
+    // address, its type and the reserved status, and true is returned:
+    // the IP needs no requests. Otherwise the info isn't changed.
+    bool classify(const std::string &ip, srv::types::info &info) const;
+};
+
+#endif // IPINFO_CLASSIFIER_HPP
@@ -6,12 +6,25 @@
 #include <map>
 #include <array>
 #include <string>
+#include <string_view>
 #include <vector>
+#include <chrono>
+#include <cstddef>
 #include <cstdint>
 
 namespace ipinfo::constants
 {
-    const std::array<std::string, 2u> AVAILABLE_HOSTS
+    constexpr std::size_t AVAILABLE_HOSTS_NUM{ 2u };
+
+    // Besides the hosts, the info is filled by the library itself:
+    // reserved IPs are answered locally. Such values are stored
+    // after the hosts' ones and have the 'LOCAL_SOURCE' as a host.
+
+    constexpr std::size_t INFO_SOURCES_NUM{ AVAILABLE_HOSTS_NUM + 1u };
+    constexpr std::size_t LOCAL_SOURCE_ID{ AVAILABLE_HOSTS_NUM };
+    const std::string LOCAL_SOURCE{ "local" };
+
+    const std::array<std::string, AVAILABLE_HOSTS_NUM> AVAILABLE_HOSTS
     {
         "ip-api.com",
         "ipwhois.app"
@@ -47,6 +60,96 @@ namespace ipinfo::constants
         RUSSIAN
     };
 
+    // Sessions of the pool keep their connections alive between
+    // requests. The size is a number of idle sessions per host.
+
+    const std::size_t DEFAULT_POOL_SIZE{ 4u };
+    const std::chrono::milliseconds DEFAULT_POOL_IDLE_TIMEOUT{ 30000 };
+
+    // The engine runs one event loop per thread. A number of
+    // requests which are in flight to one host at the same
+    // time is limited for all loops of the engine together.
+
+    const std::size_t DEFAULT_ENGINE_THREADS_NUM{ 1u };
+    const std::size_t DEFAULT_ENGINE_MAX_HOST_REQUESTS{ 256u };
+
+    // The hedged mode sends a request to the second host, if the
+    // first one hasn't answered during its usual latency. Until there
+    // are samples of a host's latency, the initial delay is used.
+
+    const std::chrono::milliseconds HEDGE_INITIAL_DELAY{ 1000 };
+    const std::chrono::milliseconds HEDGE_MIN_DELAY{ 50 };
+    const std::chrono::milliseconds HEDGE_MAX_DELAY{ 5000 };
+
+    // A host's circuit is opened after the number of transient
+    // failures in a row, the host isn't requested during the cooldown.
+    // Then one probe request is let through, its result closes the
+    // circuit or opens it again.
+
+    const std::uint32_t BREAKER_FAILURES_THRESHOLD{ 5u };
+    const std::chrono::milliseconds BREAKER_COOLDOWN{ 30000 };
+
+    // Transient failures are retried with the full jitter backoff:
+    // a random delay up to min(max, base * 2 ^ attempt).
+
+    const std::uint8_t DEFAULT_RETRIES_NUM{ 2u };
+    const std::chrono::milliseconds RETRY_BASE_DELAY{ 100 };
+    const std::chrono::milliseconds RETRY_MAX_DELAY{ 2000 };
+
+    // The cache is bounded by both the number of entries and their
+    // approximate size, the least recently used entries are evicted
+    // first. Entries older than the TTL aren't returned. The limits
+    // are split evenly between the cache's shards.
+
+    const std::size_t DEFAULT_CACHE_MAX_ENTRIES{ 65536u };
+    const std::size_t DEFAULT_CACHE_MAX_BYTES{ 64u * 1024u * 1024u };
+    const std::chrono::milliseconds DEFAULT_CACHE_TTL{ 3600000 };
+    const std::size_t DEFAULT_CACHE_SHARDS_NUM{ 64u }; // power of two
+
+    // A result older than the soft TTL is still returned, but it's looked
+    // up once again in the background, so a hit doesn't wait for hosts
+    // until the result is expired. Refreshes in flight are limited, the
+    // ones which aren't done by the timeout are dropped.
+
+    const std::chrono::milliseconds DEFAULT_CACHE_SOFT_TTL{ 2700000 };
+    const std::size_t DEFAULT_CACHE_MAX_REFRESHES{ 16u };
+    const std::chrono::milliseconds CACHE_REFRESH_TIMEOUT{ 10000 };
+
+    // A result is shared by all IPs of the network with these prefix
+    // lengths, because geo and ISP data are almost always the same for
+    // the whole network. Zero disables it for the family.
+
+    const std::uint8_t DEFAULT_CACHE_V4_PREFIX_LEN{ 24u };
+    const std::uint8_t DEFAULT_CACHE_V6_PREFIX_LEN{ 48u };
+
+    // The cache's file is mapped with a reserve, so appended results
+    // are read without remapping until the file outgrows the mapping.
+
+    const std::size_t CACHE_FILE_MIN_MAP_SIZE{ 64u * 1024u * 1024u };
+
+    enum BREAKER_STATES_IDS : std::uint8_t
+    {
+        CLOSED = 0u,
+        OPEN,
+        HALF_OPEN
+    };
+
+    enum RUN_MODES_IDS : std::uint8_t
+    {
+        SEQUENTIAL = 0u,
+        CONCURRENT,
+        HEDGED
+    };
+
+    // The streaming parser reads an answer in one pass straight
+    // into the info, cJSON builds a whole tree of the answer first.
+
+    enum PARSERS_IDS : std::uint8_t
+    {
+        CJSON = 0u,
+        STREAMING
+    };
+
     enum ERRORS_IDS : std::uint8_t
     {
         NO_ERRORS = 0u,
@@ -56,7 +159,57 @@ namespace ipinfo::constants
         UNSUCCESSFULL_RESPONSE_STATUS_CODE,
         EMPTY_REQUEST_ANSWER,
         EMPTY_JSON_STRING,
-        FAILED_JSON_PARSING
+        FAILED_JSON_PARSING,
+        REQUEST_TIMEOUT,
+        FAILED_REQUEST,
+        UNAVAILABLE_HOST,
+        FAILED_FILE_ACCESS,
+        CORRUPTED_FILE,
+        INVALID_QUERY,    // the host rejects the IP
+        FAILED_LOOKUP,    // the host has no data for the IP
+        THROTTLED_REQUEST // the host's quota is spent
+    };
+
+    // Failed lookups are cached too, so a repeated bad IP costs
+    // nothing. Every class of errors has its own TTL, zero disables
+    // it. A lookup with an error which isn't classified (e.g. a timeout)
+    // isn't cached, it may succeed on the next run.
+
+    enum NEGATIVE_CACHE_CLASSES_IDS : std::uint8_t
+    {
+        INVALID_INPUT = 0u,
+        PROVIDER_FAILURE,
+        THROTTLED
+    };
+
+    constexpr std::size_t NEGATIVE_CACHE_CLASSES_NUM{ 3u };
+
+    const std::array<std::chrono::milliseconds, NEGATIVE_CACHE_CLASSES_NUM> DEFAULT_NEGATIVE_CACHE_TTLS
+    {
+        std::chrono::milliseconds{ 600000 },
+        std::chrono::milliseconds{ 60000 },
+        std::chrono::milliseconds{ 5000 }
+    };
+
+    // A preferred database answers the IPs it has, hosts are asked
+    // for the rest. An exclusive one answers all IPs, the ones which
+    // aren't there get the 'FAILED_LOOKUP' error of the local source.
+
+    enum DATABASE_MODES_IDS : std::uint8_t
+    {
+        PREFERRED = 0u,
+        EXCLUSIVE
+    };
+
+    // A full cache admits every new result by default. With TinyLFU
+    // a new result replaces the eviction's victim only if its key is
+    // looked up more often, so one-off IPs of a scan don't flush the
+    // results of IPs which are looked up all the time.
+
+    enum CACHE_ADMISSIONS_IDS : std::uint8_t
+    {
+        ALWAYS = 0u,
+        TINY_LFU
     };
 
     const std::map<als::str, std::map<als::str, als::str>> HOSTS_AVAILABLE_LANGS
@@ -115,6 +268,44 @@ namespace ipinfo::constants
         }
     };
 
+    // Only ip-api.com is able to answer about several IPs at once.
+    // One batch mustn't contain more than 'BATCH_MAX_SIZE' IPs.
+
+    const std::size_t BATCH_MAX_SIZE{ 100u };
+
+    // a batch request has its own timeout, its sessions are pooled
+    // with the single ones, which are timed by their deadlines
+    const std::chrono::milliseconds BATCH_REQUEST_TIMEOUT{ 30000 };
+
+    const std::map<std::string, std::string> BATCH_REQUEST_PATHS
+    {
+        {
+            AVAILABLE_HOSTS.at(AVAILABLE_HOSTS_IDS::IP_API_COM),
+            {
+                "http://" +
+                AVAILABLE_HOSTS.at(AVAILABLE_HOSTS_IDS::IP_API_COM) +
+                "/batch"
+            }
+        }
+    };
+
+    // Requests per minute which are allowed by the free plans.
+    // Zero means there is no per-minute limit. The batch endpoint
+    // of ip-api.com has its own quota, thus it's a separate bucket.
+
+    const std::map<std::string, std::uint32_t> RATE_LIMITS
+    {
+        { AVAILABLE_HOSTS.at(AVAILABLE_HOSTS_IDS::IP_API_COM), 45u },
+        { AVAILABLE_HOSTS.at(AVAILABLE_HOSTS_IDS::IP_API_COM) + "/batch", 15u },
+        { AVAILABLE_HOSTS.at(AVAILABLE_HOSTS_IDS::IPWHOIS_APP), 0u }
+    };
+
+    // ip-api.com reports the remaining requests of the current
+    // window and seconds until the window reset by these headers.
+
+    const std::string RATE_LIMIT_REMAINING_HEADER{ "X-Rl" };
+    const std::string RATE_LIMIT_RESET_HEADER{ "X-Ttl" };
+
     const std::map<als::str, std::map<als::str, als::str>> REQUEST_PARAMETERS_TITLES
     {
         {
@@ -136,69 +327,97 @@ namespace ipinfo::constants
         }
     };
 
-    const std::map<std::string, std::vector<std::string>> REQUEST_INFO_FIELDS
+    // Every field of the info is described once here: its description
+    // and its JSON name per host, indexed by 'AVAILABLE_HOSTS_IDS'. An
+    // empty name means the host doesn't provide the field. Parsers,
+    // requests' field lists and the info's reset are built on it.
+
+    struct info_field
     {
-        {
-            AVAILABLE_HOSTS.at(AVAILABLE_HOSTS_IDS::IP_API_COM),
-            {
-                "query",
-                "continent",
-                "gcontinentCode",
-                "country",
-                "countryCode",
-                "region",
-                "regionName",
-                "city",
-                "district",
-                "zip",
-                "lat",
-                "lon",
-                "timezone",
-                "offset",
-                "currency",
-                "isp",
-                "org",
-                "as",
-                "asname",
-                "reverse",
-                "mobile",
-                "proxy",
-                "hosting"
-            }
-        },
+        std::string_view desc{};
+        std::array<std::string_view, AVAILABLE_HOSTS_NUM> json_names{};
+    };
 
-        {
-            AVAILABLE_HOSTS.at(AVAILABLE_HOSTS_IDS::IPWHOIS_APP),
-            {
-                "ip",
-                "type",
-                "continent",
-                "continent_code",
-                "country",
-                "country_code",
-                "country_capital",
-                "country_phone",
-                "country_neighbours",
-                "region",
-                "city",
-                "latitude",
-                "longitude",
-                "as",
-                "org",
-                "isp",
-                "timezone",
-                "timezone_name",
-                "timezone_dstOffset",
-                "timezone_gmtOffset",
-                "timezone_gmt",
-                "currency",
-                "currency_code",
-                "currency_symbol",
-                "currency_rates",
-                "currency_plural"
-            }
-        }
+    enum INFO_FIELDS_IDS : std::uint8_t
+    {
+        IP = 0u,
+        IP_TYPE,
+        CONTINENT,
+        CONTINENT_CODE,
+        COUNTRY,
+        COUNTRY_CODE,
+        COUNTRY_CAPITAL,
+        COUNTRY_PH_CODE,
+        COUNTRY_NEIGHBORS,
+        REGION,
+        REGION_CODE,
+        CITY,
+        CITY_DISTRICT,
+        ZIP_CODE,
+        LATITUDE,
+        LONGITUDE,
+        CITY_TIMEZONE,
+        TIMEZONE,
+        GMT_OFFSET,
+        DST_OFFSET,
+        TIMEZONE_GMT,
+        ISP,
+        AS,
+        ORG,
+        REVERSE_DNS,
+        IS_HOSTING,
+        IS_PROXY,
+        IS_MOBILE,
+        CURRENCY,
+        CURRENCY_CODE,
+        CURRENCY_SYMBOL,
+        CURRENCY_RATES,
+        CURRENCY_PLURAL,
+        IS_RESERVED,
+        FAILURE_MESSAGE // only a failed answer has it
     };
+
+    constexpr std::size_t INFO_FIELDS_NUM{ 35u };
+
+    constexpr std::array<info_field, INFO_FIELDS_NUM> INFO_FIELDS
+    {{
+        // description                            ip-api.com         ipwhois.app
+        { "IP address",                          { "query",         "ip" }                 },
+        { "IP address type",                     { "",              "type" }               },
+        { "Continent name",                      { "continent",     "continent" }          },
+        { "Continent code",                      { "continentCode", "continent_code" }     },
+        { "Country name",                        { "country",       "country" }            },
+        { "Country code",                        { "countryCode",   "country_code" }       },
+        { "The capital of country",              { "",              "country_capital" }    },
+        { "Country phone code",                  { "",              "country_phone" }      },
+        { "Neighboring countries",               { "",              "country_neighbours" } },
+        { "Region name",                         { "regionName",    "region" }             },
+        { "Region code",                         { "region",        "" }                   },
+        { "City name",                           { "city",          "city" }               },
+        { "City district",                       { "district",      "" }                   },
+        { "ZIP code",                            { "zip",           "" }                   },
+        { "Latitude",                            { "lat",           "latitude" }           },
+        { "Longitude",                           { "lon",           "longitude" }          },
+        { "City timezone",                       { "timezone",      "timezone" }           },
+        { "Full timezone name",                  { "",              "timezone_name" }      },
+        { "UTC offset",                          { "offset",        "timezone_gmtOffset" } },
+        { "DST offset",                          { "",              "timezone_dstOffset" } },
+        { "Timezone GMT",                        { "",              "timezone_gmt" }       },
+        { "Internet Service Provider",           { "isp",           "isp" }                },
+        { "Autonomous system",                   { "as",            "as" }                 },
+        { "Organization name",                   { "org",           "org" }                },
+        { "Reverse DNS of the IP",               { "reverse",       "" }                   },
+        { "Hosting, colocated or data center",   { "hosting",       "" }                   },
+        { "Proxy, VPN or Tor usage",             { "proxy",         "" }                   },
+        { "Mobile connection usage",             { "mobile",        "" }                   },
+        { "Currency name",                       { "",              "currency" }           },
+        { "Currency code",                       { "currency",      "currency_code" }      },
+        { "Currency symbol",                     { "",              "currency_symbol" }    },
+        { "Currency exchange rate to USD",       { "",              "currency_rates" }     },
+        { "Currency plural",                     { "",              "currency_plural" }    },
+        { "Private, reserved or special address", { "",              "" }                   },
+        { "Failure message of the host",         { "message",       "message" }            }
+    }};
 }
 
 #endif // IPINFO_CONSTANTS_HPP
@@ -0,0 +1,148 @@
+#ifndef IPINFO_DATABASE_HPP
+    #define IPINFO_DATABASE_HPP
+
+#include "ipinfo_constants.hpp"
+#include "ipinfo_types.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ipinfo::usr
+{
+    class database;
+    class database_builder;
+    class informer;
+    class batch_informer;
+}
+
+// The database is an offline source of the info: a file of sorted and
+// disjoint IP ranges, every range refers to a record of fields. It's
+// attached to informers by 'informer::set_database()', its results are
+// the local source's ones (the 'local' host), so the same getters read
+// them. Hosts are asked only for IPs which aren't in the database,
+// unless it's exclusive ('DATABASE_MODES_IDS').
+//
+//   header | ranges' starts | ranges' ends and records' offsets | records
+//
+// The file is mapped and read in place, a lookup is a binary search
+// over the starts and needs no locks. Every 256th start is copied to
+// memory at the opening, so the search touches one page of the file.
+// Both IPv4 and IPv6 ranges are there, IPv4 is mapped to '::ffff:0:0/96'.
+// An address is written as two 64-bit halves in the host's byte order,
+// the file isn't meant to be moved between machines with the different one.
+//
+// A record is its size, the mask of the fields which are there and
+// their values in the order of 'INFO_FIELDS_IDS'. The IP and its
+// reverse DNS aren't in records, they belong to the address. The file
+// is written by 'usr::database_builder'.
+
+class ipinfo::usr::database
+{
+    friend class usr::database_builder;
+    friend class usr::informer;
+    friend class usr::batch_informer;
+
+  private:
+    static constexpr char __MAGIC[8]{ 'I', 'P', 'I', 'N', 'F', 'O', 'D', '\0' };
+    static constexpr std::uint32_t __VERSION{ 1u };
+    static constexpr std::size_t __INDEX_STRIDE{ 256u }; // a page of starts
+    static constexpr std::size_t __GROUP_SIZE{ 32u };     // IPs searched in turns
+
+    struct __header
+    {
+        char magic[8]{};
+        std::uint32_t version{ 0u };
+        std::uint32_t reserved{ 0u };
+        std::uint64_t ranges_num{ 0u };
+        std::uint64_t starts_offset{ 0u };
+        std::uint64_t ends_offset{ 0u };
+        std::uint64_t records_offset{ 0u };
+        std::uint64_t records_size{ 0u };
+    };
+
+    // an address is compared by its halves, the high one first
+    struct __key
+    {
+        std::uint64_t hi{ 0u };
+        std::uint64_t lo{ 0u };
+    };
+
+    // The start is searched, the rest of the range is read once,
+    // so it's kept apart and read by one access.
+    struct __end
+    {
+        __key last{};
+        std::uint64_t record{ 0u }; // the offset in the records
+    };
+
+    const char *__data{ nullptr };
+    std::size_t __size{ 0u };
+
+    __header __hdr{};
+
+    // the sections of the mapping
+    const __key *__starts{ nullptr };
+    const __end *__ends{ nullptr };
+    std::string_view __records{};
+
+    std::vector<__key> __index{}; // every '__INDEX_STRIDE'th start
+
+    usr::types::error __error{};
+
+    static __key __get_key(const srv::types::address &addr);
+    static bool __is_less(const __key &a, const __key &b);
+
+    bool __fail(const std::uint8_t code, const std::string &desc);
+    bool __check_layout();
+
+    // returns false if the record is broken
+    bool __read_record(const std::uint64_t offset, srv::types::info &info) const;
+
+    // The starts which may have the last one before the key, by the
+    // index. Returns false if the key is before all ranges.
+    bool __find_block(const __key &key, std::size_t &first, std::size_t &last) const;
+
+    // the key is after the range's start, it's checked against its end
+    bool __read_range(
+        const std::size_t range_id,
+        const __key &key,
+        const std::string &ip,
+        srv::types::info &info) const;
+
+    // If the IP is in a range, the local source of the info gets the
+    // range's record and the IP, and true is returned.
+    bool __find(const std::string &ip, srv::types::info &info) const;
+
+    // The same for many IPs, 'infos' and 'is_found' have the IPs' size
+    // and IPs which are found already are skipped. A lookup is a chain
+    // of dependent loads, so the chains of a group of IPs are walked in
+    // turns: the line of an IP's next probe is prefetched, and it's
+    // read after the rest of the group has made its steps, thus cache
+    // misses of the group overlap.
+    void __find_batch(
+        const std::vector<std::string> &ips,
+        std::vector<srv::types::info> &infos,
+        std::vector<bool> &is_found) const;
+
+  public:
+    database() = default;
+    ~database();
+
+    database(const database &) = delete;
+    database &operator=(const database &) = delete;
+
+    // The previous file is closed, even if the opening fails. The file
+    // mustn't be opened or closed while informers look IPs up in it.
+    bool open(const std::string &path);
+    void close();
+
+    bool is_open() const;
+    std::size_t get_ranges_num() const;
+
+    usr::types::error get_last_error() const;
+};
+
+#endif // IPINFO_DATABASE_HPP
@@ -0,0 +1,130 @@
+#ifndef IPINFO_DATABASE_BUILDER_HPP
+    #define IPINFO_DATABASE_BUILDER_HPP
+
+#include "ipinfo_types.hpp"
+#include "ipinfo_database.hpp"
+#include "ipinfo_informer.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace ipinfo::usr
+{
+    class database_builder;
+}
+
+// The builder compiles looked up results to the file of 'usr::database'.
+// Results are added from the cache's file, from dumps of the hosts'
+// answers (one JSON answer per line, a batch answer is an array) and
+// from informers, e.g. the results of batch runs. A database which is
+// built before may be added first, so a rebuild takes only new results:
+// a later result overrides older ones at its IP.
+//
+// Every IP gets a record of its fields, the first source which has a
+// field gives its value. Records are deduplicated, and neighbouring
+// IPs with the same record are merged into ranges when the file is
+// written. The gaps between IPs of the same network (the cache's one)
+// may be filled too, if the network is known to be uniform.
+//
+// Reserved IPs and failed answers aren't added. Results in another
+// language are skipped, if the language is set.
+
+class ipinfo::usr::database_builder
+{
+  private:
+    using __key = usr::database::__key;
+
+    struct __key_less
+    {
+        bool operator()(const __key &a, const __key &b) const
+        {
+            return usr::database::__is_less(a, b);
+        }
+    };
+
+    struct __range
+    {
+        __key last{};
+        std::uint32_t record{ 0u }; // the record's index
+    };
+
+    std::map<__key, __range, __key_less> __ranges{}; // disjoint, by starts
+
+    // A record is kept once, its index is found by its bytes.
+    // Strings of a deque aren't moved, so views of them stay valid.
+    std::deque<std::string> __records{};
+    std::unordered_map<std::string_view, std::uint32_t> __records_ids{};
+
+    std::string __lang{};
+    bool __is_gaps_filling{ false };
+
+    std::size_t __added_num{ 0u };
+    std::size_t __written_ranges_num{ 0u };
+    std::size_t __written_records_num{ 0u };
+
+    usr::types::error __error{};
+
+    static __key __get_next(const __key &key);
+    static __key __get_prev(const __key &key);
+
+    // both keys are in the same network of the cache's prefix lengths
+    static bool __is_same_network(const __key &a, const __key &b);
+
+    bool __fail(const std::uint8_t code, const std::string &desc);
+
+    // Returns false if the info has no fields for the database, else
+    // the record is written in the database's format.
+    static bool __make_record(const srv::types::info &info, std::string &out);
+
+    std::uint32_t __add_record(std::string &&record);
+
+    // the range overrides all ranges it overlaps
+    void __assign(const __key &first, const __key &last, const std::uint32_t record);
+
+    bool __add(const std::string &ip, const std::string &lang, const srv::types::info &info);
+
+  public:
+    database_builder() = default;
+
+    // records of other languages are skipped, an empty one skips nothing
+    void set_lang(const std::string &lang);
+
+    // IPs of the same network with the same record are merged
+    // into one range, even if there are unknown IPs between them
+    void set_gaps_filling(const bool is_enabled);
+
+    // Ranges of the database are added as they're, so results which
+    // are added after them override them. It's the incremental rebuild.
+    bool add_database(const std::string &path);
+
+    // Live results of the cache's file ('cache::open_file()'). The file
+    // is only read, a running service may keep appending to it.
+    bool add_cache_file(const std::string &path);
+
+    // Answers of the host, one per line. Lines which aren't
+    // parsed are skipped, false is returned if the file isn't read.
+    bool add_answers(const std::string &path, const std::string &host);
+
+    bool add_result(const usr::informer &result);
+    void add_results(const std::vector<usr::informer> &results);
+
+    // The file is written next to the path and renamed, so informers
+    // may keep the previous file open, even if it's the same path.
+    bool write(const std::string &path);
+
+    std::size_t get_added_num() const; // IPs and ranges which are added
+
+    // the numbers of the last written file
+    std::size_t get_ranges_num() const;
+    std::size_t get_records_num() const;
+
+    usr::types::error get_last_error() const;
+};
+
+#endif // IPINFO_DATABASE_BUILDER_HPP
@@ -0,0 +1,69 @@
+#ifndef IPINFO_ENGINE_HPP
+    #define IPINFO_ENGINE_HPP
+
+#include "ipinfo_constants.hpp"
+#include "ipinfo_aliases.hpp"
+#include "ipinfo_informer.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <memory>
+#include <vector>
+
+namespace ipinfo::srv
+{
+    class loop;
+}
+
+namespace ipinfo::usr
+{
+    class engine;
+}
+
+// The engine makes lookups without blocking of the calling thread.
+// A lookup is described by an informer: its IP, language, API keys
+// and excluded hosts are used. The informer filled with the result
+// is passed to a callback or a future. Thousands of lookups may be
+// in flight at the same time on a few threads of the engine.
+
+class ipinfo::usr::engine
+{
+  public:
+    using callback = std::function<void(usr::informer &&)>;
+
+  private:
+    std::vector<std::unique_ptr<srv::loop>> __loops{};
+    std::atomic<std::size_t> __next_loop{ 0u };
+
+  public:
+    explicit engine(
+        const std::size_t threads_num = constants::DEFAULT_ENGINE_THREADS_NUM,
+        const std::size_t max_host_requests = constants::DEFAULT_ENGINE_MAX_HOST_REQUESTS);
+
+    ~engine();
+
+    engine(const engine &) = delete;
+    engine &operator=(const engine &) = delete;
+
+    // The callback is called from a thread of the engine,
+    // so it should return as soon as possible.
+    void submit(const usr::informer &infr, callback cb);
+
+    std::future<usr::informer> submit(const usr::informer &infr);
+
+    // Requests of the lookup are aborted when the budget is spent,
+    // the hosts which haven't answered have the 'REQUEST_TIMEOUT'.
+    void submit(
+        const usr::informer &infr,
+        const std::chrono::milliseconds &budget,
+        callback cb);
+
+    std::future<usr::informer> submit(
+        const usr::informer &infr,
+        const std::chrono::milliseconds &budget);
+};
+
+#endif // IPINFO_ENGINE_HPP
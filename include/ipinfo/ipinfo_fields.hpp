@@ -0,0 +1,261 @@
+#ifndef IPINFO_FIELDS_HPP
+    #define IPINFO_FIELDS_HPP
+
+#include "ipinfo_constants.hpp"
+#include "ipinfo_types.hpp"
+
+#include <array>       // std::array
+#include <cstddef>     // std::size_t
+#include <cstdint>     // std::uint8_t, std::uint32_t
+#include <string_view> // std::string_view
+
+namespace ipinfo::srv
+{
+    class fields_table;
+}
+
+// The table maps a host's JSON keys to 'INFO_FIELDS_IDS' by a perfect
+// hash: the seed is searched at compile time so that the host's keys
+// don't collide, thus a key is found by one hash and one comparison.
+// Unknown keys fall to an empty slot or fail the comparison.
+
+class ipinfo::srv::fields_table
+{
+  private:
+    static constexpr std::size_t __SLOTS_NUM{ 128u }; // power of two
+    static constexpr std::uint8_t __EMPTY_SLOT{ constants::INFO_FIELDS_NUM };
+
+    std::uint8_t __host_id{ 0u };
+    std::uint32_t __seed{ 0u };
+    std::array<std::uint8_t, __SLOTS_NUM> __slots{};
+
+    static constexpr std::size_t __hash(
+        const std::string_view key,
+        const std::uint32_t seed)
+    {
+        std::uint32_t h{ 2166136261u ^ seed }; // FNV-1a
+
+        for (const char c : key)
+        {
+            h = (h ^ static_cast<std::uint8_t>(c)) * 16777619u;
+        }
+
+        return (h * 2654435761u) >> 25u; // 7 bits for 128 slots
+    }
+
+    constexpr bool __try_seed(const std::uint32_t seed)
+    {
+        __slots.fill(__EMPTY_SLOT);
+
+        for (std::uint8_t id{ 0u }; id < constants::INFO_FIELDS_NUM; id++)
+        {
+            const std::string_view key {
+                constants::INFO_FIELDS[id].json_names[__host_id]
+            };
+
+            if (key.empty())
+            {
+                continue;
+            }
+
+            std::uint8_t &slot{ __slots[__hash(key, seed)] };
+
+            if (__EMPTY_SLOT != slot)
+            {
+                return false;
+            }
+
+            slot = id;
+        }
+
+        return true;
+    }
+
+  public:
+    // If there is no seed without collisions, the table can't
+    // be built at compile time, so it's a compilation error.
+
+    constexpr explicit fields_table(const std::uint8_t host_id) :
+
+        __host_id{ host_id }
+    {
+        while (not __try_seed(__seed))
+        {
+            __seed += 1u;
+
+            if (0xFFFFu == __seed)
+            {
+                throw "There is no perfect hash for the host's fields";
+            }
+        }
+    }
+
+    // returns 'INFO_FIELDS_NUM' if the key isn't known
+    constexpr std::uint8_t find(const std::string_view key) const
+    {
+        const std::uint8_t id{ __slots[__hash(key, __seed)] };
+
+        if (__EMPTY_SLOT == id or
+            key != constants::INFO_FIELDS[id].json_names[__host_id])
+        {
+            return __EMPTY_SLOT;
+        }
+
+        return id;
+    }
+};
+
+namespace ipinfo::srv
+{
+    // indexed by 'AVAILABLE_HOSTS_IDS'
+    constexpr std::array<fields_table, constants::AVAILABLE_HOSTS_NUM> FIELDS_TABLES
+    {
+        fields_table{ constants::AVAILABLE_HOSTS_IDS::IP_API_COM },
+        fields_table{ constants::AVAILABLE_HOSTS_IDS::IPWHOIS_APP }
+    };
+
+    // Calls 'f' with the info's member pointer of the field, members
+    // have different types, so 'f' should be generic.
+
+    template<typename F>
+        constexpr void visit_member(const std::uint8_t field_id, F &&f)
+    {
+        using info = srv::types::info;
+
+        switch (field_id)
+        {
+            case constants::INFO_FIELDS_IDS::IP:                f(&info::ip);                return;
+            case constants::INFO_FIELDS_IDS::IP_TYPE:           f(&info::ip_type);           return;
+            case constants::INFO_FIELDS_IDS::CONTINENT:         f(&info::continent);         return;
+            case constants::INFO_FIELDS_IDS::CONTINENT_CODE:    f(&info::continent_code);    return;
+            case constants::INFO_FIELDS_IDS::COUNTRY:           f(&info::country);           return;
+            case constants::INFO_FIELDS_IDS::COUNTRY_CODE:      f(&info::country_code);      return;
+            case constants::INFO_FIELDS_IDS::COUNTRY_CAPITAL:   f(&info::country_capital);   return;
+            case constants::INFO_FIELDS_IDS::COUNTRY_PH_CODE:   f(&info::country_ph_code);   return;
+            case constants::INFO_FIELDS_IDS::COUNTRY_NEIGHBORS: f(&info::country_neighbors); return;
+            case constants::INFO_FIELDS_IDS::REGION:            f(&info::region);            return;
+            case constants::INFO_FIELDS_IDS::REGION_CODE:       f(&info::region_code);       return;
+            case constants::INFO_FIELDS_IDS::CITY:              f(&info::city);              return;
+            case constants::INFO_FIELDS_IDS::CITY_DISTRICT:     f(&info::city_district);     return;
+            case constants::INFO_FIELDS_IDS::ZIP_CODE:          f(&info::zip_code);          return;
+            case constants::INFO_FIELDS_IDS::LATITUDE:          f(&info::latitude);          return;
+            case constants::INFO_FIELDS_IDS::LONGITUDE:         f(&info::longitude);         return;
+            case constants::INFO_FIELDS_IDS::CITY_TIMEZONE:     f(&info::city_timezone);     return;
+            case constants::INFO_FIELDS_IDS::TIMEZONE:          f(&info::timezone);          return;
+            case constants::INFO_FIELDS_IDS::GMT_OFFSET:        f(&info::gmt_offset);        return;
+            case constants::INFO_FIELDS_IDS::DST_OFFSET:        f(&info::dst_offset);        return;
+            case constants::INFO_FIELDS_IDS::TIMEZONE_GMT:      f(&info::timezone_gmt);      return;
+            case constants::INFO_FIELDS_IDS::ISP:               f(&info::isp);               return;
+            case constants::INFO_FIELDS_IDS::AS:                f(&info::as);                return;
+            case constants::INFO_FIELDS_IDS::ORG:               f(&info::org);               return;
+            case constants::INFO_FIELDS_IDS::REVERSE_DNS:       f(&info::reverse_dns);       return;
+            case constants::INFO_FIELDS_IDS::IS_HOSTING:        f(&info::is_hosting);        return;
+            case constants::INFO_FIELDS_IDS::IS_PROXY:          f(&info::is_proxy);          return;
+            case constants::INFO_FIELDS_IDS::IS_MOBILE:         f(&info::is_mobile);         return;
+            case constants::INFO_FIELDS_IDS::CURRENCY:          f(&info::currency);          return;
+            case constants::INFO_FIELDS_IDS::CURRENCY_CODE:     f(&info::currency_code);     return;
+            case constants::INFO_FIELDS_IDS::CURRENCY_SYMBOL:   f(&info::currency_symbol);   return;
+            case constants::INFO_FIELDS_IDS::CURRENCY_RATES:    f(&info::currency_rates);    return;
+            case constants::INFO_FIELDS_IDS::CURRENCY_PLURAL:   f(&info::currency_plural);   return;
+            case constants::INFO_FIELDS_IDS::IS_RESERVED:       f(&info::is_reserved);       return;
+            case constants::INFO_FIELDS_IDS::FAILURE_MESSAGE:   f(&info::failure_message);   return;
+
+            default: return;
+        }
+    }
+
+    // the same, but 'f' is called with the info's node of the field
+    template<typename info_T, typename F>
+        constexpr void visit_field(
+            info_T &info,
+            const std::uint8_t field_id,
+            F &&f)
+    {
+        visit_member(field_id, [&] (const auto member)
+        {
+            f(info.*member);
+        });
+    }
+
+    static_assert(constants::INFO_FIELDS_NUM <= 64u,
+        "Parsed fields don't fit the info's masks");
+
+    inline bool is_parsed(
+        const srv::types::info &info,
+        const std::size_t host_id,
+        const std::uint8_t field_id)
+    {
+        return (info.parsed[host_id] >> field_id) & 1u;
+    }
+
+    inline void set_parsed(
+        srv::types::info &info,
+        const std::size_t host_id,
+        const std::uint8_t field_id,
+        const bool is_parsed)
+    {
+        if (constants::INFO_FIELDS_NUM <= field_id)
+        {
+            return;
+        }
+
+        const std::uint64_t bit{ std::uint64_t{ 1u } << field_id };
+
+        info.parsed[host_id] = is_parsed ?
+            (info.parsed[host_id] | bit) : (info.parsed[host_id] & ~bit);
+    }
+
+    // Only the parsed values are copied, 'to' is reset before.
+    inline void copy_parsed(
+        const srv::types::info &from,
+        srv::types::info &to)
+    {
+        to.parsed = from.parsed;
+
+        for (std::uint8_t id{ 0u }; id < constants::INFO_FIELDS_NUM; id++)
+        {
+            visit_member(id, [&] (const auto member)
+            {
+                for (std::size_t i{ 0u }; i < constants::INFO_SOURCES_NUM; i++)
+                {
+                    if (is_parsed(from, i, id))
+                    {
+                        (to.*member).cont[i] = (from.*member).cont[i];
+                    }
+                }
+            });
+        }
+    }
+
+    // Only the source's parsed values are copied, its slot
+    // in 'to' is replaced, other sources are left as they're.
+    inline void copy_parsed(
+        const srv::types::info &from,
+        srv::types::info &to,
+        const std::size_t source_id)
+    {
+        to.parsed[source_id] = from.parsed[source_id];
+
+        for (std::uint8_t id{ 0u }; id < constants::INFO_FIELDS_NUM; id++)
+        {
+            if (is_parsed(from, source_id, id))
+            {
+                visit_member(id, [&] (const auto member)
+                {
+                    (to.*member).cont[source_id] = (from.*member).cont[source_id];
+                });
+            }
+        }
+    }
+
+    template<typename info_T, typename F>
+        constexpr void for_each_field(info_T &info, F &&f)
+    {
+        for (std::uint8_t id{ 0u }; id < constants::INFO_FIELDS_NUM; id++)
+        {
+            visit_field(info, id, f);
+        }
+    }
+}
+
+#endif // IPINFO_FIELDS_HPP
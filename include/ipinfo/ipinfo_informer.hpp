@@ -5,44 +5,119 @@
 #include "ipinfo_types.hpp"
 #include "ipinfo_aliases.hpp"
 
+#include <chrono>
 #include <cstdint>
 #include <cstddef>
 
 #include <string>
 #include <vector>
 #include <map>
+#include <memory>
 
 namespace ipinfo::srv
 {
     class requester;
     class parser;
     class utiler;
+    class loop;
 }
 
 namespace ipinfo::usr
 {
     class informer;
+    class batch_informer;
+    class cache;
+    class database;
+    class database_builder;
 }
 
 class ipinfo::usr::informer
 {
+    friend class usr::batch_informer;
+    friend class usr::cache;
+    friend class usr::database_builder;
+    friend class srv::loop;
+
   private:
     std::string __ip{};
     std::string __lang{};
     std::uint8_t __conn_num{ 0u };
+    std::uint8_t __run_mode{ constants::RUN_MODES_IDS::SEQUENTIAL };
+    std::uint8_t __retries_num{ constants::DEFAULT_RETRIES_NUM };
+    std::uint8_t __parser_id{ constants::PARSERS_IDS::STREAMING };
+
+    std::chrono::steady_clock::time_point __deadline {
+        std::chrono::steady_clock::time_point::max()
+    };
 
     std::map<std::string, usr::types::error> __errors{};
     std::map<std::string, std::string> __api_keys{};
     std::vector<std::string> __excluded_hosts{};
     srv::types::info __info{};
+    std::shared_ptr<usr::cache> __cache{};
+    std::shared_ptr<usr::database> __database{};
+    std::uint8_t __database_mode{ constants::DATABASE_MODES_IDS::PREFERRED };
 
     srv::requester * const __requester{};
-    srv::parser * const __parser{};
     srv::utiler * const __utiler{};
 
     bool __is_api_key_setted_up(const std::string &host) const;
     bool __is_host_excluded(const std::string &host) const;
     als::req_attrs __get_request_attributes(const std::string &host) const;
+    std::vector<std::string> __get_active_hosts();
+
+    // the hosts' ids bitmask, it's a part of the cache key
+    static std::uint8_t __get_hosts_mask(const std::vector<std::string> &hosts);
+
+    // for informers which are filled outside of 'run()'
+    informer(
+        const std::string &ip,
+        const std::string &lang,
+        const srv::types::info &info);
+
+    // Reserved IPs and IPs of the database are answered without
+    // requests, returns true if the IP is done. The info is empty.
+    bool __run_locally();
+
+    // the IP isn't in the database, returns true if it's done anyway
+    bool __miss_database();
+
+    static bool __is_transient(const srv::types::response &resp);
+
+    // The request goes through the host's circuit breaker,
+    // transient failures are retried until the deadline.
+    static srv::types::response __request(
+        const srv::types::request_attributes &ra,
+        const std::uint8_t retries_num);
+
+    void __parse(
+        const std::string &json,
+        const std::string &host);
+
+    // A host answers a failure with a message instead of data,
+    // it's turned into the host's error by the message's class.
+    void __check_failure(const std::string &host);
+
+    void __handle_response(
+        const std::string &host,
+        const srv::types::response &resp);
+
+    void __set_timeout_error(const std::string &host);
+
+    void __run_sequentially(const std::vector<std::string> &hosts);
+    void __run_concurrently(const std::vector<std::string> &hosts);
+    void __run_hedged(const std::vector<std::string> &hosts);
+
+    // The loop of the process which hedged requests are sent by.
+    // It's created after the singletons its transfers use, so
+    // it's stopped before they're destroyed at the exit.
+    static srv::loop &__get_hedges_loop();
+
+    // the value of the first host which has parsed the field
+    template<typename node_T>
+        auto __get_node_ex(
+            const node_T &node,
+            const std::uint8_t field_id) const;
 
   public:
     informer() = default;
@@ -57,6 +132,44 @@ class ipinfo::usr::informer
 
     void set_ip(const std::string &ip);
     void set_connections_num(const std::uint8_t n);
+    void set_run_mode(const std::uint8_t mode_id);
+    void set_retries_num(const std::uint8_t n);
+    void set_parser(const std::uint8_t parser_id);
+
+    // Results are looked up in the cache before any request and
+    // stored there after a run, concurrent runs of the same lookup
+    // share one run's requests. Null detaches it.
+    void set_cache(const std::shared_ptr<usr::cache> &cache);
+
+    // The database is asked before the cache and hosts, its results
+    // have the 'local' host. Null detaches it.
+    void set_database(
+        const std::shared_ptr<usr::database> &db,
+        const std::uint8_t mode_id = constants::DATABASE_MODES_IDS::PREFERRED);
+
+    // connections pool is shared by all informers
+    static void set_pool_size(const std::size_t n);
+    static void set_pool_idle_timeout(const std::chrono::milliseconds &timeout);
+
+    // requests quota is shared by all informers, zero limit means
+    // there is no per-minute limit
+    static void set_rate_limit(
+        const std::string &host,
+        const std::uint32_t per_minute);
+
+    static void set_rate_limit(
+        const std::uint8_t host_id,
+        const std::uint32_t per_minute);
+
+    static usr::types::quota get_quota(const std::string &host);
+    static usr::types::quota get_quota(const std::uint8_t host_id);
+
+    // hosts' health is shared by all informers too
+    static void set_breaker_threshold(const std::uint32_t failures);
+    static void set_breaker_cooldown(const std::chrono::milliseconds &cooldown);
+
+    static std::uint8_t get_host_state(const std::string &host);
+    static std::uint8_t get_host_state(const std::uint8_t host_id);
 
     void set_lang(const std::string &lang);
     void set_lang(const std::uint8_t lang_id);
@@ -80,6 +193,12 @@ class ipinfo::usr::informer
 
     void run(); // let's ROLL!
 
+    // All requests of the run are aborted at the deadline. The data
+    // which is parsed by then is kept, the hosts which haven't answered
+    // have the 'REQUEST_TIMEOUT' error.
+    void run(const std::chrono::milliseconds &budget);
+    void run(const std::chrono::steady_clock::time_point &deadline);
+
     usr::types::error get_last_error(const std::string &host) const;
     usr::types::error get_last_error(const std::uint8_t host_id) const;
     std::uint8_t get_errors_num() const;
@@ -118,6 +237,7 @@ class ipinfo::usr::informer
     std::string get_currency_symbol() const;
     double get_currency_rates() const;
     std::string get_currency_plural() const;
+    bool get_reserved_status() const;
 
     // extra information getters
     als::u_node<std::string> get_ip_ex() const;
@@ -153,6 +273,7 @@ class ipinfo::usr::informer
     als::u_node<std::string> get_currency_symbol_ex() const;
     als::u_node<double>      get_currency_rates_ex() const;
     als::u_node<std::string> get_currency_plural_ex() const;
+    als::u_node<bool>        get_reserved_status_ex() const;
 };
 
 #endif // IPINFO_INFORMER_HPP
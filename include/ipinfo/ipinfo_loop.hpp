@@ -0,0 +1,120 @@
+#ifndef IPINFO_LOOP_HPP
+    #define IPINFO_LOOP_HPP
+
+#include "ipinfo_types.hpp"
+#include "ipinfo_informer.hpp"
+
+#include <curl/curl.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+namespace ipinfo::srv
+{
+    class loop;
+}
+
+// The loop drives a lot of requests from one thread by the
+// libcurl multi interface. Lookups may be submitted from any
+// thread, a callback is called from the loop's thread when all
+// the hosts of a lookup have answered or failed.
+
+class ipinfo::srv::loop
+{
+  public:
+    using callback = std::function<void(usr::informer &&)>;
+
+  private:
+    struct __lookup
+    {
+        usr::informer infr{};
+        callback cb{};
+        std::chrono::steady_clock::time_point deadline{};
+        std::size_t pending{ 0u };
+        std::uint8_t hosts_mask{ 0u }; // it's zero for cache hits
+    };
+
+    struct __transfer
+    {
+        std::shared_ptr<__lookup> lookup{};
+        std::string host{};
+        std::string answ{};
+        ::CURL *easy{};
+
+        // values of the rate limit headers
+        std::string remaining{}, reset_in{};
+    };
+
+    // a request which waits for a token of the host's bucket
+    struct __deferred
+    {
+        std::shared_ptr<__lookup> lookup{};
+        std::string host{};
+        std::chrono::steady_clock::time_point ready_at{};
+    };
+
+    ::CURLM *__multi{};
+    std::thread __worker{};
+    std::atomic<bool> __is_stopped{ false };
+
+    std::mutex __mtx{};
+    std::vector<std::shared_ptr<__lookup>> __queue{};
+
+    // handles of the transfers in flight and
+    // reset handles for the next transfers
+    std::unordered_set<::CURL *> __easies{};
+    std::vector<::CURL *> __idle_easies{};
+
+    std::vector<__deferred> __deferreds{};
+
+    static std::size_t __write(
+        char *data,
+        std::size_t size,
+        std::size_t n,
+        void *answ);
+
+    static std::size_t __read_header(
+        char *data,
+        std::size_t size,
+        std::size_t n,
+        void *trns);
+
+    ::CURL *__acquire_easy();
+    void __release_easy(::CURL *easy);
+
+    void __start(const std::shared_ptr<__lookup> &lkp);
+    void __start_queued();
+
+    void __start_transfer(
+        const std::shared_ptr<__lookup> &lkp,
+        const std::string &host);
+
+    // returns a time to wait for the next deferred request
+    std::chrono::milliseconds __start_deferreds();
+    void __finish(::CURL *easy, const ::CURLcode result);
+    void __settle(__lookup &lkp); // one more host of the lookup is done
+    void __complete(__lookup &lkp);
+    void __run();
+
+  public:
+    explicit loop(const std::size_t max_host_requests);
+    ~loop();
+
+    loop(const loop &) = delete;
+    loop &operator=(const loop &) = delete;
+
+    void submit(
+        const usr::informer &infr,
+        const std::chrono::steady_clock::time_point &deadline,
+        callback cb);
+};
+
+#endif // IPINFO_LOOP_HPP
@@ -6,47 +6,61 @@
 #include <cjson/cJSON.h>
 #include <cstdint>
 #include <string>
+#include <vector>
+
+// Fill functions return true if the item's value is parsed.
 
 class ipinfo::srv::parser
 {
   private:
-    ::cJSON * __prepare(const std::string &json);
+    usr::types::error __error{};
 
-    template<template<typename ...> typename T, typename sub_T>
-        void __catch_node(
-            const ::cJSON &data,
-            T<sub_T> &node,
-            const std::string &host);
+    ::cJSON * __prepare(const std::string &json);
 
     template<template<typename ...> typename T>
-        void __fill_node(
+        bool __fill_node(
             T<std::string> &node,
             const ::cJSON &item,
-            const std::string &host);
+            const std::uint8_t host_id);
 
     template<template<typename ...> typename T>
-        void __fill_node(
+        bool __fill_node(
             T<std::int32_t> &node,
             const ::cJSON &item,
-            const std::string &host);
+            const std::uint8_t host_id);
 
     template<template<typename ...> typename T>
-        void __fill_node(
+        bool __fill_node(
             T<double> &node,
             const ::cJSON &item,
-            const std::string &host);
+            const std::uint8_t host_id);
 
     template<template<typename ...> typename T>
-        void __fill_node(
+        bool __fill_node(
             T<bool> &node,
             const ::cJSON &item,
-            const std::string &host);
+            const std::uint8_t host_id);
+
+    void __parse_object(
+        const ::cJSON &data,
+        srv::types::info &info,
+        const std::uint8_t host_id);
+
   public:
     void parse(
         const std::string &json,
         srv::types::info &info,
         const std::string &host);
 
+    // Every element of the answer's array is parsed to
+    // the info with the same index, 'infos' are resized
+    // to the answer's array size.
+
+    void parse_batch(
+        const std::string &json,
+        std::vector<srv::types::info> &infos,
+        const std::string &host);
+
     usr::types::error get_last_error(void) const;
 };
 
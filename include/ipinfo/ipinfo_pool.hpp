@@ -0,0 +1,66 @@
+#ifndef IPINFO_POOL_HPP
+    #define IPINFO_POOL_HPP
+
+#include "ipinfo_constants.hpp"
+
+#include <cpr/cpr.h>
+
+#include <chrono>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace ipinfo::srv
+{
+    class pool;
+}
+
+// The pool is shared by all informers of the process. It keeps
+// idle sessions of every host, thus DNS resolving, TCP handshake
+// and libcurl handle setup are paid only once per connection.
+
+class ipinfo::srv::pool
+{
+  private:
+    using clock = std::chrono::steady_clock;
+
+    struct __entry
+    {
+        std::unique_ptr<cpr::Session> session{};
+        clock::time_point last_use{};
+    };
+
+    std::mutex __mtx{};
+    std::map<std::string, std::vector<__entry>> __idle{};
+
+    std::size_t __size{ constants::DEFAULT_POOL_SIZE };
+    std::chrono::milliseconds __idle_timeout {
+        constants::DEFAULT_POOL_IDLE_TIMEOUT
+    };
+
+    pool() = default;
+
+    void __drop_expired(
+        std::vector<__entry> &entries,
+        const clock::time_point now);
+
+  public:
+    pool(const pool &) = delete;
+    pool &operator=(const pool &) = delete;
+
+    static pool &instance();
+
+    std::unique_ptr<cpr::Session> acquire(const std::string &host);
+
+    void release(
+        const std::string &host,
+        std::unique_ptr<cpr::Session> session);
+
+    void set_size(const std::size_t n);
+    void set_idle_timeout(const std::chrono::milliseconds &timeout);
+};
+
+#endif // IPINFO_POOL_HPP
@@ -5,6 +5,7 @@
 #include "ipinfo_aliases.hpp"
 
 #include <string>
+#include <vector>
 
 namespace ipinfo::srv
 {
@@ -20,8 +21,15 @@ class ipinfo::srv::requester
         const std::string &host,
         const std::string &lang) const;
 
+    std::string __get_batch_body(const std::vector<std::string> &ips) const;
+
   public:
-    std::string request(const srv::types::request_attributes &ra) const;
+    srv::types::response request(const srv::types::request_attributes &ra) const;
+    srv::types::response request_batch(const srv::types::batch_request_attributes &bra) const;
+
+    // full URL with the query string, it's used by
+    // the requests which are made without cpr
+    std::string get_url(const srv::types::request_attributes &ra) const;
     usr::types::error get_last_error() const;
 };
 
@@ -0,0 +1,87 @@
+#ifndef IPINFO_SCHEDULER_HPP
+    #define IPINFO_SCHEDULER_HPP
+
+#include "ipinfo_types.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace ipinfo::srv
+{
+    class scheduler;
+}
+
+// The scheduler keeps a token bucket per host for all informers of
+// the process. A request takes a token before it's sent, and waits
+// for one if the bucket is empty, so hosts never throttle us. The
+// bucket follows the quota reported by the hosts in the answers.
+
+class ipinfo::srv::scheduler
+{
+  public:
+    using clock = std::chrono::steady_clock;
+
+  private:
+    struct __bucket
+    {
+        std::uint32_t limit{ 0u };
+        double tokens{ 0.0 };
+        clock::time_point last_refill{};
+
+        // While the host's window is known, tokens aren't refilled
+        // continuously, the bucket becomes full at the window reset.
+        clock::time_point reset_at{};
+    };
+
+    std::mutex __mtx{};
+    std::map<std::string, __bucket> __buckets{};
+
+    scheduler() = default;
+
+    __bucket &__get_bucket(const std::string &host);
+    void __refill(__bucket &bkt, const clock::time_point now) const;
+
+    clock::time_point __get_next_token_time(
+        const __bucket &bkt,
+        const clock::time_point now) const;
+
+  public:
+    scheduler(const scheduler &) = delete;
+    scheduler &operator=(const scheduler &) = delete;
+
+    static scheduler &instance();
+
+    // Blocks until a token is taken. Returns false if there
+    // will be no token before the deadline, nothing is taken.
+    bool acquire(
+        const std::string &host,
+        const clock::time_point deadline = clock::time_point::max());
+
+    // Doesn't block. If there is no token, 'wait' is set to
+    // the time which is left until the next token.
+    bool try_acquire(
+        const std::string &host,
+        clock::duration &wait);
+
+    // values of the rate limit headers of an answer
+    void update(
+        const std::string &host,
+        const std::string &remaining,
+        const std::string &reset_in);
+
+    // the host has answered '429 Too Many Requests'
+    void throttle(
+        const std::string &host,
+        const std::string &reset_in);
+
+    void set_limit(
+        const std::string &host,
+        const std::uint32_t per_minute);
+
+    usr::types::quota get_quota(const std::string &host);
+};
+
+#endif // IPINFO_SCHEDULER_HPP
@@ -0,0 +1,49 @@
+#ifndef IPINFO_SKETCH_HPP
+    #define IPINFO_SKETCH_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace ipinfo::srv
+{
+    class sketch;
+}
+
+// The sketch estimates how often keys are looked up (a count-min sketch
+// of 4-bit counters, as TinyLFU has). A key's counter is taken from each
+// of the rows, the least one is the estimate. When the number of
+// recorded lookups reaches ten times the number of tracked entries,
+// all counters are halved, so the estimate follows recent traffic.
+//
+// Counters are updated without locks, so concurrent lookups may lose
+// an increment, the estimate is approximate anyway. 'resize()' must
+// not be called concurrently with other methods.
+
+class ipinfo::srv::sketch
+{
+  private:
+    static constexpr std::size_t __DEPTH{ 4u };
+    static constexpr std::uint8_t __MAX_COUNT{ 15u };
+    static constexpr std::size_t __SAMPLES_FACTOR{ 10u };
+
+    std::unique_ptr<std::atomic<std::uint8_t>[]> __counters{};
+    std::size_t __width{ 0u }; // of a row, power of two
+    std::size_t __samples_limit{ 0u };
+    std::atomic<std::size_t> __samples_num{ 0u };
+
+    std::size_t __get_index(const std::size_t hash, const std::size_t row) const;
+    void __age();
+
+  public:
+    // the width of a row is the number of entries rounded up
+    explicit sketch(const std::size_t entries_num);
+
+    void resize(const std::size_t entries_num);
+
+    void record(const std::size_t hash);
+    std::uint8_t estimate(const std::size_t hash) const;
+};
+
+#endif // IPINFO_SKETCH_HPP
@@ -0,0 +1,177 @@
+#ifndef IPINFO_STORE_HPP
+    #define IPINFO_STORE_HPP
+
+#include "ipinfo_types.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// The store keeps cached results in a file, so they survive a restart.
+// The file is mapped and read in place, nothing is loaded at the start:
+//
+//   header | records | hash table | records appended after the table
+//
+// The hash table is written by the compaction and is probed right in
+// the mapping. Records which are appended later are indexed in memory
+// by a scan of the file's tail at the opening. Every record has a CRC,
+// the scan stops at the first broken one and the file is truncated
+// there, so a torn write loses only itself. The compaction writes a new
+// file next to the old one and renames it, which is atomic.
+//
+// Numbers are written in the host's byte order, the file isn't meant
+// to be moved between machines.
+
+class ipinfo::srv::store
+{
+  public:
+    using clock = std::chrono::system_clock;
+
+  private:
+    struct __header
+    {
+        char magic[8]{};
+        std::uint32_t version{ 0u };
+        std::uint32_t slots_num{ 0u };
+        std::uint64_t table_offset{ 0u };
+        std::uint64_t tail_offset{ 0u };
+        std::uint32_t crc{ 0u };
+        std::uint32_t reserved{ 0u };
+    };
+
+    // the CRC covers the record from 'expires_at' to the end
+    struct __record_header
+    {
+        std::uint32_t size{ 0u }; // the whole record
+        std::uint32_t crc{ 0u };
+        std::int64_t expires_at{ 0 }; // milliseconds since the epoch
+        std::uint32_t key_len{ 0u };
+        std::uint32_t reserved{ 0u };
+    };
+
+    // an empty slot has the zero offset, the header is there
+    struct __slot
+    {
+        std::uint64_t hash{ 0u };
+        std::uint64_t offset{ 0u };
+    };
+
+    mutable std::shared_mutex __mtx{};
+
+    // Lookups of a cache without a file don't take the lock,
+    // it's set under the lock when the file is opened or closed.
+    std::atomic<bool> __is_open{ false };
+
+    std::string __path{};
+    int __fd{ -1 };
+    bool __is_read_only{ false };
+
+    const char *__data{ nullptr };
+    std::size_t __map_size{ 0u };
+    std::size_t __file_size{ 0u };
+
+    __header __hdr{};
+    std::unordered_map<std::string, std::uint64_t> __tail{};
+
+    usr::types::error __error{};
+
+    static std::uint64_t __hash(const std::string_view key);
+
+    bool __fail(const std::uint8_t code, const std::string &desc);
+
+    bool __open(const std::string &path, const bool is_read_only);
+    bool __map();
+    void __unmap();
+    bool __init_file();
+    bool __read_header();
+    void __scan_tail();
+
+    // Returns false if the record at the offset is out of the file,
+    // its CRC isn't checked. Lookups take records of the table so.
+    bool __view_record(
+        const std::uint64_t offset,
+        __record_header &rec,
+        std::string_view &key,
+        std::string_view &value) const;
+
+    // returns false if the record at the offset is broken
+    bool __read_record(
+        const std::uint64_t offset,
+        __record_header &rec,
+        std::string_view &key,
+        std::string_view &value) const;
+
+    // returns the record's offset or zero
+    std::uint64_t __find_offset(const std::string &key) const;
+
+    // The offset of the newest record of every key, the tail overrides
+    // the table. Expired and erased records are skipped.
+    void __get_live(std::unordered_map<std::string_view, std::uint64_t> &live) const;
+
+    bool __append(
+        const std::string &key,
+        const std::string &value,
+        const std::int64_t expires_at);
+
+    // The records are written to a new file with a new hash table,
+    // it replaces the old one by a rename. The old file is kept if
+    // the new one isn't complete.
+    bool __rewrite(const std::unordered_map<std::string_view, std::uint64_t> &live);
+
+  public:
+    store() = default;
+    ~store();
+
+    store(const store &) = delete;
+    store &operator=(const store &) = delete;
+
+    // The file is created if there is no one. The previous
+    // file of the store is closed, even if the opening fails.
+    bool open(const std::string &path);
+
+    // The file isn't changed: it isn't created, a torn tail isn't cut
+    // and changes of the store fail. So a file which a running service
+    // appends to may be read, records appended later aren't seen.
+    bool open_read_only(const std::string &path);
+
+    void close();
+
+    bool is_open() const;
+
+    bool find(
+        const std::string &key,
+        srv::types::info &info,
+        clock::time_point &expires_at) const;
+
+    bool insert(
+        const std::string &key,
+        const srv::types::info &info,
+        const clock::time_point &expires_at);
+
+    // an expired record is appended over every record of the prefix
+    bool erase_prefix(const std::string &prefix);
+    bool clear();
+
+    // live records are rewritten to a new file with a new hash table
+    bool compact();
+
+    // 'f' is called with every live record in the order of their keys,
+    // returns false if there is no file. The store mustn't be changed by 'f'.
+    bool for_each(
+        const std::function<void(const std::string_view key, const srv::types::info &info)> &f) const;
+
+    usr::types::error get_last_error() const;
+
+    // Only parsed values are written. The reading returns false if
+    // the data is shorter than the values which are declared.
+    static void serialize(const srv::types::info &info, std::string &out);
+    static bool deserialize(std::string_view data, srv::types::info &info);
+};
+
+#endif // IPINFO_STORE_HPP
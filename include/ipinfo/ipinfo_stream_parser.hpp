@@ -0,0 +1,86 @@
+#ifndef IPINFO_STREAM_PARSER_HPP
+    #define IPINFO_STREAM_PARSER_HPP
+
+#include "ipinfo_types.hpp"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// The stream parser reads an answer in one pass and writes
+// every known value straight to the info's node, there is
+// no intermediate tree. Keys are resolved by the host's
+// compile-time fields table. Unknown keys and values of wrong
+// types are skipped, just like the cJSON parser does. If
+// the answer is malformed, the values which are read before
+// the error location are kept.
+
+class ipinfo::srv::stream_parser
+{
+  private:
+    using str_node = decltype(srv::types::info::ip);
+    using i32_node = decltype(srv::types::info::gmt_offset);
+    using dbl_node = decltype(srv::types::info::latitude);
+    using bool_node = decltype(srv::types::info::is_hosting);
+
+    enum __TOKENS_IDS : std::uint8_t
+    {
+        STRING = 0u,
+        NUMBER,
+        LITERAL_TRUE,
+        LITERAL_FALSE,
+        LITERAL_NULL,
+        COMPOSITE // objects and arrays aren't read, only skipped
+    };
+
+    struct __token
+    {
+        std::uint8_t id{ __TOKENS_IDS::LITERAL_NULL };
+        std::string_view text{};
+        bool is_escaped : (1u) { false };
+    };
+
+    const char *__first{};
+    const char *__cur{};
+    const char *__end{};
+    usr::types::error __error{};
+
+    static void __unescape(std::string_view raw, std::string &out);
+
+    void __skip_spaces();
+    bool __expect(const char c);
+    bool __read_string(std::string_view &raw, bool &is_escaped);
+    bool __read_literal(const std::string_view literal);
+    bool __skip_composite();
+    bool __read_token(__token &tkn);
+    bool __fail(const std::string &desc);
+
+    // return true if the token's value is parsed
+    bool __fill_node(str_node &node, const __token &tkn, const std::uint8_t host_id);
+    bool __fill_node(i32_node &node, const __token &tkn, const std::uint8_t host_id);
+    bool __fill_node(dbl_node &node, const __token &tkn, const std::uint8_t host_id);
+    bool __fill_node(bool_node &node, const __token &tkn, const std::uint8_t host_id);
+
+    bool __parse_object(
+        srv::types::info &info,
+        const std::uint8_t host_id);
+
+    bool __begin(const std::string &json, const std::uint8_t host_id);
+
+  public:
+    void parse(
+        const std::string &json,
+        srv::types::info &info,
+        const std::string &host);
+
+    // the same contract as 'srv::parser::parse_batch()' has
+    void parse_batch(
+        const std::string &json,
+        std::vector<srv::types::info> &infos,
+        const std::string &host);
+
+    usr::types::error get_last_error(void) const;
+};
+
+#endif // IPINFO_STREAM_PARSER_HPP
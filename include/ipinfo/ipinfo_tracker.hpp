@@ -0,0 +1,47 @@
+#ifndef IPINFO_TRACKER_HPP
+    #define IPINFO_TRACKER_HPP
+
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace ipinfo::srv
+{
+    class tracker;
+}
+
+// The tracker observes latencies of the hosts' answers for all
+// informers of the process. It keeps smoothed latency and its
+// deviation like TCP does for the retransmission timeout.
+
+class ipinfo::srv::tracker
+{
+  private:
+    struct __stats
+    {
+        bool has_samples : (1u) { false };
+        double latency{ 0.0 }, deviation{ 0.0 }; // ms
+    };
+
+    std::mutex __mtx{};
+    std::map<std::string, __stats> __hosts{};
+
+    tracker() = default;
+
+  public:
+    tracker(const tracker &) = delete;
+    tracker &operator=(const tracker &) = delete;
+
+    static tracker &instance();
+
+    void add_sample(
+        const std::string &host,
+        const std::chrono::milliseconds &latency);
+
+    // Time after which an answer of the host is late. Most of the
+    // answers arrive earlier, it's clamped by the hedge constants.
+    std::chrono::milliseconds get_hedge_delay(const std::string &host);
+};
+
+#endif // IPINFO_TRACKER_HPP
@@ -0,0 +1,144 @@
+#ifndef IPINFO_TRIE_HPP
+    #define IPINFO_TRIE_HPP
+
+#include "ipinfo_types.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ipinfo::srv
+{
+    class trie;
+}
+
+// The trie finds the longest prefix which an address matches, prefixes
+// of both families are in one trie and may overlap. IPv4 is mapped to
+// '::ffff:0:0/96', so an IPv4 prefix is longer than 96 bits, and IPv6
+// prefixes which are shorter than 96 bits cover IPv4 too.
+//
+// The first 16 bits of an address index a table of the family, the
+// rest is consumed by 6 bits per node (a multibit trie, as Poptrie
+// has). A node keeps two 64-bit masks instead of 64 slots: the slots
+// which are nodes and the slots where a run of equal values starts,
+// both are indexed by a popcount. Values are pushed to the leaves when
+// the trie is built, so a lookup ends at the first leaf: an IPv4 one
+// takes the table and three nodes at most.
+//
+// The trie is built at once and isn't changed after. It's serialized
+// as it's kept in memory, so a mapped file is looked up in place.
+// Lookups are read-only and need no locks.
+
+class ipinfo::srv::trie
+{
+  public:
+    // 'len' is counted in the 128-bit address, 'value' isn't zero
+    // and its high bit is clear, other prefixes are skipped
+    struct prefix
+    {
+        std::uint64_t hi{ 0u };
+        std::uint64_t lo{ 0u };
+        std::uint8_t len{ 0u };
+        std::uint32_t value{ 0u };
+    };
+
+    static constexpr std::uint32_t NO_VALUE{ 0u };
+
+  private:
+    static constexpr std::size_t __TOP_BITS{ 16u };
+    static constexpr std::size_t __TOP_SIZE{ std::size_t{ 1u } << __TOP_BITS };
+    static constexpr std::size_t __STRIDE{ 6u };
+    static constexpr std::size_t __SLOTS_NUM{ std::size_t{ 1u } << __STRIDE };
+
+    // an entry of the table is a value or a node's index with this bit
+    static constexpr std::uint32_t __NODE_BIT{ 0x80000000u };
+
+    struct __header
+    {
+        char magic[8]{};
+        std::uint32_t version{ 0u };
+        std::uint32_t reserved{ 0u };
+        std::uint64_t nodes_num{ 0u };
+        std::uint64_t leaves_num{ 0u };
+    };
+
+    struct __node
+    {
+        std::uint64_t children{ 0u }; // the slots which are nodes
+        std::uint64_t runs{ 0u };     // the slots where a run of values starts
+        std::uint32_t children_base{ 0u };
+        std::uint32_t leaves_base{ 0u };
+    };
+
+    // A node of the build, it has all its slots. A child's index
+    // is shifted by one, so zero means there is no child.
+    struct __draft
+    {
+        std::uint32_t values[__SLOTS_NUM]{};
+        std::uint32_t children[__SLOTS_NUM]{};
+    };
+
+    // a built trie owns its data, a viewed one doesn't
+    std::vector<std::uint32_t> __own_table{};
+    std::vector<__node> __own_nodes{};
+    std::vector<std::uint32_t> __own_leaves{};
+
+    const std::uint32_t *__table{ nullptr }; // IPv4's part, then IPv6's one
+    const __node *__nodes{ nullptr };
+    const std::uint32_t *__leaves{ nullptr };
+    std::size_t __nodes_num{ 0u };
+    std::size_t __leaves_num{ 0u };
+
+    // The address is aligned to the left in its family's bits: an
+    // IPv4 one is in the high 32 bits. Returns the table's offset.
+    static std::size_t __to_family(std::uint64_t &hi, std::uint64_t &lo);
+
+    // 'bits_num' bits at the offset, bits after the address are zeros
+    static std::uint32_t __get_bits(
+        const std::uint64_t hi,
+        const std::uint64_t lo,
+        const std::size_t offset,
+        const std::size_t bits_num);
+
+    // a new draft has the value in all its slots, returns its index
+    static std::uint32_t __add_draft(
+        std::vector<__draft> &drafts,
+        const std::uint32_t value);
+
+    // the prefix is aligned as the address and 'len' is in its family
+    static void __insert(
+        std::vector<std::uint32_t> &table,
+        std::vector<std::uint32_t> &table_children,
+        std::vector<__draft> &drafts,
+        const std::size_t table_offset,
+        const prefix &pfx);
+
+    void __set_own();
+
+  public:
+    trie() = default;
+    explicit trie(std::vector<prefix> prefixes);
+
+    trie(const trie &) = delete;
+    trie &operator=(const trie &) = delete;
+
+    // the longest prefix wins, of equal ones the last one
+    void build(std::vector<prefix> prefixes);
+
+    // 'view()' takes the data as it's written here
+    void serialize(std::string &out) const;
+
+    // The data isn't copied, it must outlive the trie and be aligned
+    // to 8 bytes. Returns false if it isn't a trie.
+    bool view(const std::string_view data);
+
+    // returns 'NO_VALUE' if the address matches no prefix
+    std::uint32_t find(std::uint64_t hi, std::uint64_t lo) const;
+    std::uint32_t find(const srv::types::address &addr) const;
+
+    std::size_t get_size() const; // bytes which lookups may touch
+};
+
+#endif // IPINFO_TRIE_HPP
@@ -4,19 +4,27 @@
 #include "ipinfo_constants.hpp"
 #include "ipinfo_aliases.hpp"
 
-#include <map>     // std::map
+#include <array>   // std::array
 #include <string>  // std::string
-#include <cstdint> // std::uint8_t, std::int32_t
+#include <vector>  // std::vector
+#include <chrono>  // std::chrono::milliseconds, std::chrono::steady_clock
+#include <cstddef> // std::size_t
+#include <cstdint> // std::uint8_t, std::int32_t, std::uint32_t, std::uint64_t
 
 namespace ipinfo::srv::types
 {
     struct info;
     struct request_attributes;
+    struct batch_request_attributes;
+    struct response;
+    struct address;
 }
 
 namespace ipinfo::usr::types
 {
     struct error;
+    struct quota;
+    struct cache_stats;
 
     template<typename T>
     struct node;
@@ -28,6 +36,29 @@ struct ipinfo::usr::types::error
     std::string desc{};
 };
 
+// Requests quota of a host. The quota isn't limited if
+// 'is_limited' is false, other fields are zeros then.
+
+struct ipinfo::usr::types::quota
+{
+    bool is_limited : (1u) { false };
+    std::uint32_t remaining{ 0u }, limit{ 0u };
+    std::chrono::milliseconds reset_in{ 0 };
+};
+
+struct ipinfo::usr::types::cache_stats
+{
+    std::uint64_t hits{ 0u }, misses{ 0u };
+    std::uint64_t evictions{ 0u }, expirations{ 0u };
+    std::uint64_t range_hits{ 0u };    // hits by a neighbouring IP's result
+    std::uint64_t file_hits{ 0u };     // hits which are read from the file
+    std::uint64_t negative_hits{ 0u }; // hits by a failed lookup's result
+    std::uint64_t coalesced{ 0u };     // misses which waited for another lookup
+    std::uint64_t refreshes{ 0u };     // stale hits which were looked up again
+    std::uint64_t rejections{ 0u };    // new results which weren't admitted
+    std::size_t entries{ 0u }, bytes{ 0u };
+};
+
 template<typename T>
 struct ipinfo::usr::types::node
 {
@@ -36,791 +67,97 @@ struct ipinfo::usr::types::node
     std::string host{}, desc{};
 };
 
-struct ipinfo::srv::types::request_attributes
+// An IP in the numeric form, IPv4 addresses are mapped
+// to '::ffff:a.b.c.d', so both families are 128 bits long.
+
+struct ipinfo::srv::types::address
 {
-    const std::string host{}, ip{}, lang{}, api_key{};
+    std::array<std::uint8_t, 16u> bytes{};
+    bool is_v4{ false };
 };
 
-struct ipinfo::srv::types::info
+struct ipinfo::srv::types::request_attributes
 {
-  private:
-    template<typename T> struct node
-    {
-        struct data
-        {
-            bool is_parsed : (1u) { false };
-            T val{};
-            const std::string json_name{};
-        };
-
-        const std::string desc{};
-        std::map<const std::string, data> cont{};
-
-    };
-
-  public:
-    node<std::string> ip
-    {
-        .desc{ "IP address" },
-        .cont
-        {
-            {
-                als::C::AVAILABLE_HOSTS.at(
-                    constants::AVAILABLE_HOSTS_IDS::IP_API_COM),
-                {
-                    .json_name{ "query" }
-                }
-            },
-
-            {
-                constants::AVAILABLE_HOSTS.at(
-                    constants::AVAILABLE_HOSTS_IDS::IPWHOIS_APP),
-                {
-                    .json_name{ "ip" }
-                }
-            }
-        }
-    };
-
-    node<std::string> ip_type
-    {
-        .desc{ "IP address type" },
-        .cont
-        {
-            {
-                constants::AVAILABLE_HOSTS.at(
-                    constants::AVAILABLE_HOSTS_IDS::IP_API_COM),
-                {
-                    .json_name{}
-                }
-            },
-
-            {
-                constants::AVAILABLE_HOSTS.at(
-                    constants::AVAILABLE_HOSTS_IDS::IPWHOIS_APP),
-                {
-                    .json_name{ "type" }
-                }
-            }
-        }
-    };
-
-    node<std::string> continent
-    {
-        .desc{ "Continent name" },
-        .cont
-        {
-            {
-                constants::AVAILABLE_HOSTS.at(
-                    constants::AVAILABLE_HOSTS_IDS::IP_API_COM),
-                {
-                    .json_name{ "continent" }
-                }
-            },
-
-            {
-                constants::AVAILABLE_HOSTS.at(
-                        constants::AVAILABLE_HOSTS_IDS::IPWHOIS_APP),
-                {
-                    .json_name{ "continent" }
-                }
-            }
-        }
-    };
-
-    node<std::string> continent_code
-    {
-        .desc{ "Continent code" },
-        .cont
-        {
-            {
-                constants::AVAILABLE_HOSTS.at(
-                        constants::AVAILABLE_HOSTS_IDS::IP_API_COM),
-                {
-                    .json_name{ "continentCode" }
-                }
-            },
-
-            {
-                constants::AVAILABLE_HOSTS.at(
-                        constants::AVAILABLE_HOSTS_IDS::IPWHOIS_APP),
-                {
-                    .json_name{ "continent_code" }
-                }
-            }
-        }
-    };
-
-    node<std::string> country
-    {
-        .desc{ "Country name" },
-        .cont
-        {
-            {
-                constants::AVAILABLE_HOSTS.at(
-                        constants::AVAILABLE_HOSTS_IDS::IP_API_COM),
-                {
-                    .json_name{ "country" }
-                }
-            },
-
-            {
-                constants::AVAILABLE_HOSTS.at(
-                        constants::AVAILABLE_HOSTS_IDS::IPWHOIS_APP),
-                {
-                    .json_name{ "country" }
-                }
-            }
-        }
-    };
-
-    node<std::string> country_code
-    {
-        .desc{ "Country code" },
-        .cont
-        {
-            {
-                constants::AVAILABLE_HOSTS.at(
-                        constants::AVAILABLE_HOSTS_IDS::IP_API_COM),
-                {
-                    .json_name{ "countryCode" }
-                }
-            },
-
-            {
-                constants::AVAILABLE_HOSTS.at(
-                        constants::AVAILABLE_HOSTS_IDS::IPWHOIS_APP),
-                {
-                    .json_name{ "country_code" }
-                }
-            }
-        }
-    };
-
-    node<std::string> country_capital
-    {
-        .desc{ "The capital of country" },
-        .cont
-        {
-            {
-                constants::AVAILABLE_HOSTS.at(
-                        constants::AVAILABLE_HOSTS_IDS::IP_API_COM),
-                {
-                    .json_name{}
-                }
-            },
-
-            {
-                constants::AVAILABLE_HOSTS.at(
-                        constants::AVAILABLE_HOSTS_IDS::IPWHOIS_APP),
-                {
-                    .json_name{ "country_capital" }
-                }
-            }
-        }
-    };
-
-    node<std::string> country_ph_code
-    {
-        .desc{ "Country phone code" },
-        .cont
-        {
-            {
-                constants::AVAILABLE_HOSTS.at(
-                        constants::AVAILABLE_HOSTS_IDS::IP_API_COM),
-                {
-                    .json_name{}
-                }
-            },
-
-            {
-                constants::AVAILABLE_HOSTS.at(
-                        constants::AVAILABLE_HOSTS_IDS::IPWHOIS_APP),
-                {
-                    .json_name{ "country_phone" }
-                }
-            }
-        }
-    };
-
-    node<std::string> country_neighbors
-    {
-        .desc{ "Neighboring countries" },
-        .cont
-        {
-            {
-                constants::AVAILABLE_HOSTS.at(
-                        constants::AVAILABLE_HOSTS_IDS::IP_API_COM),
-                {
-                    .json_name{}
-                }
-            },
-
-            {
-                constants::AVAILABLE_HOSTS.at(
-                        constants::AVAILABLE_HOSTS_IDS::IPWHOIS_APP),
-                {
-                    .json_name{ "country_neighbours" }
-                }
-            }
-        }
-    };
-
-    node<std::string> region
-    {
-        .desc{ "Region name" },
-        .cont
-        {
-            {
-                constants::AVAILABLE_HOSTS.at(
-                        constants::AVAILABLE_HOSTS_IDS::IP_API_COM),
-                {
-                    .json_name{ "regionName" }
-                }
-            },
-
-            {
-                constants::AVAILABLE_HOSTS.at(
-                        constants::AVAILABLE_HOSTS_IDS::IPWHOIS_APP),
-                {
-                    .json_name{ "region" }
-                }
-            }
-        }
-    };
-
-    node<std::string> region_code
-    {
-        .desc{ "Region code" },
-        .cont
-        {
-            {
-                constants::AVAILABLE_HOSTS.at(
-                        constants::AVAILABLE_HOSTS_IDS::IP_API_COM),
-                {
-                    .json_name{ "region" }
-                }
-            },
-
-            {
-                constants::AVAILABLE_HOSTS.at(
-                        constants::AVAILABLE_HOSTS_IDS::IPWHOIS_APP),
-                {
-                    .json_name{}
-                }
-            }
-        }
-    };
-
-   node<std::string> city
-    {
-        .desc{ "City name" },
-        .cont
-        {
-            {
-                constants::AVAILABLE_HOSTS.at(
-                        constants::AVAILABLE_HOSTS_IDS::IP_API_COM),
-                {
-                    .json_name{ "city" }
-                }
-            },
-
-            {
-                constants::AVAILABLE_HOSTS.at(
-                        constants::AVAILABLE_HOSTS_IDS::IPWHOIS_APP),
-                {
-                    .json_name{ "city" }
-                }
-            }
-        }
-    };
-
-    node<std::string> city_district
-    {
-        .desc{ "City district" },
-        .cont
-        {
-            {
-                constants::AVAILABLE_HOSTS.at(
-                        constants::AVAILABLE_HOSTS_IDS::IP_API_COM),
-                {
-                    .json_name{ "district" }
-                }
-            },
-
-            {
-                constants::AVAILABLE_HOSTS.at(
-                        constants::AVAILABLE_HOSTS_IDS::IPWHOIS_APP),
-                {
-                    .json_name{}
-                }
-            }
-        }
-    };
-
-    node<std::string> zip_code
-    {
-        .desc{ "ZIP code" },
-        .cont
-        {
-            {
-                constants::AVAILABLE_HOSTS.at(
-                        constants::AVAILABLE_HOSTS_IDS::IP_API_COM),
-                {
-                    .json_name{ "zip" }
-                }
-            },
-
-            {
-                constants::AVAILABLE_HOSTS.at(
-                        constants::AVAILABLE_HOSTS_IDS::IPWHOIS_APP),
-                {
-                    .json_name{}
-                }
-            },
-        }
-    };
-
-    node<double> latitude
-    {
-        .desc{ "Latitude" },
-        .cont
-        {
-            {
-                constants::AVAILABLE_HOSTS.at(
-                        constants::AVAILABLE_HOSTS_IDS::IP_API_COM),
-                {
-                    .json_name{ "lat" }
-                }
-            },
-
-            {
-                constants::AVAILABLE_HOSTS.at(
-                        constants::AVAILABLE_HOSTS_IDS::IPWHOIS_APP),
-                {
-                    .json_name{ "latitude" }
-                }
-            }
-        }
-    };
-
-    node<double> longitude
-    {
-        .desc{ "Longitude" },
-        .cont
-        {
-            {
-                constants::AVAILABLE_HOSTS.at(
-                        constants::AVAILABLE_HOSTS_IDS::IP_API_COM),
-                {
-                    .json_name{ "lon" }
-                }
-            },
-
-            {
-                constants::AVAILABLE_HOSTS.at(
-                        constants::AVAILABLE_HOSTS_IDS::IPWHOIS_APP),
-                {
-                    .json_name{ "longitude" }
-                }
-            }
-        }
-    };
-
-    node<std::string> city_timezone
-    {
-        .desc{ "City timezone" },
-        .cont
-        {
-            {
-                constants::AVAILABLE_HOSTS.at(
-                        constants::AVAILABLE_HOSTS_IDS::IP_API_COM),
-                {
-                    .json_name{ "timezone" }
-                }
-            },
-
-            {
-                constants::AVAILABLE_HOSTS.at(
-                        constants::AVAILABLE_HOSTS_IDS::IPWHOIS_APP),
-                {
-                    .json_name{ "timezone" }
-                }
-            }
-        }
-    };
-
-    node<std::string> timezone
-    {
-        .desc{ "Full timezone name" },
-        .cont
-        {
-            {
-                constants::AVAILABLE_HOSTS.at(
-                        constants::AVAILABLE_HOSTS_IDS::IP_API_COM),
-                {
-                    .json_name{}
-                }
-            },
-
-            {
-                constants::AVAILABLE_HOSTS.at(
-                        constants::AVAILABLE_HOSTS_IDS::IPWHOIS_APP),
-                {
-                    .json_name{ "timezone_name" }
-                }
-            }
-
-        }
-    };
-
-    node<std::int32_t> gmt_offset
-    {
-        .desc{ "UTC offset" },
-        .cont
-        {
-            {
-                constants::AVAILABLE_HOSTS.at(
-                        constants::AVAILABLE_HOSTS_IDS::IP_API_COM),
-                {
-                    .json_name{ "offset" }
-                }
-            },
-
-            {
-                constants::AVAILABLE_HOSTS.at(
-                        constants::AVAILABLE_HOSTS_IDS::IPWHOIS_APP),
-                {
-                    .json_name{ "timezone_gmtOffset" }
-                }
-            }
-        }
-    };
-
-    node<std::int32_t> dst_offset
-    {
-        .desc{ "DST offset" },
-        .cont
-        {
-            {
-                constants::AVAILABLE_HOSTS.at(
-                        constants::AVAILABLE_HOSTS_IDS::IP_API_COM),
-                {
-                    .json_name{}
-                }
-            },
-
-            {
-                constants::AVAILABLE_HOSTS.at(
-                        constants::AVAILABLE_HOSTS_IDS::IPWHOIS_APP),
-                {
-                    .json_name{ "timezone_dstOffset" }
-                }
-            }
-        }
-    };
-
-    node<std::string> timezone_gmt
-    {
-        .desc{ "Timezone GMT" },
-        .cont
-        {
-            {
-                constants::AVAILABLE_HOSTS.at(
-                        constants::AVAILABLE_HOSTS_IDS::IP_API_COM),
-                {
-                    .json_name{}
-                }
-            },
-
-            {
-                constants::AVAILABLE_HOSTS.at(
-                        constants::AVAILABLE_HOSTS_IDS::IPWHOIS_APP),
-                {
-                    .json_name{ "timezone_gmt" }
-                }
-            }
-        }
-    };
-
-    node<std::string> isp
-    {
-        .desc{ "Internet Service Provider" },
-        .cont
-        {
-            {
-                constants::AVAILABLE_HOSTS.at(
-                        constants::AVAILABLE_HOSTS_IDS::IP_API_COM),
-                {
-                    .json_name{ "isp" }
-                }
-            },
-
-            {
-                constants::AVAILABLE_HOSTS.at(
-                        constants::AVAILABLE_HOSTS_IDS::IPWHOIS_APP),
-                {
-                    .json_name{ "isp" }
-                }
-            }
-        }
-    };
-
-    node<std::string> as
-    {
-        .desc{ "Autonomous system" },
-        .cont
-        {
-            {
-                constants::AVAILABLE_HOSTS.at(
-                        constants::AVAILABLE_HOSTS_IDS::IP_API_COM),
-                {
-                    .json_name{ "as" }
-                }
-            },
-
-            {
-                constants::AVAILABLE_HOSTS.at(
-                        constants::AVAILABLE_HOSTS_IDS::IPWHOIS_APP),
-                {
-                    .json_name{ "as" }
-                }
-            }
-        }
-    };
-
-    node<std::string> org
-    {
-        .desc{ "Organization name" },
-        .cont
-        {
-            {
-                constants::AVAILABLE_HOSTS.at(
-                        constants::AVAILABLE_HOSTS_IDS::IP_API_COM),
-                {
-                    .json_name{ "org" }
-                }
-            },
-
-            {
-                constants::AVAILABLE_HOSTS.at(
-                        constants::AVAILABLE_HOSTS_IDS::IPWHOIS_APP),
-                {
-                    .json_name{ "org" }
-                }
-            }
-        }
-    };
-
-    node<std::string> reverse_dns
-    {
-        .desc{ "Reverse DNS of the IP" },
-        .cont
-        {
-            {
-                constants::AVAILABLE_HOSTS.at(
-                        constants::AVAILABLE_HOSTS_IDS::IP_API_COM),
-                {
-                    .json_name{ "reverse" }
-                }
-            },
-
-            {
-                constants::AVAILABLE_HOSTS.at(
-                        constants::AVAILABLE_HOSTS_IDS::IPWHOIS_APP),
-                {
-                    .json_name{}
-                }
-            }
-
-        }
-    };
-
-    node<bool> is_hosting
-    {
-        .desc{ "Hosting, colocated or data center" },
-        .cont
-        {
-            {
-                constants::AVAILABLE_HOSTS.at(
-                        constants::AVAILABLE_HOSTS_IDS::IP_API_COM),
-                {
-                    .json_name{ "hosting" }
-                }
-            },
-
-            {
-                constants::AVAILABLE_HOSTS.at(
-                        constants::AVAILABLE_HOSTS_IDS::IPWHOIS_APP),
-                {
-                    .json_name{}
-                }
-            }
-
-        }
-    };
-
-    node<bool> is_proxy
-    {
-        .desc{ "Proxy, VPN or Tor usage" },
-        .cont
-        {
-            {
-                constants::AVAILABLE_HOSTS.at(
-                        constants::AVAILABLE_HOSTS_IDS::IP_API_COM),
-                {
-                    .json_name{ "proxy" }
-                }
-            },
-
-            {
-                constants::AVAILABLE_HOSTS.at(
-                        constants::AVAILABLE_HOSTS_IDS::IPWHOIS_APP),
-                {
-                    .json_name{}
-                }
-            }
-        }
-    };
-
-    node<bool> is_mobile
-    {
-        .desc{ "Mobile connection usage" },
-        .cont
-        {
-            {
-                constants::AVAILABLE_HOSTS.at(
-                        constants::AVAILABLE_HOSTS_IDS::IP_API_COM),
-                {
-                    .json_name{ "mobile" }
-                }
-            },
-
-            {
-                constants::AVAILABLE_HOSTS.at(
-                        constants::AVAILABLE_HOSTS_IDS::IPWHOIS_APP),
-                {
-                    .json_name{}
-                }
-            }
-
-        }
-    };
-
-    node<std::string> currency
-    {
-        .desc{ "Currency name" },
-        .cont
-        {
-            {
-                constants::AVAILABLE_HOSTS.at(
-                        constants::AVAILABLE_HOSTS_IDS::IP_API_COM),
-                {
-                    .json_name{}
-                }
-            },
+    const std::string host{}, ip{}, lang{}, api_key{};
 
-            {
-                constants::AVAILABLE_HOSTS.at(
-                        constants::AVAILABLE_HOSTS_IDS::IPWHOIS_APP),
-                {
-                    .json_name{ "currency" }
-                }
-            }
-        }
+    // the request is aborted, if it isn't done by the deadline
+    const std::chrono::steady_clock::time_point deadline {
+        std::chrono::steady_clock::time_point::max()
     };
+};
 
-    node<std::string> currency_code
-    {
-        .desc{ "Currency code" },
-        .cont
-        {
-            {
-                constants::AVAILABLE_HOSTS.at(
-                        constants::AVAILABLE_HOSTS_IDS::IP_API_COM),
-                {
-                    .json_name{ "currency" }
-                }
-            },
+struct ipinfo::srv::types::response
+{
+    std::string answ{};
+    usr::types::error error{};
+    std::int32_t status_code{ 0 };
 
-            {
-                constants::AVAILABLE_HOSTS.at(
-                        constants::AVAILABLE_HOSTS_IDS::IPWHOIS_APP),
-                {
-                    .json_name{ "currency_code" }
-                }
-            }
-        }
-    };
+    // A request which isn't sent (the rate limit's wait or the
+    // deadline is over before it) says nothing about the host.
+    bool is_sent{ false };
+};
 
-    node<std::string> currency_symbol
-    {
-        .desc{ "Currency symbol" },
-        .cont
-        {
-            {
-                constants::AVAILABLE_HOSTS.at(
-                        constants::AVAILABLE_HOSTS_IDS::IP_API_COM),
-                {
-                    .json_name{}
-                }
-            },
+struct ipinfo::srv::types::batch_request_attributes
+{
+    const std::string host{}, lang{}, api_key{};
+    const std::vector<std::string> ips{};
+};
 
-            {
-                constants::AVAILABLE_HOSTS.at(
-                        constants::AVAILABLE_HOSTS_IDS::IPWHOIS_APP),
-                {
-                    .json_name{ "currency_symbol" }
-                }
-            }
-        }
-    };
+// Values are stored per host, indexed by 'AVAILABLE_HOSTS_IDS', the
+// local values are the last ones ('LOCAL_SOURCE_ID'). The
+// static metadata (descriptions, JSON names) isn't stored in the info,
+// it's shared by all infos in 'constants::INFO_FIELDS'.
 
-    node<double> currency_rates
+struct ipinfo::srv::types::info
+{
+  private:
+    template<typename T> struct node
     {
-        .desc{ "Currency exchange rate to USD" },
-        .cont
-        {
-            {
-                constants::AVAILABLE_HOSTS.at(
-                        constants::AVAILABLE_HOSTS_IDS::IP_API_COM),
-                {
-                    .json_name{}
-                }
-            },
-
-            {
-                constants::AVAILABLE_HOSTS.at(
-                        constants::AVAILABLE_HOSTS_IDS::IPWHOIS_APP),
-                {
-                    .json_name{ "currency_rates" }
-                }
-            }
-        }
+        std::array<T, constants::INFO_SOURCES_NUM> cont{};
     };
 
-    node<std::string> currency_plural
-    {
-        .desc{ "Currency plural" },
-        .cont
-        {
-            {
-                constants::AVAILABLE_HOSTS.at(
-                        constants::AVAILABLE_HOSTS_IDS::IP_API_COM),
-                {
-                    .json_name{ "currency_plural" }
-                }
-            },
-
-            {
-                constants::AVAILABLE_HOSTS.at(
-                        constants::AVAILABLE_HOSTS_IDS::IPWHOIS_APP),
-                {
-                    .json_name{ "currency_plural" }
-                }
-            }
-        }
-    };
+  public:
+    // A value is valid only if its bit ('INFO_FIELDS_IDS') is set in
+    // the host's mask, thus the info is reset by zeroing the masks.
+    // Values aren't cleared, strings keep their capacity for reuse.
+
+    std::array<std::uint64_t, constants::INFO_SOURCES_NUM> parsed{};
+
+    node<std::string> ip{};
+    node<std::string> ip_type{};
+    node<std::string> continent{};
+    node<std::string> continent_code{};
+    node<std::string> country{};
+    node<std::string> country_code{};
+    node<std::string> country_capital{};
+    node<std::string> country_ph_code{};
+    node<std::string> country_neighbors{};
+    node<std::string> region{};
+    node<std::string> region_code{};
+    node<std::string> city{};
+    node<std::string> city_district{};
+    node<std::string> zip_code{};
+    node<double> latitude{};
+    node<double> longitude{};
+    node<std::string> city_timezone{};
+    node<std::string> timezone{};
+    node<std::int32_t> gmt_offset{};
+    node<std::int32_t> dst_offset{};
+    node<std::string> timezone_gmt{};
+    node<std::string> isp{};
+    node<std::string> as{};
+    node<std::string> org{};
+    node<std::string> reverse_dns{};
+    node<bool> is_hosting{};
+    node<bool> is_proxy{};
+    node<bool> is_mobile{};
+    node<std::string> currency{};
+    node<std::string> currency_code{};
+    node<std::string> currency_symbol{};
+    node<double> currency_rates{};
+    node<std::string> currency_plural{};
+    node<bool> is_reserved{};
+    node<std::string> failure_message{};
 };
 
 #endif // IPINFO_TYPES_HPP
@@ -14,10 +14,6 @@ namespace ipinfo::srv
 
 class ipinfo::srv::utiler
 {
-  private:
-    template<template<typename ...> class T, typename sub_T>
-        void __clear_node(T<sub_T> &node) const;
-
   public:
     double round_val(
         const double value,
@@ -25,6 +21,10 @@ class ipinfo::srv::utiler
 
     void clear_info(ipinfo::srv::types::info &info) const;
     std::string to_lower_case(const std::string &s) const;
+    std::string url_encode(const std::string &s) const;
+
+    // returns 'AVAILABLE_HOSTS_NUM' if the host isn't supported
+    std::uint8_t get_host_id(const std::string &host) const;
 
     bool is_host_supported(const std::string &host) const;
     bool is_host_supported(const std::uint8_t host_id) const;
@@ -35,6 +35,22 @@ class ipinfo::srv::utiler
     bool is_lang_supported(
         const std::string &lang,
         const std::string &host) const;
+
+    // returns false if the IP isn't a valid IPv4 or IPv6 address
+    bool parse_address(
+        const std::string &ip,
+        srv::types::address &addr) const;
+
+    // Bits after the prefix are zeroed. The length is counted
+    // in the address's family, so it's up to 32 for IPv4.
+    void mask_address(
+        srv::types::address &addr,
+        const std::uint8_t prefix_len) const;
+
+    // the network in the CIDR notation, e.g. '1.2.3.0/24'
+    std::string format_network(
+        const srv::types::address &addr,
+        const std::uint8_t prefix_len) const;
 };
 
 #endif // IPINFO_UTILER_HPP
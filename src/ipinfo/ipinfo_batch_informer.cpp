@@ -0,0 +1,270 @@
+#include "../../include/ipinfo/ipinfo_types.hpp"
+#include "../../include/ipinfo/ipinfo_constants.hpp"
+#include "../../include/ipinfo/ipinfo_aliases.hpp"
+
+#include "../../include/ipinfo/ipinfo_batch_informer.hpp"
+#include "../../include/ipinfo/ipinfo_informer.hpp"
+#include "../../include/ipinfo/ipinfo_requester.hpp"
+#include "../../include/ipinfo/ipinfo_parser.hpp"
+#include "../../include/ipinfo/ipinfo_stream_parser.hpp"
+#include "../../include/ipinfo/ipinfo_utiler.hpp"
+#include "../../include/ipinfo/ipinfo_classifier.hpp"
+#include "../../include/ipinfo/ipinfo_database.hpp"
+#include "../../include/ipinfo/ipinfo_breaker.hpp"
+
+#include <algorithm> // std::min
+#include <cstddef>   // std::size_t
+#include <cstdint>   // std::uint8_t
+#include <iterator>  // std::distance, std::next
+#include <memory>    // std::shared_ptr
+#include <string>
+#include <utility>   // std::move
+#include <vector>
+
+ipinfo::usr::batch_informer::batch_informer(
+    const std::vector<std::string> &ips,
+    const std::string &lang) :
+
+    __ips{ ips },
+    __lang{ lang } {}
+
+void
+ipinfo::usr::batch_informer::set_ips(const std::vector<std::string> &ips)
+{
+    __ips = ips;
+}
+
+void
+ipinfo::usr::batch_informer::add_ip(const std::string &ip)
+{
+    __ips.push_back(ip);
+}
+
+void
+ipinfo::usr::batch_informer::set_lang(const std::string &lang)
+{
+    __lang = srv::utiler{}.to_lower_case(lang);
+}
+
+void
+ipinfo::usr::batch_informer::set_lang(const std::uint8_t lang_id)
+{
+    if (srv::utiler{}.is_lang_supported(lang_id))
+    {
+        __lang = constants::AVAILABLE_LANGS.at(lang_id);
+    }
+}
+
+void
+ipinfo::usr::batch_informer::set_api_key(const std::string &key)
+{
+    __api_key = key;
+}
+
+void
+ipinfo::usr::batch_informer::set_parser(const std::uint8_t parser_id)
+{
+    if (constants::PARSERS_IDS::STREAMING >= parser_id)
+    {
+        __parser_id = parser_id;
+    }
+}
+
+void
+ipinfo::usr::batch_informer::set_database(
+    const std::shared_ptr<usr::database> &db,
+    const std::uint8_t mode_id)
+{
+    __database = db;
+    __database_mode = mode_id;
+}
+
+void
+ipinfo::usr::batch_informer::__run_batch(
+    const std::vector<std::string>::const_iterator first,
+    const std::vector<std::string>::const_iterator last)
+{
+    const std::string &host {
+        constants::AVAILABLE_HOSTS.at(constants::AVAILABLE_HOSTS_IDS::IP_API_COM)
+    };
+
+    const als::batch_req_attrs bra {
+        .host{ host },
+        .lang{ __lang },
+        .api_key{ __api_key },
+        .ips{ first, last }
+    };
+
+    // The breaker is asked and told as by single requests, 429 is
+    // the throttling, which isn't a sign of a dead host.
+
+    auto &brkr{ srv::breaker::instance() };
+    srv::types::response resp{};
+
+    if (not brkr.allow(host))
+    {
+        resp.error = {
+            .code{ constants::ERRORS_IDS::UNAVAILABLE_HOST },
+            .desc{ "The host is failing, it's skipped until the cooldown" }
+        };
+    }
+    else
+    {
+        resp = srv::requester{}.request_batch(bra);
+
+        if (not resp.is_sent)
+        {
+            brkr.on_abort(host);
+        }
+        else if (usr::informer::__is_transient(resp) and 429 != resp.status_code)
+        {
+            brkr.on_failure(host);
+        }
+        else
+        {
+            brkr.on_success(host);
+        }
+    }
+
+    std::vector<srv::types::info> infos{};
+    usr::types::error error{ resp.error };
+
+    if (429 == resp.status_code)
+    {
+        error.code = constants::ERRORS_IDS::THROTTLED_REQUEST;
+    }
+
+    if (constants::ERRORS_IDS::NO_ERRORS == error.code)
+    {
+        if (constants::PARSERS_IDS::STREAMING == __parser_id)
+        {
+            srv::stream_parser prsr{};
+
+            prsr.parse_batch(resp.answ, infos, host);
+            error = prsr.get_last_error();
+        }
+        else
+        {
+            srv::parser prsr{};
+
+            prsr.parse_batch(resp.answ, infos, host);
+            error = prsr.get_last_error();
+        }
+    }
+
+    // The answer's array has the same order as the request's one. If
+    // the batch has failed, the informers of its IPs are left empty
+    // and get the batch's error, values of a broken answer are dropped.
+
+    if (constants::ERRORS_IDS::NO_ERRORS != error.code)
+    {
+        __error = error;
+        infos.clear();
+    }
+
+    const auto n{ static_cast<std::size_t>(std::distance(first, last)) };
+    infos.resize(n);
+
+    for (std::size_t i{ 0u }; i < n; i++)
+    {
+        const std::string &ip{ *std::next(first, static_cast<std::ptrdiff_t>(i)) };
+        usr::informer infr{ ip, __lang, infos.at(i) };
+
+        infr.exclude_host(constants::AVAILABLE_HOSTS_IDS::IPWHOIS_APP);
+
+        if (constants::ERRORS_IDS::NO_ERRORS != error.code)
+        {
+            infr.__errors[host] = error;
+        }
+        else
+        {
+            infr.__check_failure(host);
+        }
+
+        __results.push_back(infr);
+    }
+}
+
+void
+ipinfo::usr::batch_informer::run()
+{
+    __results.clear();
+    __results.reserve(__ips.size());
+    __error = {};
+
+    // Reserved IPs and IPs of the database are answered locally, only
+    // the rest is sent. Results are merged back in the order of the IPs.
+    // The database is searched for all IPs at once, in turns.
+
+    std::vector<std::string> remote_ips{};
+    std::vector<usr::informer> local_results{};
+    std::vector<bool> is_local(__ips.size(), false);
+    std::vector<srv::types::info> infos(__ips.size());
+
+    for (std::size_t i{ 0u }; i < __ips.size(); i++)
+    {
+        is_local[i] = srv::classifier{}.classify(__ips[i], infos[i]);
+    }
+
+    if (__database)
+    {
+        __database->__find_batch(__ips, infos, is_local);
+    }
+
+    for (std::size_t i{ 0u }; i < __ips.size(); i++)
+    {
+        usr::informer infr{ __ips[i], __lang, infos[i] };
+        infr.set_database(__database, __database_mode);
+
+        if (not is_local[i] and __database)
+        {
+            is_local[i] = infr.__miss_database();
+        }
+
+        if (is_local[i])
+        {
+            local_results.push_back(std::move(infr));
+        }
+        else
+        {
+            remote_ips.push_back(__ips[i]);
+        }
+    }
+
+    for (std::size_t i{ 0u }; i < remote_ips.size(); i += constants::BATCH_MAX_SIZE)
+    {
+        const std::size_t n{ std::min(constants::BATCH_MAX_SIZE, remote_ips.size() - i) };
+        const auto first{ std::next(remote_ips.cbegin(), static_cast<std::ptrdiff_t>(i)) };
+
+        __run_batch(first, std::next(first, static_cast<std::ptrdiff_t>(n)));
+    }
+
+    if (local_results.empty())
+    {
+        return;
+    }
+
+    std::vector<usr::informer> results{};
+    results.reserve(__ips.size());
+
+    for (std::size_t i{ 0u }, l{ 0u }, r{ 0u }; i < __ips.size(); i++)
+    {
+        results.push_back(std::move(is_local[i] ? local_results[l++] : __results[r++]));
+    }
+
+    __results = std::move(results);
+
+    return;
+}
+
+const std::vector<ipinfo::usr::informer> &
+ipinfo::usr::batch_informer::get_results() const
+{
+    return __results;
+}
+
+ipinfo::usr::types::error
+ipinfo::usr::batch_informer::get_last_error() const
+{
+    return __error;
+}
@@ -0,0 +1,110 @@
+#include "../../include/ipinfo/ipinfo_constants.hpp"
+#include "../../include/ipinfo/ipinfo_breaker.hpp"
+
+#include <chrono>
+#include <cstdint> // std::uint8_t, std::uint32_t
+#include <mutex>   // std::lock_guard
+#include <string>
+
+ipinfo::srv::breaker &
+ipinfo::srv::breaker::instance()
+{
+    static breaker b{};
+    return b;
+}
+
+bool
+ipinfo::srv::breaker::allow(const std::string &host)
+{
+    const std::lock_guard<std::mutex> lock{ __mtx };
+    __circuit &crct{ __circuits[host] };
+
+    switch (crct.state)
+    {
+        case constants::BREAKER_STATES_IDS::OPEN:
+        {
+            if (clock::now() - crct.opened_at < __cooldown)
+            {
+                return false;
+            }
+
+            // The cooldown is over, one probe is let through.
+            crct.state = constants::BREAKER_STATES_IDS::HALF_OPEN;
+            crct.is_probing = true;
+
+            return true;
+        }
+
+        case constants::BREAKER_STATES_IDS::HALF_OPEN:
+        {
+            if (crct.is_probing)
+            {
+                return false;
+            }
+
+            crct.is_probing = true;
+            return true;
+        }
+
+        default:
+        {
+            return true;
+        }
+    }
+}
+
+void
+ipinfo::srv::breaker::on_success(const std::string &host)
+{
+    const std::lock_guard<std::mutex> lock{ __mtx };
+    __circuit &crct{ __circuits[host] };
+
+    crct.state = constants::BREAKER_STATES_IDS::CLOSED;
+    crct.failures = 0u;
+    crct.is_probing = false;
+}
+
+void
+ipinfo::srv::breaker::on_failure(const std::string &host)
+{
+    const std::lock_guard<std::mutex> lock{ __mtx };
+    __circuit &crct{ __circuits[host] };
+
+    crct.failures += 1u;
+    crct.is_probing = false;
+
+    if (constants::BREAKER_STATES_IDS::HALF_OPEN == crct.state or
+        crct.failures >= __threshold)
+    {
+        crct.state = constants::BREAKER_STATES_IDS::OPEN;
+        crct.opened_at = clock::now();
+    }
+}
+
+void
+ipinfo::srv::breaker::on_abort(const std::string &host)
+{
+    const std::lock_guard<std::mutex> lock{ __mtx };
+    __circuits[host].is_probing = false;
+}
+
+std::uint8_t
+ipinfo::srv::breaker::get_state(const std::string &host)
+{
+    const std::lock_guard<std::mutex> lock{ __mtx };
+    return __circuits[host].state;
+}
+
+void
+ipinfo::srv::breaker::set_threshold(const std::uint32_t failures)
+{
+    const std::lock_guard<std::mutex> lock{ __mtx };
+    __threshold = failures;
+}
+
+void
+ipinfo::srv::breaker::set_cooldown(const std::chrono::milliseconds &cooldown)
+{
+    const std::lock_guard<std::mutex> lock{ __mtx };
+    __cooldown = cooldown;
+}
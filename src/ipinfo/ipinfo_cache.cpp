@@ -0,0 +1,897 @@
+#include "../../include/ipinfo/ipinfo_types.hpp"
+#include "../../include/ipinfo/ipinfo_constants.hpp"
+#include "../../include/ipinfo/ipinfo_cache.hpp"
+#include "../../include/ipinfo/ipinfo_fields.hpp"
+#include "../../include/ipinfo/ipinfo_utiler.hpp"
+#include "../../include/ipinfo/ipinfo_store.hpp"
+#include "../../include/ipinfo/ipinfo_informer.hpp"
+#include "../../include/ipinfo/ipinfo_loop.hpp"
+#include "../../include/ipinfo/ipinfo_sketch.hpp"
+#include "../../include/ipinfo/ipinfo_scheduler.hpp"
+#include "../../include/ipinfo/ipinfo_breaker.hpp"
+#include "../../include/ipinfo/ipinfo_tracker.hpp"
+
+#include <algorithm>    // std::min
+#include <atomic>       // std::memory_order_relaxed
+#include <bit>          // std::bit_ceil
+#include <chrono>
+#include <cstddef>      // std::size_t
+#include <cstdint>      // std::uint8_t
+#include <functional>   // std::hash
+#include <iterator>     // std::next, std::prev
+#include <memory>       // std::make_unique, std::shared_ptr
+#include <mutex>        // std::unique_lock, std::lock_guard, std::call_once
+#include <shared_mutex> // std::shared_lock
+#include <string>       // std::string
+#include <string_view>  // std::string_view
+#include <type_traits>  // std::is_same_v
+#include <utility>      // std::move
+
+namespace
+{
+    // a limit of the cache is split between its shards
+    std::size_t get_shard_limit(const std::size_t limit, const std::size_t shards_num)
+    {
+        return (limit / shards_num) + (0u != (limit % shards_num) ? 1u : 0u);
+    }
+}
+
+ipinfo::usr::cache::cache() :
+
+    cache {
+        constants::DEFAULT_CACHE_MAX_ENTRIES,
+        constants::DEFAULT_CACHE_MAX_BYTES,
+        constants::DEFAULT_CACHE_TTL
+    } {}
+
+ipinfo::usr::cache::cache(
+    const std::size_t max_entries,
+    const std::size_t max_bytes,
+    const std::chrono::milliseconds &ttl,
+    const std::size_t shards_num) :
+
+    __shards_num{ std::bit_ceil(0u == shards_num ? std::size_t{ 1u } : shards_num) },
+    __store{ std::make_unique<srv::store>() }
+{
+    // The refresher's loop aborts its transfers through these
+    // singletons when the cache is destroyed. Statics are destroyed
+    // in the reverse order of their creation, so they're created
+    // before the cache, even if it's a static ('instance()') which is
+    // made before the first request, not only before the loop.
+
+    srv::scheduler::instance();
+    srv::breaker::instance();
+    srv::tracker::instance();
+
+    __shards = std::make_unique<__shard[]>(__shards_num);
+
+    __max_entries = get_shard_limit(max_entries, __shards_num);
+    __max_bytes = get_shard_limit(max_bytes, __shards_num);
+    __ttl = std::chrono::duration_cast<clock::duration>(ttl).count();
+    __soft_ttl = std::chrono::duration_cast<clock::duration>(constants::DEFAULT_CACHE_SOFT_TTL).count();
+
+    for (std::size_t i{ 0u }; i < constants::NEGATIVE_CACHE_CLASSES_NUM; i++)
+    {
+        __negative_ttls[i] = std::chrono::duration_cast<clock::duration>(
+            constants::DEFAULT_NEGATIVE_CACHE_TTLS[i]).count();
+    }
+}
+
+ipinfo::usr::cache::~cache() = default;
+
+std::shared_ptr<ipinfo::usr::cache>
+ipinfo::usr::cache::instance()
+{
+    static const std::shared_ptr<usr::cache> inst{ std::make_shared<usr::cache>() };
+    return inst;
+}
+
+void
+ipinfo::usr::cache::__get_key(
+    const std::string &ip,
+    const std::string &lang,
+    const std::uint8_t hosts_mask,
+    std::string &key)
+{
+    // Neither an IP nor a language contains '\0', thus
+    // the IP is always the key's prefix up to the first one.
+
+    key.clear();
+    key.append(ip).push_back('\0');
+    key.append(lang).push_back('\0');
+    key.push_back(static_cast<char>(hosts_mask));
+}
+
+std::size_t
+ipinfo::usr::cache::__get_bytes(const __entry &entry)
+{
+    // It's an estimation: the entry itself, its list and
+    // index nodes (two pointers and the hash on the top of
+    // the entry and the key's view) and strings which are
+    // out of the entry.
+
+    std::size_t bytes {
+        sizeof(__entry) + 6u * sizeof(void *) + entry.key.capacity()
+    };
+
+    srv::for_each_field(entry.info, [&bytes] (const auto &node)
+    {
+        using val_T = typename decltype(node.cont)::value_type;
+
+        if constexpr (std::is_same_v<std::string, val_T>)
+        {
+            for (const std::string &val : node.cont)
+            {
+                bytes += val.capacity();
+            }
+        }
+    });
+
+    for (const auto &[host, err] : entry.errors)
+    {
+        bytes += 4u * sizeof(void *) + sizeof(host) + sizeof(err);
+        bytes += host.capacity() + err.desc.capacity();
+    }
+
+    return bytes;
+}
+
+std::uint8_t
+ipinfo::usr::cache::__get_error_class(const usr::types::error &err)
+{
+    switch (err.code)
+    {
+        case constants::ERRORS_IDS::INVALID_QUERY:
+        {
+            return constants::NEGATIVE_CACHE_CLASSES_IDS::INVALID_INPUT;
+        }
+
+        case constants::ERRORS_IDS::FAILED_LOOKUP:
+        {
+            return constants::NEGATIVE_CACHE_CLASSES_IDS::PROVIDER_FAILURE;
+        }
+
+        case constants::ERRORS_IDS::THROTTLED_REQUEST:
+        {
+            return constants::NEGATIVE_CACHE_CLASSES_IDS::THROTTLED;
+        }
+
+        default:
+        {
+            return constants::NEGATIVE_CACHE_CLASSES_NUM;
+        }
+    }
+}
+
+bool
+ipinfo::usr::cache::__get_network(
+    const std::string &ip,
+    std::string &network) const
+{
+    const srv::utiler utlr{};
+    srv::types::address addr{};
+
+    if (not utlr.parse_address(ip, addr))
+    {
+        return false;
+    }
+
+    const std::uint8_t prefix_len {
+        addr.is_v4 ?
+            __v4_prefix_len.load(std::memory_order_relaxed) :
+            __v6_prefix_len.load(std::memory_order_relaxed)
+    };
+
+    if (0u == prefix_len)
+    {
+        return false;
+    }
+
+    utlr.mask_address(addr, prefix_len);
+    network = utlr.format_network(addr, prefix_len);
+
+    return true;
+}
+
+ipinfo::usr::cache::__shard &
+ipinfo::usr::cache::__get_shard(const std::string &ip) const
+{
+    // All results of an IP are in the same shard,
+    // thus the IP is invalidated by one shard.
+    return __shards[std::hash<std::string>{}(ip) & (__shards_num - 1u)];
+}
+
+void
+ipinfo::usr::cache::__erase(__shard &shard, entry_it it)
+{
+    shard.bytes -= it->bytes;
+    shard.entries_num -= 1u;
+
+    shard.index.erase(it->key);
+    shard.entries.erase(it);
+}
+
+void
+ipinfo::usr::cache::__erase_prefix(__shard &shard, const std::string &prefix)
+{
+    for (auto it{ shard.entries.begin() }; it != shard.entries.end(); )
+    {
+        const auto next{ std::next(it) };
+
+        if (0 == it->key.compare(0u, prefix.size(), prefix))
+        {
+            __erase(shard, it);
+        }
+
+        it = next;
+    }
+}
+
+void
+ipinfo::usr::cache::__shrink(__shard &shard)
+{
+    // The second chance: a referenced entry is moved to the head
+    // and loses its mark, so the loop ends after two passes at most.
+
+    const std::size_t max_entries{ __max_entries.load(std::memory_order_relaxed) };
+    const std::size_t max_bytes{ __max_bytes.load(std::memory_order_relaxed) };
+
+    while (not shard.entries.empty() and
+        (shard.entries_num > max_entries or shard.bytes > max_bytes))
+    {
+        const auto last{ std::prev(shard.entries.end()) };
+
+        if (last->is_referenced.exchange(false, std::memory_order_relaxed))
+        {
+            shard.entries.splice(shard.entries.begin(), shard.entries, last);
+            continue;
+        }
+
+        __erase(shard, last);
+        shard.evictions += 1u;
+    }
+}
+
+bool
+ipinfo::usr::cache::__admit(const __shard &shard, const __entry &entry) const
+{
+    if (not shard.sketch or shard.entries.empty())
+    {
+        return true;
+    }
+
+    const std::size_t max_entries{ __max_entries.load(std::memory_order_relaxed) };
+    const std::size_t max_bytes{ __max_bytes.load(std::memory_order_relaxed) };
+
+    if (shard.entries_num < max_entries and shard.bytes + entry.bytes <= max_bytes)
+    {
+        return true;
+    }
+
+    // the entry which the eviction looks at first
+    const __entry &victim{ shard.entries.back() };
+
+    if (clock::now() >= victim.expires_at)
+    {
+        return true;
+    }
+
+    const std::hash<std::string_view> hash{};
+
+    return shard.sketch->estimate(hash(entry.key)) > shard.sketch->estimate(hash(victim.key));
+}
+
+bool
+ipinfo::usr::cache::__reserve_refresh(const __entry &entry)
+{
+    if (entry.is_refreshing.load(std::memory_order_relaxed))
+    {
+        return false;
+    }
+
+    std::size_t n{ __refreshes_num.load(std::memory_order_relaxed) };
+
+    do
+    {
+        if (__max_refreshes.load(std::memory_order_relaxed) <= n)
+        {
+            return false;
+        }
+    }
+    while (not __refreshes_num.compare_exchange_weak(n, n + 1u, std::memory_order_relaxed));
+
+    // another hit of the entry has taken it first
+    if (entry.is_refreshing.exchange(true, std::memory_order_relaxed))
+    {
+        __refreshes_num.fetch_sub(1u, std::memory_order_relaxed);
+        return false;
+    }
+
+    return true;
+}
+
+bool
+ipinfo::usr::cache::__find_key(
+    __shard &shard,
+    const std::string &key,
+    ipinfo::srv::types::info &info,
+    errors_map &errors,
+    bool &is_stale)
+{
+    {
+        const std::shared_lock<std::shared_mutex> lock{ shard.mtx };
+        const auto it{ shard.index.find(key) };
+        const clock::time_point now{ clock::now() };
+
+        // misses are counted too, so a new key is known when it's inserted
+        if (shard.sketch)
+        {
+            shard.sketch->record(std::hash<std::string_view>{}(key));
+        }
+
+        // An expired entry can't be erased under the shared lock,
+        // it's replaced by the next insertion or evicted.
+
+        if (shard.index.end() != it and now >= it->second->expires_at)
+        {
+            shard.expirations.fetch_add(1u, std::memory_order_relaxed);
+        }
+        else if (shard.index.end() != it)
+        {
+            // the flag is checked before, so the cache line isn't written by every hit
+            if (not it->second->is_referenced.load(std::memory_order_relaxed))
+            {
+                it->second->is_referenced.store(true, std::memory_order_relaxed);
+            }
+
+            srv::copy_parsed(it->second->info, info);
+            errors = it->second->errors;
+
+            if (now >= it->second->refresh_at and __reserve_refresh(*it->second))
+            {
+                shard.refreshes.fetch_add(1u, std::memory_order_relaxed);
+                is_stale = true;
+            }
+
+            return true;
+        }
+    }
+
+    srv::store::clock::time_point expires_at{};
+
+    // only lookups without errors are in the file, a cache
+    // without the file doesn't take the store's lock on a miss
+    if (not __store->is_open() or not __store->find(key, info, expires_at))
+    {
+        return false;
+    }
+
+    // the result keeps the expiration time it has in the file
+    const auto ttl{ expires_at - srv::store::clock::now() };
+
+    errors.clear();
+    __insert_key(shard, key, info, errors, std::chrono::duration_cast<clock::duration>(ttl));
+    shard.file_hits.fetch_add(1u, std::memory_order_relaxed);
+
+    return true;
+}
+
+bool
+ipinfo::usr::cache::__find(
+    const std::string &ip,
+    const std::string &lang,
+    const std::uint8_t hosts_mask,
+    ipinfo::srv::types::info &info,
+    errors_map &errors,
+    bool &is_stale)
+{
+    // buffers are reused, so a lookup doesn't allocate
+    thread_local std::string key{};
+    thread_local std::string network{};
+
+    __shard &shard{ __get_shard(ip) };
+    __get_key(ip, lang, hosts_mask, key);
+
+    is_stale = false;
+
+    if (__find_key(shard, key, info, errors, is_stale))
+    {
+        if (not errors.empty())
+        {
+            shard.negative_hits.fetch_add(1u, std::memory_order_relaxed);
+        }
+
+        shard.hits.fetch_add(1u, std::memory_order_relaxed);
+        return true;
+    }
+
+    if (__get_network(ip, network))
+    {
+        __get_key(network, lang, hosts_mask, key);
+
+        if (__find_key(__get_shard(network), key, info, errors, is_stale))
+        {
+            // the neighbour's address fields are replaced by the IP's ones
+            for (std::size_t i{ 0u }; i < constants::INFO_SOURCES_NUM; i++)
+            {
+                if (srv::is_parsed(info, i, constants::INFO_FIELDS_IDS::IP))
+                {
+                    info.ip.cont[i] = ip;
+                }
+
+                srv::set_parsed(info, i, constants::INFO_FIELDS_IDS::REVERSE_DNS, false);
+            }
+
+            shard.hits.fetch_add(1u, std::memory_order_relaxed);
+            shard.range_hits.fetch_add(1u, std::memory_order_relaxed);
+
+            return true;
+        }
+    }
+
+    shard.misses.fetch_add(1u, std::memory_order_relaxed);
+    return false;
+}
+
+void
+ipinfo::usr::cache::__insert_key(
+    __shard &shard,
+    const std::string &key,
+    const ipinfo::srv::types::info &info,
+    const errors_map &errors,
+    const clock::duration &ttl)
+{
+    std::list<__entry> node{};
+
+    // the entry is built outside of the lock and then spliced
+    __entry &entry{ node.emplace_back() };
+
+    entry.key = key;
+    srv::copy_parsed(info, entry.info);
+    entry.errors = errors;
+
+    entry.expires_at = clock::now() + ttl;
+    entry.refresh_at = entry.expires_at;
+
+    // The soft TTL is counted back from the expiration, thus a result
+    // of the file, which has less time left, is stale as early.
+
+    const clock::duration stale_for {
+        __ttl.load(std::memory_order_relaxed) - __soft_ttl.load(std::memory_order_relaxed)
+    };
+
+    if (errors.empty() and clock::duration::zero() < stale_for)
+    {
+        entry.refresh_at -= stale_for;
+    }
+
+    entry.bytes = __get_bytes(entry);
+
+    const std::unique_lock<std::shared_mutex> lock{ shard.mtx };
+    const auto it{ shard.index.find(entry.key) };
+
+    if (shard.index.end() != it)
+    {
+        __erase(shard, it->second);
+    }
+    else if (not __admit(shard, entry))
+    {
+        shard.rejections += 1u;
+        return;
+    }
+
+    shard.bytes += entry.bytes;
+    shard.entries_num += 1u;
+
+    shard.entries.splice(shard.entries.begin(), node);
+    shard.index.emplace(shard.entries.front().key, shard.entries.begin());
+
+    __shrink(shard);
+}
+
+void
+ipinfo::usr::cache::__insert(
+    const std::string &ip,
+    const std::string &lang,
+    const std::uint8_t hosts_mask,
+    const ipinfo::srv::types::info &info,
+    const errors_map &errors)
+{
+    std::string key{};
+    std::string network{};
+
+    __get_key(ip, lang, hosts_mask, key);
+
+    // A failed lookup has the shortest TTL of its errors' classes. It
+    // belongs to the IP only, so it's neither shared by the IP's
+    // network nor written to the file.
+
+    if (not errors.empty())
+    {
+        clock::duration ttl{ clock::duration::max() };
+
+        for (const auto &[host, err] : errors)
+        {
+            const std::uint8_t class_id{ __get_error_class(err) };
+
+            if (constants::NEGATIVE_CACHE_CLASSES_NUM == class_id)
+            {
+                return;
+            }
+
+            ttl = std::min(ttl, clock::duration {
+                __negative_ttls[class_id].load(std::memory_order_relaxed)
+            });
+        }
+
+        if (clock::duration::zero() < ttl)
+        {
+            __insert_key(__get_shard(ip), key, info, errors, ttl);
+        }
+
+        return;
+    }
+
+    const clock::duration ttl{ __ttl.load(std::memory_order_relaxed) };
+    const auto file_expires_at{ srv::store::clock::now() + ttl };
+
+    __insert_key(__get_shard(ip), key, info, errors, ttl);
+    __store->insert(key, info, file_expires_at);
+
+    if (__get_network(ip, network))
+    {
+        __get_key(network, lang, hosts_mask, key);
+        __insert_key(__get_shard(network), key, info, errors, ttl);
+        __store->insert(key, info, file_expires_at);
+    }
+}
+
+void
+ipinfo::usr::cache::__refresh(
+    const usr::informer &infr,
+    const std::uint8_t hosts_mask)
+{
+    std::call_once(__refresher_once, [this] ()
+    {
+        __refresher = std::make_unique<srv::loop>(constants::DEFAULT_CACHE_MAX_REFRESHES);
+    });
+
+    // the refresh doesn't look the cache up, the stale result is there
+    usr::informer refresh{ infr };
+    refresh.__cache.reset();
+
+    const auto deadline{ std::chrono::steady_clock::now() + constants::CACHE_REFRESH_TIMEOUT };
+
+    __refresher->submit(refresh, deadline, [this, hosts_mask] (usr::informer &&done)
+    {
+        // A failed refresh keeps the stale result until it's expired,
+        // the entry stays marked, so it isn't refreshed once again.
+
+        if (done.__errors.empty())
+        {
+            __insert(done.__ip, done.__lang, hosts_mask, done.__info, done.__errors);
+        }
+
+        __refreshes_num.fetch_sub(1u, std::memory_order_relaxed);
+    });
+}
+
+ipinfo::usr::cache::flight_ptr
+ipinfo::usr::cache::__join(
+    const std::string &ip,
+    const std::string &lang,
+    const std::uint8_t hosts_mask,
+    bool &is_leader)
+{
+    std::string key{};
+    __get_key(ip, lang, hosts_mask, key);
+
+    __shard &shard{ __get_shard(ip) };
+    const std::lock_guard<std::mutex> lock{ shard.flights_mtx };
+
+    const auto [it, is_new]{ shard.flights.try_emplace(std::move(key)) };
+
+    if (is_new)
+    {
+        it->second = std::make_shared<__flight>();
+    }
+    else
+    {
+        shard.coalesced.fetch_add(1u, std::memory_order_relaxed);
+    }
+
+    is_leader = is_new;
+    return it->second;
+}
+
+void
+ipinfo::usr::cache::__land(
+    const std::string &ip,
+    const std::string &lang,
+    const std::uint8_t hosts_mask,
+    const flight_ptr &flight,
+    const ipinfo::srv::types::info &info,
+    const errors_map &errors)
+{
+    // The result is inserted before the flight is removed, so a lookup
+    // which doesn't find the flight finds the result (if it's cached).
+
+    __insert(ip, lang, hosts_mask, info, errors);
+
+    if (not flight)
+    {
+        return;
+    }
+
+    __remove_flight(ip, lang, hosts_mask, flight);
+
+    // nobody can join the flight after it's removed,
+    // thus the leader's pointer is the only one if there are no waiters
+    if (1 == flight.use_count())
+    {
+        return;
+    }
+
+    {
+        const std::lock_guard<std::mutex> lock{ flight->mtx };
+
+        srv::copy_parsed(info, flight->info);
+        flight->errors = errors;
+        flight->is_landed = true;
+    }
+
+    flight->cv.notify_all();
+}
+
+void
+ipinfo::usr::cache::__abandon(
+    const std::string &ip,
+    const std::string &lang,
+    const std::uint8_t hosts_mask,
+    const flight_ptr &flight)
+{
+    if (not flight)
+    {
+        return;
+    }
+
+    __remove_flight(ip, lang, hosts_mask, flight);
+
+    {
+        const std::lock_guard<std::mutex> lock{ flight->mtx };
+
+        flight->is_landed = true;
+        flight->is_abandoned = true;
+    }
+
+    flight->cv.notify_all();
+}
+
+void
+ipinfo::usr::cache::__remove_flight(
+    const std::string &ip,
+    const std::string &lang,
+    const std::uint8_t hosts_mask,
+    const flight_ptr &flight)
+{
+    std::string key{};
+    __get_key(ip, lang, hosts_mask, key);
+
+    __shard &shard{ __get_shard(ip) };
+    const std::lock_guard<std::mutex> lock{ shard.flights_mtx };
+
+    const auto it{ shard.flights.find(key) };
+
+    if (shard.flights.end() != it and flight == it->second)
+    {
+        shard.flights.erase(it);
+    }
+}
+
+bool
+ipinfo::usr::cache::__wait(
+    __flight &flight,
+    const clock::time_point &deadline,
+    ipinfo::srv::types::info &info,
+    errors_map &errors)
+{
+    std::unique_lock<std::mutex> lock{ flight.mtx };
+    const auto is_landed{ [&flight] () { return flight.is_landed; } };
+
+    if (clock::time_point::max() == deadline)
+    {
+        flight.cv.wait(lock, is_landed);
+    }
+    else if (not flight.cv.wait_until(lock, deadline, is_landed))
+    {
+        return false;
+    }
+
+    if (flight.is_abandoned)
+    {
+        return false;
+    }
+
+    srv::copy_parsed(flight.info, info);
+    errors = flight.errors;
+
+    return true;
+}
+
+void
+ipinfo::usr::cache::set_max_entries(const std::size_t n)
+{
+    __max_entries = get_shard_limit(n, __shards_num);
+
+    for (std::size_t i{ 0u }; i < __shards_num; i++)
+    {
+        const std::unique_lock<std::shared_mutex> lock{ __shards[i].mtx };
+        __shrink(__shards[i]);
+
+        if (__shards[i].sketch)
+        {
+            __shards[i].sketch->resize(__max_entries);
+        }
+    }
+}
+
+void
+ipinfo::usr::cache::set_max_bytes(const std::size_t n)
+{
+    __max_bytes = get_shard_limit(n, __shards_num);
+
+    for (std::size_t i{ 0u }; i < __shards_num; i++)
+    {
+        const std::unique_lock<std::shared_mutex> lock{ __shards[i].mtx };
+        __shrink(__shards[i]);
+    }
+}
+
+void
+ipinfo::usr::cache::set_ttl(const std::chrono::milliseconds &ttl)
+{
+    __ttl = std::chrono::duration_cast<clock::duration>(ttl).count();
+}
+
+void
+ipinfo::usr::cache::set_soft_ttl(const std::chrono::milliseconds &ttl)
+{
+    __soft_ttl = std::chrono::duration_cast<clock::duration>(ttl).count();
+}
+
+void
+ipinfo::usr::cache::set_max_refreshes(const std::size_t n)
+{
+    __max_refreshes = n;
+}
+
+void
+ipinfo::usr::cache::set_admission(const std::uint8_t admission_id)
+{
+    for (std::size_t i{ 0u }; i < __shards_num; i++)
+    {
+        const std::unique_lock<std::shared_mutex> lock{ __shards[i].mtx };
+
+        if (constants::CACHE_ADMISSIONS_IDS::TINY_LFU == admission_id)
+        {
+            __shards[i].sketch = std::make_unique<srv::sketch>(__max_entries);
+        }
+        else
+        {
+            __shards[i].sketch.reset();
+        }
+    }
+}
+
+void
+ipinfo::usr::cache::set_negative_ttl(
+    const std::uint8_t class_id,
+    const std::chrono::milliseconds &ttl)
+{
+    if (constants::NEGATIVE_CACHE_CLASSES_NUM > class_id)
+    {
+        __negative_ttls[class_id] = std::chrono::duration_cast<clock::duration>(ttl).count();
+    }
+}
+
+void
+ipinfo::usr::cache::set_range_prefixes(
+    const std::uint8_t v4_prefix_len,
+    const std::uint8_t v6_prefix_len)
+{
+    __v4_prefix_len = std::min<std::uint8_t>(v4_prefix_len, 32u);
+    __v6_prefix_len = std::min<std::uint8_t>(v6_prefix_len, 128u);
+}
+
+bool
+ipinfo::usr::cache::open_file(const std::string &path)
+{
+    return __store->open(path);
+}
+
+void
+ipinfo::usr::cache::close_file()
+{
+    __store->close();
+}
+
+bool
+ipinfo::usr::cache::compact_file()
+{
+    return __store->compact();
+}
+
+ipinfo::usr::types::error
+ipinfo::usr::cache::get_last_error() const
+{
+    return __store->get_last_error();
+}
+
+void
+ipinfo::usr::cache::invalidate(const std::string &ip)
+{
+    std::string network{};
+
+    {
+        __shard &shard{ __get_shard(ip) };
+        const std::unique_lock<std::shared_mutex> lock{ shard.mtx };
+
+        __erase_prefix(shard, ip + '\0');
+    }
+
+    __store->erase_prefix(ip + '\0');
+
+    if (__get_network(ip, network))
+    {
+        __shard &shard{ __get_shard(network) };
+        const std::unique_lock<std::shared_mutex> lock{ shard.mtx };
+
+        __erase_prefix(shard, network + '\0');
+        __store->erase_prefix(network + '\0');
+    }
+}
+
+void
+ipinfo::usr::cache::clear()
+{
+    for (std::size_t i{ 0u }; i < __shards_num; i++)
+    {
+        __shard &shard{ __shards[i] };
+        const std::unique_lock<std::shared_mutex> lock{ shard.mtx };
+
+        shard.index.clear();
+        shard.entries.clear();
+
+        shard.entries_num = 0u;
+        shard.bytes = 0u;
+    }
+
+    __store->clear();
+}
+
+ipinfo::usr::types::cache_stats
+ipinfo::usr::cache::get_stats() const
+{
+    usr::types::cache_stats stats{};
+
+    for (std::size_t i{ 0u }; i < __shards_num; i++)
+    {
+        const __shard &shard{ __shards[i] };
+        const std::shared_lock<std::shared_mutex> lock{ shard.mtx };
+
+        stats.hits += shard.hits.load(std::memory_order_relaxed);
+        stats.misses += shard.misses.load(std::memory_order_relaxed);
+        stats.expirations += shard.expirations.load(std::memory_order_relaxed);
+        stats.range_hits += shard.range_hits.load(std::memory_order_relaxed);
+        stats.file_hits += shard.file_hits.load(std::memory_order_relaxed);
+        stats.negative_hits += shard.negative_hits.load(std::memory_order_relaxed);
+        stats.coalesced += shard.coalesced.load(std::memory_order_relaxed);
+        stats.refreshes += shard.refreshes.load(std::memory_order_relaxed);
+        stats.evictions += shard.evictions;
+        stats.rejections += shard.rejections;
+        stats.entries += shard.entries_num;
+        stats.bytes += shard.bytes;
+    }
+
+    return stats;
+}
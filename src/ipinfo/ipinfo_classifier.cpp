@@ -0,0 +1,150 @@
+#include "../../include/ipinfo/ipinfo_types.hpp"
+#include "../../include/ipinfo/ipinfo_constants.hpp"
+#include "../../include/ipinfo/ipinfo_classifier.hpp"
+#include "../../include/ipinfo/ipinfo_fields.hpp"
+#include "../../include/ipinfo/ipinfo_trie.hpp"
+#include "../../include/ipinfo/ipinfo_utiler.hpp"
+
+#include <array>   // std::array
+#include <cstddef> // std::size_t
+#include <cstdint> // std::uint8_t, std::uint16_t, std::uint64_t
+#include <string>  // std::string
+#include <vector>  // std::vector
+
+namespace
+{
+    // An address is two 64-bit halves, IPv4 ranges are mapped
+    // to '::ffff:0:0/96' just like addresses are.
+
+    struct range
+    {
+        std::uint64_t hi{ 0u };
+        std::uint64_t lo{ 0u };
+        std::uint8_t prefix_len{ 0u };
+    };
+
+    constexpr range v4(
+        const std::uint8_t a,
+        const std::uint8_t b,
+        const std::uint8_t c,
+        const std::uint8_t d,
+        const std::uint8_t prefix_len)
+    {
+        return {
+            .hi{ 0u },
+            .lo {
+                (std::uint64_t{ 0xFFFFu } << 32u) |
+                (std::uint64_t{ a } << 24u) | (std::uint64_t{ b } << 16u) |
+                (std::uint64_t{ c } << 8u) | std::uint64_t{ d }
+            },
+            .prefix_len{ static_cast<std::uint8_t>(96u + prefix_len) }
+        };
+    }
+
+    constexpr range v6(
+        const std::uint16_t h0,
+        const std::uint16_t h1,
+        const std::uint16_t h2,
+        const std::uint16_t h3,
+        const std::uint64_t lo,
+        const std::uint8_t prefix_len)
+    {
+        return {
+            .hi {
+                (std::uint64_t{ h0 } << 48u) | (std::uint64_t{ h1 } << 32u) |
+                (std::uint64_t{ h2 } << 16u) | std::uint64_t{ h3 }
+            },
+            .lo{ lo },
+            .prefix_len{ prefix_len }
+        };
+    }
+
+    // Ranges which aren't globally reachable, multicast ones and
+    // ranges for documentation and benchmarking.
+
+    constexpr std::array RESERVED_RANGES
+    {
+        v4(0u, 0u, 0u, 0u, 8u),          // "this network"
+        v4(10u, 0u, 0u, 0u, 8u),         // private use
+        v4(100u, 64u, 0u, 0u, 10u),      // shared address space (CGNAT)
+        v4(127u, 0u, 0u, 0u, 8u),        // loopback
+        v4(169u, 254u, 0u, 0u, 16u),     // link local
+        v4(172u, 16u, 0u, 0u, 12u),      // private use
+        v4(192u, 0u, 0u, 0u, 24u),       // IETF protocol assignments
+        v4(192u, 0u, 2u, 0u, 24u),       // documentation (TEST-NET-1)
+        v4(192u, 88u, 99u, 0u, 24u),     // deprecated 6to4 relay anycast
+        v4(192u, 168u, 0u, 0u, 16u),     // private use
+        v4(198u, 18u, 0u, 0u, 15u),      // benchmarking
+        v4(198u, 51u, 100u, 0u, 24u),    // documentation (TEST-NET-2)
+        v4(203u, 0u, 113u, 0u, 24u),     // documentation (TEST-NET-3)
+        v4(224u, 0u, 0u, 0u, 4u),        // multicast
+        v4(240u, 0u, 0u, 0u, 4u),        // reserved and limited broadcast
+
+        v6(0x0000u, 0u, 0u, 0u, 0u, 128u),      // unspecified
+        v6(0x0000u, 0u, 0u, 0u, 1u, 128u),      // loopback
+        v6(0x0064u, 0xFF9Bu, 1u, 0u, 0u, 48u),  // local-use IPv4/IPv6 translation
+        v6(0x0100u, 0u, 0u, 0u, 0u, 64u),       // discard only
+        v6(0x2001u, 0x0002u, 0u, 0u, 0u, 48u),  // benchmarking
+        v6(0x2001u, 0x0010u, 0u, 0u, 0u, 28u),  // deprecated ORCHID
+        v6(0x2001u, 0x0DB8u, 0u, 0u, 0u, 32u),  // documentation
+        v6(0x3FFFu, 0u, 0u, 0u, 0u, 20u),       // documentation
+        v6(0x5F00u, 0u, 0u, 0u, 0u, 16u),       // segment routing (SRv6) SIDs
+        v6(0xFC00u, 0u, 0u, 0u, 0u, 7u),        // unique local
+        v6(0xFE80u, 0u, 0u, 0u, 0u, 10u),       // link local
+        v6(0xFEC0u, 0u, 0u, 0u, 0u, 10u),       // deprecated site local
+        v6(0xFF00u, 0u, 0u, 0u, 0u, 8u)         // multicast
+    };
+
+    // the ranges are looked up by a trie, it's built at the first use
+    const ipinfo::srv::trie &get_reserved_trie()
+    {
+        static const ipinfo::srv::trie reserved_trie{ []
+        {
+            std::vector<ipinfo::srv::trie::prefix> prefixes{};
+
+            for (const range &rng : RESERVED_RANGES)
+            {
+                prefixes.push_back({
+                    .hi{ rng.hi },
+                    .lo{ rng.lo },
+                    .len{ rng.prefix_len },
+                    .value{ 1u }
+                });
+            }
+
+            return prefixes;
+        }() };
+
+        return reserved_trie;
+    }
+}
+
+bool
+ipinfo::srv::classifier::is_reserved(const ipinfo::srv::types::address &addr) const
+{
+    return srv::trie::NO_VALUE != get_reserved_trie().find(addr);
+}
+
+bool
+ipinfo::srv::classifier::classify(
+    const std::string &ip,
+    ipinfo::srv::types::info &info) const
+{
+    const std::size_t id{ constants::LOCAL_SOURCE_ID };
+    srv::types::address addr{};
+
+    if (not srv::utiler{}.parse_address(ip, addr) or not is_reserved(addr))
+    {
+        return false;
+    }
+
+    info.ip.cont[id] = ip;
+    info.ip_type.cont[id] = addr.is_v4 ? "IPv4" : "IPv6";
+    info.is_reserved.cont[id] = true;
+
+    srv::set_parsed(info, id, constants::INFO_FIELDS_IDS::IP, true);
+    srv::set_parsed(info, id, constants::INFO_FIELDS_IDS::IP_TYPE, true);
+    srv::set_parsed(info, id, constants::INFO_FIELDS_IDS::IS_RESERVED, true);
+
+    return true;
+}
@@ -0,0 +1,498 @@
+#include "../../include/ipinfo/ipinfo_types.hpp"
+#include "../../include/ipinfo/ipinfo_constants.hpp"
+#include "../../include/ipinfo/ipinfo_database.hpp"
+#include "../../include/ipinfo/ipinfo_fields.hpp"
+#include "../../include/ipinfo/ipinfo_utiler.hpp"
+
+#include <algorithm>   // std::upper_bound, std::min
+#include <array>       // std::array
+#include <cstddef>     // std::size_t
+#include <cstdint>     // std::uint32_t, std::uint64_t
+#include <cstring>     // std::memcpy, std::memcmp
+#include <string>      // std::string
+#include <string_view> // std::string_view
+#include <type_traits> // std::is_same_v, std::is_trivially_copyable_v
+#include <vector>      // std::vector
+
+#include <fcntl.h>    // open
+#include <sys/mman.h> // mmap, munmap, madvise
+#include <sys/stat.h> // fstat
+#include <unistd.h>   // close
+
+namespace
+{
+    // the section is inside the file and its items are aligned
+    bool is_section(
+        const std::size_t file_size,
+        const std::uint64_t offset,
+        const std::uint64_t items_num,
+        const std::size_t item_size,
+        const std::size_t item_align)
+    {
+        return 0u == offset % item_align and
+            offset <= file_size and
+            items_num <= (file_size - offset) / item_size;
+    }
+}
+
+ipinfo::usr::database::~database()
+{
+    close();
+}
+
+ipinfo::usr::database::__key
+ipinfo::usr::database::__get_key(const ipinfo::srv::types::address &addr)
+{
+    __key key{};
+
+    for (std::size_t i{ 0u }; i < 8u; i++)
+    {
+        key.hi = (key.hi << 8u) | addr.bytes[i];
+        key.lo = (key.lo << 8u) | addr.bytes[8u + i];
+    }
+
+    return key;
+}
+
+bool
+ipinfo::usr::database::__is_less(const __key &a, const __key &b)
+{
+    return a.hi < b.hi or (a.hi == b.hi and a.lo < b.lo);
+}
+
+bool
+ipinfo::usr::database::__fail(
+    const std::uint8_t code,
+    const std::string &desc)
+{
+    __error = {
+        .code{ code },
+        .desc{ desc }
+    };
+
+    return false;
+}
+
+bool
+ipinfo::usr::database::__check_layout()
+{
+    if (0 != std::memcmp(__hdr.magic, __MAGIC, sizeof(__MAGIC)))
+    {
+        return __fail(constants::ERRORS_IDS::CORRUPTED_FILE, "The file isn't a database");
+    }
+
+    if (__VERSION != __hdr.version)
+    {
+        return __fail(constants::ERRORS_IDS::CORRUPTED_FILE, "Unsupported version of the database");
+    }
+
+    if (not is_section(__size, __hdr.starts_offset, __hdr.ranges_num, sizeof(__key), alignof(__key)) or
+        not is_section(__size, __hdr.ends_offset, __hdr.ranges_num, sizeof(__end), alignof(__end)) or
+        not is_section(__size, __hdr.records_offset, __hdr.records_size, 1u, 1u))
+    {
+        return __fail(constants::ERRORS_IDS::CORRUPTED_FILE, "Sections are out of the file");
+    }
+
+    // the mapping is aligned to a page, so are the sections' items
+    __starts = reinterpret_cast<const __key *>(__data + __hdr.starts_offset);
+    __ends = reinterpret_cast<const __end *>(__data + __hdr.ends_offset);
+
+    __records = {
+        __data + __hdr.records_offset,
+        static_cast<std::size_t>(__hdr.records_size)
+    };
+
+    __index.reserve(static_cast<std::size_t>(__hdr.ranges_num) / __INDEX_STRIDE + 1u);
+
+    for (std::size_t i{ 0u }; i < __hdr.ranges_num; i += __INDEX_STRIDE)
+    {
+        __index.push_back(__starts[i]);
+    }
+
+    return true;
+}
+
+bool
+ipinfo::usr::database::__read_record(
+    const std::uint64_t offset,
+    ipinfo::srv::types::info &info) const
+{
+    std::uint32_t size{ 0u };
+    std::uint64_t mask{ 0u };
+
+    if (__records.size() < sizeof(size) or __records.size() - sizeof(size) < offset)
+    {
+        return false;
+    }
+
+    std::string_view data{ __records.substr(static_cast<std::size_t>(offset)) };
+
+    std::memcpy(&size, data.data(), sizeof(size));
+    data.remove_prefix(sizeof(size));
+
+    if (data.size() < size or size < sizeof(mask))
+    {
+        return false;
+    }
+
+    data = data.substr(0u, size);
+
+    std::memcpy(&mask, data.data(), sizeof(mask));
+    data.remove_prefix(sizeof(mask));
+
+    bool is_read{ true };
+
+    for (std::uint8_t id{ 0u }; id < constants::INFO_FIELDS_NUM and is_read; id++)
+    {
+        if (0u == ((mask >> id) & 1u))
+        {
+            continue;
+        }
+
+        srv::visit_field(info, id, [&] (auto &node)
+        {
+            using val_T = typename std::remove_cvref_t<decltype(node.cont)>::value_type;
+            val_T &val{ node.cont[constants::LOCAL_SOURCE_ID] };
+
+            if constexpr (std::is_same_v<std::string, val_T>)
+            {
+                std::uint32_t len{ 0u };
+
+                if (data.size() < sizeof(len))
+                {
+                    is_read = false;
+                    return;
+                }
+
+                std::memcpy(&len, data.data(), sizeof(len));
+                data.remove_prefix(sizeof(len));
+
+                if (data.size() < len)
+                {
+                    is_read = false;
+                    return;
+                }
+
+                val.assign(data.data(), len);
+                data.remove_prefix(len);
+            }
+            else if constexpr (std::is_same_v<bool, val_T>)
+            {
+                if (data.empty())
+                {
+                    is_read = false;
+                    return;
+                }
+
+                // a byte of a broken file mustn't make an invalid bool
+                val = (0u != static_cast<std::uint8_t>(data.front()));
+                data.remove_prefix(1u);
+            }
+            else
+            {
+                static_assert(std::is_trivially_copyable_v<val_T>);
+
+                if (data.size() < sizeof(val_T))
+                {
+                    is_read = false;
+                    return;
+                }
+
+                std::memcpy(&val, data.data(), sizeof(val_T));
+                data.remove_prefix(sizeof(val_T));
+            }
+        });
+
+        srv::set_parsed(info, constants::LOCAL_SOURCE_ID, id, is_read);
+    }
+
+    return is_read;
+}
+
+bool
+ipinfo::usr::database::__find_block(
+    const __key &key,
+    std::size_t &first,
+    std::size_t &last) const
+{
+    // the block of starts is found by the index, it's in the cache
+    const auto block{ std::upper_bound(__index.cbegin(), __index.cend(), key, __is_less) };
+
+    if (__index.cbegin() == block)
+    {
+        return false;
+    }
+
+    first = static_cast<std::size_t>(block - __index.cbegin() - 1) * __INDEX_STRIDE;
+    last = std::min(first + __INDEX_STRIDE, static_cast<std::size_t>(__hdr.ranges_num));
+
+    return true;
+}
+
+bool
+ipinfo::usr::database::__read_range(
+    const std::size_t range_id,
+    const __key &key,
+    const std::string &ip,
+    ipinfo::srv::types::info &info) const
+{
+    if (__is_less(__ends[range_id].last, key))
+    {
+        return false;
+    }
+
+    if (not __read_record(__ends[range_id].record, info))
+    {
+        info.parsed[constants::LOCAL_SOURCE_ID] = 0u;
+        return false;
+    }
+
+    info.ip.cont[constants::LOCAL_SOURCE_ID] = ip;
+    srv::set_parsed(info, constants::LOCAL_SOURCE_ID, constants::INFO_FIELDS_IDS::IP, true);
+
+    return true;
+}
+
+bool
+ipinfo::usr::database::__find(
+    const std::string &ip,
+    ipinfo::srv::types::info &info) const
+{
+    srv::types::address addr{};
+
+    if (nullptr == __data or 0u == __hdr.ranges_num or
+        not srv::utiler{}.parse_address(ip, addr))
+    {
+        return false;
+    }
+
+    const __key key{ __get_key(addr) };
+    std::size_t first{ 0u }, last{ 0u };
+
+    if (not __find_block(key, first, last))
+    {
+        return false;
+    }
+
+    // the last range which starts before the IP or at it, the
+    // block's first start isn't after the IP, so there is one
+    const __key * const it{ std::upper_bound(__starts + first, __starts + last, key, __is_less) };
+
+    return __read_range(static_cast<std::size_t>(it - __starts) - 1u, key, ip, info);
+}
+
+void
+ipinfo::usr::database::__find_batch(
+    const std::vector<std::string> &ips,
+    std::vector<ipinfo::srv::types::info> &infos,
+    std::vector<bool> &is_found) const
+{
+    if (nullptr == __data or 0u == __hdr.ranges_num)
+    {
+        return;
+    }
+
+    // A search keeps the last key which isn't after the IP's one in
+    // [base, base + n), a step halves the span by one comparison. The
+    // index is searched in turns too, it's larger than the L1 cache.
+
+    struct search
+    {
+        std::size_t ip_id{ 0u };
+        __key key{};
+        std::size_t base{ 0u };
+        std::size_t n{ 0u };
+    };
+
+    std::array<search, __GROUP_SIZE> group{};
+    std::size_t group_size{ 0u };
+
+    const auto search_in_turns{ [&] (const __key * const keys)
+    {
+        for (std::size_t k{ 0u }; k < group_size; k++)
+        {
+            __builtin_prefetch(keys + group[k].base + group[k].n / 2u);
+        }
+
+        for (bool is_searching{ true }; is_searching; )
+        {
+            is_searching = false;
+
+            for (std::size_t k{ 0u }; k < group_size; k++)
+            {
+                search &srch{ group[k] };
+
+                if (1u >= srch.n)
+                {
+                    continue;
+                }
+
+                // without a branch, the comparison is unpredictable
+                const std::size_t half{ srch.n / 2u };
+                srch.base += __is_less(srch.key, keys[srch.base + half]) ? 0u : half;
+                srch.n -= half;
+
+                __builtin_prefetch(keys + srch.base + srch.n / 2u);
+                is_searching = is_searching or 1u < srch.n;
+            }
+        }
+    } };
+
+    const srv::utiler utlr{};
+
+    for (std::size_t i{ 0u }; i < ips.size(); )
+    {
+        group_size = 0u;
+
+        for (; i < ips.size() and group_size < __GROUP_SIZE; i++)
+        {
+            srv::types::address addr{};
+            search &srch{ group[group_size] };
+
+            if (is_found[i] or not utlr.parse_address(ips[i], addr))
+            {
+                continue;
+            }
+
+            srch = {
+                .ip_id{ i },
+                .key{ __get_key(addr) },
+                .base{ 0u },
+                .n{ __index.size() }
+            };
+
+            // an IP before the first range is in no range
+            if (not __is_less(srch.key, __index.front()))
+            {
+                group_size++;
+            }
+        }
+
+        search_in_turns(__index.data());
+
+        for (std::size_t k{ 0u }; k < group_size; k++)
+        {
+            search &srch{ group[k] };
+
+            srch.base *= __INDEX_STRIDE;
+            srch.n = std::min(__INDEX_STRIDE, static_cast<std::size_t>(__hdr.ranges_num) - srch.base);
+        }
+
+        search_in_turns(__starts);
+
+        // ends and records are in other pages, they're prefetched
+        // for the whole group too before they're read
+
+        for (std::size_t k{ 0u }; k < group_size; k++)
+        {
+            __builtin_prefetch(__ends + group[k].base);
+        }
+
+        for (std::size_t k{ 0u }; k < group_size; k++)
+        {
+            const __end &end{ __ends[group[k].base] };
+
+            if (end.record < __records.size())
+            {
+                __builtin_prefetch(__records.data() + end.record);
+            }
+        }
+
+        for (std::size_t k{ 0u }; k < group_size; k++)
+        {
+            const search &srch{ group[k] };
+
+            is_found[srch.ip_id] = __read_range(srch.base, srch.key, ips[srch.ip_id], infos[srch.ip_id]);
+        }
+    }
+}
+
+bool
+ipinfo::usr::database::open(const std::string &path)
+{
+    close();
+    __error = {};
+
+    const int fd{ ::open(path.c_str(), O_RDONLY | O_CLOEXEC) };
+    struct stat st{};
+
+    if (0 > fd or 0 != ::fstat(fd, &st))
+    {
+        __fail(constants::ERRORS_IDS::FAILED_FILE_ACCESS, "Failed to open the file");
+    }
+    else if (sizeof(__header) > static_cast<std::size_t>(st.st_size))
+    {
+        __fail(constants::ERRORS_IDS::CORRUPTED_FILE, "The file has no header");
+    }
+    else
+    {
+        // the mapping is kept after the file is closed
+        void *data {
+            ::mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0)
+        };
+
+        if (MAP_FAILED == data)
+        {
+            __fail(constants::ERRORS_IDS::FAILED_FILE_ACCESS, "Failed to map the file");
+        }
+        else
+        {
+            // lookups jump over the file, the read-ahead is useless
+            ::madvise(data, static_cast<std::size_t>(st.st_size), MADV_RANDOM);
+
+            __data = static_cast<const char *>(data);
+            __size = static_cast<std::size_t>(st.st_size);
+
+            std::memcpy(&__hdr, __data, sizeof(__header));
+        }
+    }
+
+    if (0 <= fd)
+    {
+        ::close(fd);
+    }
+
+    if (nullptr != __data and __check_layout())
+    {
+        return true;
+    }
+
+    close();
+    return false;
+}
+
+void
+ipinfo::usr::database::close()
+{
+    if (nullptr != __data)
+    {
+        ::munmap(const_cast<char *>(__data), __size);
+    }
+
+    __data = nullptr;
+    __size = 0u;
+    __hdr = {};
+
+    __starts = nullptr;
+    __ends = nullptr;
+    __records = {};
+    __index.clear();
+}
+
+bool
+ipinfo::usr::database::is_open() const
+{
+    return nullptr != __data;
+}
+
+std::size_t
+ipinfo::usr::database::get_ranges_num() const
+{
+    return static_cast<std::size_t>(__hdr.ranges_num);
+}
+
+ipinfo::usr::types::error
+ipinfo::usr::database::get_last_error() const
+{
+    return __error;
+}
@@ -0,0 +1,557 @@
+#include "../../include/ipinfo/ipinfo_types.hpp"
+#include "../../include/ipinfo/ipinfo_constants.hpp"
+#include "../../include/ipinfo/ipinfo_database.hpp"
+#include "../../include/ipinfo/ipinfo_database_builder.hpp"
+#include "../../include/ipinfo/ipinfo_classifier.hpp"
+#include "../../include/ipinfo/ipinfo_fields.hpp"
+#include "../../include/ipinfo/ipinfo_store.hpp"
+#include "../../include/ipinfo/ipinfo_stream_parser.hpp"
+#include "../../include/ipinfo/ipinfo_utiler.hpp"
+
+#include <array>       // std::array
+#include <cstddef>     // std::size_t
+#include <cstdint>     // std::uint8_t, std::uint32_t, std::uint64_t
+#include <cstdio>      // std::rename
+#include <cstring>     // std::memcpy
+#include <fstream>     // std::ifstream
+#include <iterator>    // std::prev
+#include <limits>      // std::numeric_limits
+#include <string>      // std::string, std::getline
+#include <string_view> // std::string_view
+#include <type_traits> // std::is_same_v, std::is_trivially_copyable_v
+#include <utility>     // std::move
+#include <vector>      // std::vector
+
+#include <fcntl.h>    // open
+#include <unistd.h>   // write, fsync, close, unlink
+
+namespace
+{
+    // fields of the address and of a failed answer aren't in records
+    bool is_record_field(const std::uint8_t field_id)
+    {
+        return
+            ipinfo::constants::INFO_FIELDS_IDS::IP != field_id and
+            ipinfo::constants::INFO_FIELDS_IDS::REVERSE_DNS != field_id and
+            ipinfo::constants::INFO_FIELDS_IDS::FAILURE_MESSAGE != field_id;
+    }
+
+    bool is_v4_mapped(const std::uint64_t hi, const std::uint64_t lo)
+    {
+        return 0u == hi and 0xFFFFu == (lo >> 32u);
+    }
+
+    bool write_all(const int fd, const char *data, std::size_t n)
+    {
+        while (0u < n)
+        {
+            const ssize_t written{ ::write(fd, data, n) };
+
+            if (0 >= written)
+            {
+                return false;
+            }
+
+            data += written;
+            n -= static_cast<std::size_t>(written);
+        }
+
+        return true;
+    }
+
+    // the directory's entry of a renamed file is durable after it's synced
+    void sync_dir(const std::string &path)
+    {
+        const std::size_t slash{ path.find_last_of('/') };
+        const std::string dir{ std::string::npos == slash ? "." : path.substr(0u, slash + 1u) };
+        const int fd{ ::open(dir.c_str(), O_RDONLY | O_CLOEXEC) };
+
+        if (0 <= fd)
+        {
+            ::fsync(fd);
+            ::close(fd);
+        }
+    }
+}
+
+ipinfo::usr::database_builder::__key
+ipinfo::usr::database_builder::__get_next(const __key &key)
+{
+    return {
+        .hi{ key.hi + ((std::numeric_limits<std::uint64_t>::max() == key.lo) ? 1u : 0u) },
+        .lo{ key.lo + 1u }
+    };
+}
+
+ipinfo::usr::database_builder::__key
+ipinfo::usr::database_builder::__get_prev(const __key &key)
+{
+    return {
+        .hi{ key.hi - ((0u == key.lo) ? 1u : 0u) },
+        .lo{ key.lo - 1u }
+    };
+}
+
+bool
+ipinfo::usr::database_builder::__is_same_network(
+    const __key &a,
+    const __key &b)
+{
+    const std::uint8_t v4_len{ constants::DEFAULT_CACHE_V4_PREFIX_LEN };
+    const std::uint8_t v6_len{ constants::DEFAULT_CACHE_V6_PREFIX_LEN };
+
+    const bool is_a_v4{ is_v4_mapped(a.hi, a.lo) };
+
+    if (is_a_v4 != is_v4_mapped(b.hi, b.lo))
+    {
+        return false;
+    }
+
+    if (is_a_v4)
+    {
+        return 0u < v4_len and 0u == (((a.lo ^ b.lo) & 0xFFFFFFFFu) >> (32u - v4_len));
+    }
+
+    return 0u < v6_len and 0u == ((a.hi ^ b.hi) >> (64u - v6_len));
+}
+
+bool
+ipinfo::usr::database_builder::__fail(
+    const std::uint8_t code,
+    const std::string &desc)
+{
+    __error = {
+        .code{ code },
+        .desc{ desc }
+    };
+
+    return false;
+}
+
+bool
+ipinfo::usr::database_builder::__make_record(
+    const ipinfo::srv::types::info &info,
+    std::string &out)
+{
+    // A field is taken from the first source which has it. Sources
+    // with a failure message have nothing to say about the IP.
+
+    std::array<std::uint8_t, constants::INFO_FIELDS_NUM> sources{};
+    std::uint64_t mask{ 0u };
+
+    for (std::uint8_t id{ 0u }; id < constants::INFO_FIELDS_NUM; id++)
+    {
+        for (std::uint8_t i{ 0u }; i < constants::INFO_SOURCES_NUM and is_record_field(id); i++)
+        {
+            if (srv::is_parsed(info, i, id) and
+                not srv::is_parsed(info, i, constants::INFO_FIELDS_IDS::FAILURE_MESSAGE))
+            {
+                sources[id] = i;
+                mask |= std::uint64_t{ 1u } << id;
+
+                break;
+            }
+        }
+    }
+
+    if (0u == mask)
+    {
+        return false;
+    }
+
+    // the size is written when the record is complete
+    out.assign(sizeof(std::uint32_t), '\0');
+    out.append(reinterpret_cast<const char *>(&mask), sizeof(mask));
+
+    for (std::uint8_t id{ 0u }; id < constants::INFO_FIELDS_NUM; id++)
+    {
+        if (0u == ((mask >> id) & 1u))
+        {
+            continue;
+        }
+
+        srv::visit_field(info, id, [&] (const auto &node)
+        {
+            using val_T = typename std::remove_cvref_t<decltype(node.cont)>::value_type;
+            const val_T &val{ node.cont[sources[id]] };
+
+            if constexpr (std::is_same_v<std::string, val_T>)
+            {
+                const std::uint32_t len{ static_cast<std::uint32_t>(val.size()) };
+
+                out.append(reinterpret_cast<const char *>(&len), sizeof(len));
+                out.append(val);
+            }
+            else if constexpr (std::is_same_v<bool, val_T>)
+            {
+                out.push_back(val ? '\1' : '\0');
+            }
+            else
+            {
+                static_assert(std::is_trivially_copyable_v<val_T>);
+                out.append(reinterpret_cast<const char *>(&val), sizeof(val_T));
+            }
+        });
+    }
+
+    const std::uint32_t size{ static_cast<std::uint32_t>(out.size() - sizeof(size)) };
+    std::memcpy(out.data(), &size, sizeof(size));
+
+    return true;
+}
+
+std::uint32_t
+ipinfo::usr::database_builder::__add_record(std::string &&record)
+{
+    if (const auto it{ __records_ids.find(record) }; __records_ids.end() != it)
+    {
+        return it->second;
+    }
+
+    const std::uint32_t id{ static_cast<std::uint32_t>(__records.size()) };
+
+    __records.push_back(std::move(record));
+    __records_ids.emplace(__records.back(), id);
+
+    return id;
+}
+
+void
+ipinfo::usr::database_builder::__assign(
+    const __key &first,
+    const __key &last,
+    const std::uint32_t record)
+{
+    // The range which starts before the first IP may cover it, it's
+    // cut there, and its part after the last IP is kept.
+
+    if (const auto next{ __ranges.lower_bound(first) }; __ranges.begin() != next)
+    {
+        const auto prev{ std::prev(next) };
+        const __range old{ prev->second };
+
+        if (not database::__is_less(old.last, first))
+        {
+            prev->second.last = __get_prev(first);
+
+            if (database::__is_less(last, old.last))
+            {
+                __ranges.emplace(__get_next(last), old);
+            }
+        }
+    }
+
+    // ranges which start inside are dropped, the last one may stick out
+    auto it{ __ranges.lower_bound(first) };
+
+    while (__ranges.end() != it and not database::__is_less(last, it->first))
+    {
+        const __range old{ it->second };
+        it = __ranges.erase(it);
+
+        if (database::__is_less(last, old.last))
+        {
+            __ranges.emplace(__get_next(last), old);
+            break;
+        }
+    }
+
+    __ranges.insert_or_assign(first, __range{ .last{ last }, .record{ record } });
+}
+
+bool
+ipinfo::usr::database_builder::__add(
+    const std::string &ip,
+    const std::string &lang,
+    const ipinfo::srv::types::info &info)
+{
+    srv::types::address addr{};
+    std::string record{};
+
+    if ((not __lang.empty() and not lang.empty() and __lang != lang) or
+        not srv::utiler{}.parse_address(ip, addr) or
+        srv::classifier{}.is_reserved(addr) or
+        not __make_record(info, record))
+    {
+        return false;
+    }
+
+    const __key key{ database::__get_key(addr) };
+
+    __assign(key, key, __add_record(std::move(record)));
+    __added_num++;
+
+    return true;
+}
+
+void
+ipinfo::usr::database_builder::set_lang(const std::string &lang)
+{
+    __lang = lang;
+}
+
+void
+ipinfo::usr::database_builder::set_gaps_filling(const bool is_enabled)
+{
+    __is_gaps_filling = is_enabled;
+}
+
+bool
+ipinfo::usr::database_builder::add_database(const std::string &path)
+{
+    __error = {};
+    usr::database db{};
+
+    if (not db.open(path))
+    {
+        __error = db.get_last_error();
+        return false;
+    }
+
+    for (std::size_t i{ 0u }; i < db.get_ranges_num(); i++)
+    {
+        const __key &first{ db.__starts[i] };
+        const database::__end &end{ db.__ends[i] };
+
+        srv::types::info info{};
+        std::string record{};
+
+        // broken ranges and records are dropped
+        if (database::__is_less(end.last, first) or
+            not db.__read_record(end.record, info) or
+            not __make_record(info, record))
+        {
+            continue;
+        }
+
+        __assign(first, end.last, __add_record(std::move(record)));
+        __added_num++;
+    }
+
+    return true;
+}
+
+bool
+ipinfo::usr::database_builder::add_cache_file(const std::string &path)
+{
+    __error = {};
+
+    // A running service may append to the file, so it's read only:
+    // its torn tail is the record which is being written.
+    srv::store store{};
+
+    if (not store.open_read_only(path))
+    {
+        __error = store.get_last_error();
+        return false;
+    }
+
+    // The key is the IP, the language and the hosts' mask. Keys are
+    // visited in order, so of results of the same IP the last key
+    // wins: the one of the largest mask in the last language.
+    return store.for_each([this] (const std::string_view key, const srv::types::info &info)
+    {
+        const std::size_t ip_end{ key.find('\0') };
+        const std::size_t lang_end{ key.find('\0', ip_end + 1u) };
+
+        if (std::string_view::npos == ip_end or std::string_view::npos == lang_end)
+        {
+            return;
+        }
+
+        __add(
+            std::string{ key.substr(0u, ip_end) },
+            std::string{ key.substr(ip_end + 1u, lang_end - ip_end - 1u) },
+            info);
+    });
+}
+
+bool
+ipinfo::usr::database_builder::add_answers(
+    const std::string &path,
+    const std::string &host)
+{
+    __error = {};
+
+    const srv::utiler utlr{};
+    const std::uint8_t host_id{ utlr.get_host_id(host) };
+
+    if (not utlr.is_host_supported(host_id))
+    {
+        return __fail(constants::ERRORS_IDS::UNSUPPORTED_HOST, "The host isn't supported");
+    }
+
+    std::ifstream in{ path };
+
+    if (not in.is_open())
+    {
+        return __fail(constants::ERRORS_IDS::FAILED_FILE_ACCESS, "Failed to open the file");
+    }
+
+    srv::stream_parser parser{};
+    std::vector<srv::types::info> infos{};
+    std::string line{};
+
+    while (std::getline(in, line))
+    {
+        const std::size_t first{ line.find_first_not_of(" \t\r") };
+
+        if (std::string::npos == first)
+        {
+            continue;
+        }
+
+        infos.clear();
+
+        if ('[' == line[first])
+        {
+            parser.parse_batch(line, infos, host);
+        }
+        else
+        {
+            parser.parse(line, infos.emplace_back(), host);
+        }
+
+        // values before the error are kept by the parser, they're dropped
+        if (constants::ERRORS_IDS::NO_ERRORS != parser.get_last_error().code)
+        {
+            continue;
+        }
+
+        for (const srv::types::info &info : infos)
+        {
+            if (srv::is_parsed(info, host_id, constants::INFO_FIELDS_IDS::IP))
+            {
+                __add(info.ip.cont[host_id], {}, info);
+            }
+        }
+    }
+
+    return true;
+}
+
+bool
+ipinfo::usr::database_builder::add_result(const ipinfo::usr::informer &result)
+{
+    return __add(result.__ip, result.__lang, result.__info);
+}
+
+void
+ipinfo::usr::database_builder::add_results(const std::vector<ipinfo::usr::informer> &results)
+{
+    for (const usr::informer &result : results)
+    {
+        add_result(result);
+    }
+}
+
+bool
+ipinfo::usr::database_builder::write(const std::string &path)
+{
+    __error = {};
+
+    // Neighbouring ranges with the same record are merged. Records are
+    // written once, in the order of their first ranges, and records
+    // which no range refers to any more are dropped.
+
+    constexpr std::uint64_t NO_OFFSET{ std::numeric_limits<std::uint64_t>::max() };
+
+    std::vector<__key> starts{};
+    std::vector<database::__end> ends{};
+    std::vector<std::uint64_t> offsets(__records.size(), NO_OFFSET);
+    std::string records{};
+    std::size_t records_num{ 0u };
+    std::uint32_t last_record{ 0u };
+
+    for (const auto &[first, rng] : __ranges)
+    {
+        const bool is_mergeable {
+            not ends.empty() and last_record == rng.record and
+            (not database::__is_less(__get_next(ends.back().last), first) or
+                (__is_gaps_filling and __is_same_network(ends.back().last, first)))
+        };
+
+        if (is_mergeable)
+        {
+            ends.back().last = rng.last;
+            continue;
+        }
+
+        if (NO_OFFSET == offsets[rng.record])
+        {
+            offsets[rng.record] = records.size();
+            records.append(__records[rng.record]);
+            records_num++;
+        }
+
+        starts.push_back(first);
+        ends.push_back({ .last{ rng.last }, .record{ offsets[rng.record] } });
+        last_record = rng.record;
+    }
+
+    database::__header hdr{};
+
+    std::memcpy(hdr.magic, database::__MAGIC, sizeof(database::__MAGIC));
+    hdr.version = database::__VERSION;
+    hdr.ranges_num = starts.size();
+    hdr.starts_offset = sizeof(hdr);
+    hdr.ends_offset = hdr.starts_offset + starts.size() * sizeof(__key);
+    hdr.records_offset = hdr.ends_offset + ends.size() * sizeof(database::__end);
+    hdr.records_size = records.size();
+
+    const std::string tmp_path{ path + ".tmp" };
+    const int fd{ ::open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644) };
+
+    if (0 > fd)
+    {
+        return __fail(constants::ERRORS_IDS::FAILED_FILE_ACCESS, "Failed to create a file");
+    }
+
+    const bool is_written {
+        write_all(fd, reinterpret_cast<const char *>(&hdr), sizeof(hdr)) and
+        write_all(fd, reinterpret_cast<const char *>(starts.data()), starts.size() * sizeof(__key)) and
+        write_all(fd, reinterpret_cast<const char *>(ends.data()), ends.size() * sizeof(database::__end)) and
+        write_all(fd, records.data(), records.size()) and
+        0 == ::fsync(fd)
+    };
+
+    ::close(fd);
+
+    // the previous file is kept, if the new one isn't complete
+    if (not is_written or 0 != std::rename(tmp_path.c_str(), path.c_str()))
+    {
+        ::unlink(tmp_path.c_str());
+        return __fail(constants::ERRORS_IDS::FAILED_FILE_ACCESS, "Failed to write the file");
+    }
+
+    sync_dir(path);
+
+    __written_ranges_num = starts.size();
+    __written_records_num = records_num;
+
+    return true;
+}
+
+std::size_t
+ipinfo::usr::database_builder::get_added_num() const
+{
+    return __added_num;
+}
+
+std::size_t
+ipinfo::usr::database_builder::get_ranges_num() const
+{
+    return __written_ranges_num;
+}
+
+std::size_t
+ipinfo::usr::database_builder::get_records_num() const
+{
+    return __written_records_num;
+}
+
+ipinfo::usr::types::error
+ipinfo::usr::database_builder::get_last_error() const
+{
+    return __error;
+}
@@ -0,0 +1,77 @@
+#include "../../include/ipinfo/ipinfo_constants.hpp"
+#include "../../include/ipinfo/ipinfo_engine.hpp"
+#include "../../include/ipinfo/ipinfo_informer.hpp"
+#include "../../include/ipinfo/ipinfo_loop.hpp"
+
+#include <algorithm> // std::max
+#include <chrono>
+#include <cstddef>   // std::size_t
+#include <future>    // std::promise, std::future
+#include <memory>    // std::make_shared, std::make_unique
+#include <utility>   // std::move
+
+ipinfo::usr::engine::engine(
+    const std::size_t threads_num,
+    const std::size_t max_host_requests)
+{
+    const std::size_t n{ std::max<std::size_t>(threads_num, 1u) };
+
+    // The limit is splitted between the loops, thus
+    // the engine never exceeds it in the whole.
+
+    const std::size_t loop_max_host_requests {
+        std::max<std::size_t>(max_host_requests / n, 1u)
+    };
+
+    for (std::size_t i{ 0u }; i < n; i++)
+    {
+        __loops.push_back(std::make_unique<srv::loop>(loop_max_host_requests));
+    }
+}
+
+ipinfo::usr::engine::~engine() = default;
+
+void
+ipinfo::usr::engine::submit(const usr::informer &infr, callback cb)
+{
+    const std::size_t i{ __next_loop.fetch_add(1u) % __loops.size() };
+    __loops.at(i)->submit(infr, std::chrono::steady_clock::time_point::max(), std::move(cb));
+}
+
+std::future<ipinfo::usr::informer>
+ipinfo::usr::engine::submit(const usr::informer &infr)
+{
+    const auto prms{ std::make_shared<std::promise<usr::informer>>() };
+    std::future<usr::informer> ftr{ prms->get_future() };
+
+    submit(infr, [prms](usr::informer &&res) {
+        prms->set_value(std::move(res));
+    });
+
+    return ftr;
+}
+
+void
+ipinfo::usr::engine::submit(
+    const usr::informer &infr,
+    const std::chrono::milliseconds &budget,
+    callback cb)
+{
+    const std::size_t i{ __next_loop.fetch_add(1u) % __loops.size() };
+    __loops.at(i)->submit(infr, std::chrono::steady_clock::now() + budget, std::move(cb));
+}
+
+std::future<ipinfo::usr::informer>
+ipinfo::usr::engine::submit(
+    const usr::informer &infr,
+    const std::chrono::milliseconds &budget)
+{
+    const auto prms{ std::make_shared<std::promise<usr::informer>>() };
+    std::future<usr::informer> ftr{ prms->get_future() };
+
+    submit(infr, budget, [prms](usr::informer &&res) {
+        prms->set_value(std::move(res));
+    });
+
+    return ftr;
+}
@@ -5,12 +5,30 @@
 #include "../../include/ipinfo/ipinfo_informer.hpp"
 #include "../../include/ipinfo/ipinfo_requester.hpp"
 #include "../../include/ipinfo/ipinfo_parser.hpp"
+#include "../../include/ipinfo/ipinfo_stream_parser.hpp"
 #include "../../include/ipinfo/ipinfo_utiler.hpp"
+#include "../../include/ipinfo/ipinfo_fields.hpp"
+#include "../../include/ipinfo/ipinfo_cache.hpp"
+#include "../../include/ipinfo/ipinfo_classifier.hpp"
+#include "../../include/ipinfo/ipinfo_database.hpp"
+#include "../../include/ipinfo/ipinfo_pool.hpp"
+#include "../../include/ipinfo/ipinfo_scheduler.hpp"
+#include "../../include/ipinfo/ipinfo_tracker.hpp"
+#include "../../include/ipinfo/ipinfo_breaker.hpp"
+#include "../../include/ipinfo/ipinfo_loop.hpp"
 
 #include <cstdint>
 #include <string>
+#include <vector>
 #include <utility>
 #include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <future>  // std::async, std::future
+#include <memory>  // std::shared_ptr
+#include <mutex>   // std::mutex, std::lock_guard
+#include <random>  // std::mt19937, std::uniform_int_distribution
+#include <thread>  // std::this_thread::sleep_for
 
 ipinfo::usr::informer::informer(
     const std::string &ip,
@@ -31,6 +49,15 @@ ipinfo::usr::informer::informer(
     }
 }
 
+ipinfo::usr::informer::informer(
+    const std::string &ip,
+    const std::string &lang,
+    const srv::types::info &info) :
+
+    __ip{ ip },
+    __lang{ lang },
+    __info{ info } {}
+
 bool
 ipinfo::usr::informer::__is_api_key_setted_up(const std::string &host) const
 {
@@ -60,267 +87,963 @@ ipinfo::usr::informer::__get_request_attributes(const std::string &host) const
         .host{ host },
         .ip{ __ip },
         .lang{ __lang },
-        .api_key{ api_key }
+        .api_key{ api_key },
+        .deadline{ __deadline }
     };
 }
 
-void
-ipinfo::usr::informer::set_connections_num(const std::uint8_t n)
-{
-    __conn_num = n;
-}
-
-void
-ipinfo::usr::informer::set_ip(const std::string &ip)
-{
-    __ip = ip;
-}
-
-void
-ipinfo::usr::informer::set_lang(const std::string &lang)
+std::vector<std::string>
+ipinfo::usr::informer::__get_active_hosts()
 {
-    __lang = __utiler->to_lower_case(lang);
-}
+    const auto &avl_hosts{ constants::AVAILABLE_HOSTS };
+    std::vector<std::string> hosts{};
 
-void
-ipinfo::usr::informer::set_lang(const std::uint8_t lang_id)
-{
-    if (__utiler->is_lang_supported(lang_id))
+    if (0u == __conn_num or __conn_num > avl_hosts.size())
     {
-        __lang = constants::AVAILABLE_LANGS.at(lang_id);
+        __conn_num = avl_hosts.size();
     }
-}
 
-void
-ipinfo::usr::informer::set_api_key(
-        const std::string &host,
-        const std::string &key)
-{
-    if (__utiler->is_host_supported(host) and not key.empty())
+    for (std::uint8_t i{ 0u }; i < __conn_num; i++)
     {
-        __api_keys.insert(std::make_pair(host, key));
+        const std::string &host{ avl_hosts.at(i) };
+
+        if (not __is_host_excluded(host))
+        {
+            hosts.push_back(host);
+        }
     }
+
+    return hosts;
 }
 
-void
-ipinfo::usr::informer::informer::set_api_key(
-    const std::uint8_t host_id,
-    const std::string &key)
+std::uint8_t
+ipinfo::usr::informer::__get_hosts_mask(const std::vector<std::string> &hosts)
 {
-    if (__utiler->is_host_supported(host_id))
+    const srv::utiler utlr{};
+    std::uint8_t mask{ 0u };
+
+    for (const std::string &host : hosts)
     {
-        set_api_key(constants::AVAILABLE_HOSTS.at(host_id), key);
+        mask |= static_cast<std::uint8_t>(1u << utlr.get_host_id(host));
     }
+
+    return mask;
 }
 
-void
-ipi::usr::informer::set_api_keys(const std::map<als::str, als::str> &host_key)
+bool
+ipinfo::usr::informer::__run_locally()
 {
-    for (const auto &[host, api_key] : host_key)
+    // reserved IPs are answered locally, hosts know nothing about them
+    if (srv::classifier{}.classify(__ip, __info))
     {
-        set_api_key(host, api_key);
+        return true;
     }
-}
 
-void
-ipi::usr::informer::set_api_keys(const std::map<als::u8, als::str> &host_id_key)
-{
-    for (const auto &[host_id, api_key] : host_id_key)
+    if (not __database)
     {
-        this->set_api_key(host_id, api_key);
+        return false;
     }
-}
 
-void
-ipinfo::usr::informer::exclude_host(const std::string &host)
-{
-    if (__utiler->is_host_supported(host) and not __is_host_excluded(host))
+    if (__database->__find(__ip, __info))
     {
-        __excluded_hosts.push_back(host);
+        return true;
     }
+
+    return __miss_database();
 }
 
-void
-ipinfo::usr::informer::exclude_host(const std::uint8_t host_id)
+bool
+ipinfo::usr::informer::__miss_database()
 {
-    if (__utiler->is_host_supported(host_id))
+    if (constants::DATABASE_MODES_IDS::EXCLUSIVE == __database_mode)
     {
-        __excluded_hosts.push_back(constants::AVAILABLE_HOSTS.at(host_id));
+        __errors[constants::LOCAL_SOURCE] = {
+            .code{ constants::ERRORS_IDS::FAILED_LOOKUP },
+            .desc{ "The IP isn't in the database" }
+        };
+
+        return true;
     }
+
+    return false;
 }
 
-void
-ipinfo::usr::informer::exclude_hosts(const std::vector<std::string> &hosts)
+bool
+ipinfo::usr::informer::__is_transient(const srv::types::response &resp)
 {
-    for (const std::string &host : hosts)
+    switch (resp.error.code)
     {
-        exclude_host(host);
+        case constants::ERRORS_IDS::REQUEST_TIMEOUT:
+        case constants::ERRORS_IDS::FAILED_REQUEST:
+        {
+            return true;
+        }
+
+        case constants::ERRORS_IDS::UNSUCCESSFULL_RESPONSE_STATUS_CODE:
+        {
+            return (500 <= resp.status_code or 429 == resp.status_code);
+        }
+
+        default:
+        {
+            return false;
+        }
     }
 }
 
-void
-ipinfo::usr::informer::exclude_hosts(const std::vector<std::uint8_t> &hosts_ids)
+ipinfo::srv::types::response
+ipinfo::usr::informer::__request(
+    const srv::types::request_attributes &ra,
+    const std::uint8_t retries_num)
 {
-    for (const std::uint8_t &id : hosts_ids)
+    using namespace std::chrono;
+
+    thread_local std::mt19937 rnd{ std::random_device{}() };
+    auto &brkr{ srv::breaker::instance() };
+
+    // A retry which isn't done tells nothing new about the host,
+    // so the error of the last request is kept for the caller.
+    srv::types::response last_resp{};
+
+    for (std::uint8_t attempt{ 0u }; ; attempt++)
     {
-        exclude_host(id);
+        if (not brkr.allow(ra.host))
+        {
+            if (0u != attempt)
+            {
+                return last_resp;
+            }
+
+            return {
+                .error {
+                    .code{ constants::ERRORS_IDS::UNAVAILABLE_HOST },
+                    .desc{ "The host is failing, it's skipped until the cooldown" }
+                }
+            };
+        }
+
+        srv::types::response resp{ srv::requester{}.request(ra) };
+
+        // The rate limit's wait or the caller's budget is over before
+        // the request, the host isn't asked, so its probe is released.
+        // The deadline is over, thus there is no retry too.
+
+        if (not resp.is_sent)
+        {
+            brkr.on_abort(ra.host);
+            return 0u != attempt ? last_resp : resp;
+        }
+
+        const bool is_transient{ __is_transient(resp) };
+
+        // Throttling isn't a sign of a dead host, the
+        // scheduler takes care of it before the retry.
+
+        if (is_transient and 429 != resp.status_code)
+        {
+            brkr.on_failure(ra.host);
+        }
+        else
+        {
+            brkr.on_success(ra.host);
+        }
+
+        if (not is_transient or attempt >= retries_num)
+        {
+            return resp;
+        }
+
+        const auto cap {
+            std::min(constants::RETRY_MAX_DELAY,
+                constants::RETRY_BASE_DELAY * (1 << std::min<int>(attempt, 16)))
+        };
+
+        const milliseconds delay {
+            std::uniform_int_distribution<milliseconds::rep>{ 0, cap.count() }(rnd)
+        };
+
+        // There is no sense to retry, if the
+        // retry wouldn't be done by the deadline.
+
+        if (ra.deadline - steady_clock::now() <= delay)
+        {
+            return resp;
+        }
+
+        last_resp = std::move(resp);
+        std::this_thread::sleep_for(delay);
     }
 }
 
 void
-ipinfo::usr::informer::run()
+ipinfo::usr::informer::__parse(
+    const std::string &json,
+    const std::string &host)
 {
-    __utiler->clear_info(__info);
-    const auto &avl_hosts{ constants::AVAILABLE_HOSTS };
+    usr::types::error error{};
 
-    if (0u == __conn_num or __conn_num > avl_hosts.size())
+    if (constants::PARSERS_IDS::STREAMING == __parser_id)
     {
-        __conn_num = avl_hosts.size();
+        srv::stream_parser prsr{};
+
+        prsr.parse(json, __info, host);
+        error = prsr.get_last_error();
     }
+    else
+    {
+        srv::parser prsr{};
 
-    for (std::uint8_t i{ 0u }; i < __conn_num; i++)
+        prsr.parse(json, __info, host);
+        error = prsr.get_last_error();
+    }
+
+    // A truncated or malformed answer isn't a result: the values read
+    // before the error are dropped and the host gets the parser's error,
+    // so a partial info isn't cached as a success.
+
+    if (constants::ERRORS_IDS::NO_ERRORS != error.code)
     {
-        const std::string &host{ avl_hosts.at(i) };
+        const srv::utiler utlr{};
+        const std::uint8_t host_id{ utlr.get_host_id(host) };
 
-        if (__is_host_excluded(host))
+        if (utlr.is_host_supported(host_id))
         {
-            continue;
+            __info.parsed[host_id] = 0u;
         }
 
-        std::string answ{};
-        const als::req_attrs ra{ __get_request_attributes(host) };
-
-        answ = __requester->request(ra);
-        __parser->parse(answ, __info, host);
+        __errors[host] = error;
+        return;
     }
 
-    return;
+    __check_failure(host);
 }
 
-ipinfo::usr::types::error
-ipinfo::usr::informer::get_last_error(const std::string &host) const
+void
+ipinfo::usr::informer::__check_failure(const std::string &host)
 {
-    if (host.empty())
+    const srv::utiler utlr{};
+    const std::uint8_t host_id{ utlr.get_host_id(host) };
+    const std::uint8_t field_id{ constants::INFO_FIELDS_IDS::FAILURE_MESSAGE };
+
+    if (not utlr.is_host_supported(host_id) or
+        not srv::is_parsed(__info, host_id, field_id))
     {
-        return {
-            .code{ constants::ERRORS_IDS::EMPTY_HOST },
-            .desc{ "Empty host string" }
-        };
+        return;
     }
 
-    if (not __utiler->is_host_supported(host))
+    // E.g. "invalid query", "reserved range" of ip-api.com and
+    // "Invalid IP address", "You've hit the monthly limit"
+    // of ipwhois.app.
+
+    const std::string &msg{ __info.failure_message.cont[host_id] };
+    const std::string lc_msg{ utlr.to_lower_case(msg) };
+
+    std::uint8_t code{ constants::ERRORS_IDS::FAILED_LOOKUP };
+
+    if (std::string::npos != lc_msg.find("limit") or
+        std::string::npos != lc_msg.find("quota"))
     {
-        return {
-            .code{ constants::ERRORS_IDS::UNSUPPORTED_HOST },
-            .desc{ "This host in unsuppoted by ipinfo" }
-        };
+        code = constants::ERRORS_IDS::THROTTLED_REQUEST;
     }
-
-    if (__is_host_excluded(host))
+    else if (std::string::npos != lc_msg.find("invalid") or
+        std::string::npos != lc_msg.find("range"))
     {
-        return {
-            .code{ constants::ERRORS_IDS::EXCLUDED_HOST },
-            .desc{ "This host is excluded" }
-        };
+        code = constants::ERRORS_IDS::INVALID_QUERY;
     }
 
-    return (__errors.find(host) != __errors.end()) ?
-        __errors.at(host) : als::err{};
+    __errors[host] = {
+        .code{ code },
+        .desc{ msg }
+    };
 }
 
-ipinfo::usr::types::error
-ipinfo::usr::informer::get_last_error(const std::uint8_t host_id) const
+void
+ipinfo::usr::informer::__handle_response(
+    const std::string &host,
+    const srv::types::response &resp)
 {
-    if (not __utiler->is_host_supported(host_id))
+    if (429 == resp.status_code)
     {
-        return {
-            .code{ constants::ERRORS_IDS::UNSUPPORTED_HOST },
-            .desc{ "This host is unsuppoted by ipinfo" }
+        __errors[host] = {
+            .code{ constants::ERRORS_IDS::THROTTLED_REQUEST },
+            .desc{ resp.error.desc }
         };
+
+        return;
     }
 
-    return get_last_error(constants::AVAILABLE_HOSTS.at(host_id));
-}
+    if (constants::ERRORS_IDS::NO_ERRORS != resp.error.code)
+    {
+        __errors[host] = resp.error;
+        return;
+    }
 
+    __parse(resp.answ, host);
+}
 
-std::uint8_t
-ipinfo::usr::informer::get_errors_num() const
+void
+ipinfo::usr::informer::__set_timeout_error(const std::string &host)
 {
-    std::uint8_t i{ 0u };
+    __errors[host] = {
+        .code{ constants::ERRORS_IDS::REQUEST_TIMEOUT },
+        .desc{ "The request isn't done by the deadline" }
+    };
+}
 
-    for (const auto &[_, __error] : __errors)
+void
+ipinfo::usr::informer::__run_sequentially(const std::vector<std::string> &hosts)
+{
+    for (const std::string &host : hosts)
     {
-        if (constants::ERRORS_IDS::NO_ERRORS != __error.code)
+        // The hosts which are left after the deadline aren't
+        // requested at all, the parsed data is kept as is.
+
+        if (std::chrono::steady_clock::now() >= __deadline)
         {
-            i += 1;
+            __set_timeout_error(host);
+            continue;
         }
+
+        const als::req_attrs ra{ __get_request_attributes(host) };
+        __handle_response(host, __request(ra, __retries_num));
     }
 
-    return i;
+    return;
 }
 
-std::string
-ipinfo::usr::informer::get_ip() const
+void
+ipinfo::usr::informer::__run_concurrently(const std::vector<std::string> &hosts)
 {
-    return get_ip_ex().val;
-}
+    // Every host is requested from its own thread. Each thread parses
+    // its answer as soon as one arrives, so the whole run takes about
+    // as long as the slowest host. Parsing is serialized by the mutex.
+    // Every request is aborted at the deadline, thus it bounds the run.
 
-std::string
-ipinfo::usr::informer::get_ip_type() const
-{
-    return get_ip_type_ex().val;
-}
+    std::mutex info_mtx{};
+    std::vector<std::future<void>> tasks{};
 
-std::string
-ipinfo::usr::informer::get_continent() const
-{
-    return get_continent_ex().val;
-}
+    for (const std::string &host : hosts)
+    {
+        tasks.push_back(std::async(std::launch::async, [this, &host, &info_mtx]() {
+            const als::req_attrs ra{ __get_request_attributes(host) };
+            const als::resp resp{ __request(ra, __retries_num) };
 
-std::string
-ipinfo::usr::informer::get_continent_code() const
-{
-    return get_continent_code_ex().val;
-}
+            const std::lock_guard<std::mutex> lock{ info_mtx };
+            __handle_response(host, resp);
+        }));
+    }
 
-std::string
-ipinfo::usr::informer::get_country() const
-{
-    return get_country_ex().val;
-}
+    for (auto &task : tasks)
+    {
+        task.get();
+    }
 
-std::string
-ipinfo::usr::informer::get_country_code() const
-{
-    return get_country_code_ex().val;
+    return;
 }
 
-std::string
-ipinfo::usr::informer::get_country_capital() const
+ipinfo::srv::loop &
+ipinfo::usr::informer::__get_hedges_loop()
 {
-    return get_country_capital_ex().val;
-}
+    // Statics are destroyed in the reverse order of their creation,
+    // so the singletons are created first. The loop's destructor
+    // aborts the abandoned transfers and joins its thread.
 
-std::string
-ipinfo::usr::informer::get_country_ph_code() const
-{
-    return get_country_ph_code_ex().val;
-}
+    srv::scheduler::instance();
+    srv::breaker::instance();
+    srv::tracker::instance();
 
-std::string
-ipinfo::usr::informer::get_country_neighbors() const
-{
-    return get_country_neighbors_ex().val;
+    static srv::loop lp{ constants::DEFAULT_ENGINE_MAX_HOST_REQUESTS };
+    return lp;
 }
 
-std::string
-ipinfo::usr::informer::get_region() const
+void
+ipinfo::usr::informer::__run_hedged(const std::vector<std::string> &hosts)
 {
-    return get_region_ex().val;
-}
+    // The first host is requested at once. The second one is requested
+    // only if the first hasn't answered during its usual latency or has
+    // failed. The first complete answer is taken, the late request is
+    // abandoned: it's left to the loop of the process, and its callback
+    // owns the shared state.
 
-std::string
-ipinfo::usr::informer::get_region_code() const
+    using clock = std::chrono::steady_clock;
+
+    struct state
+    {
+        std::mutex mtx{};
+        std::condition_variable cv{};
+        std::vector<std::pair<std::string, usr::informer>> results{};
+    };
+
+    const auto st{ std::make_shared<state>() };
+
+    const auto launch {
+        [this, &st, &hosts](const std::string &host) {
+            // the hedge asks only its host and isn't cached,
+            // the result is cached by this informer
+            usr::informer hedge{ *this };
+            hedge.set_cache(nullptr);
+            hedge.set_database(nullptr);
+
+            for (const std::string &h : hosts)
+            {
+                if (host != h)
+                {
+                    hedge.exclude_host(h);
+                }
+            }
+
+            __get_hedges_loop().submit(hedge, __deadline,
+                [st, host](usr::informer &&res) {
+                    const std::lock_guard<std::mutex> lock{ st->mtx };
+                    st->results.emplace_back(host, std::move(res));
+                    st->cv.notify_all();
+                });
+        }
+    };
+
+    if (hosts.empty())
+    {
+        return;
+    }
+
+    const std::size_t hedges_num{ std::min<std::size_t>(hosts.size(), 2u) };
+    std::size_t launched{ 1u }, handled{ 0u };
+
+    launch(hosts.at(0u));
+
+    const auto hedge_at {
+        clock::now() + srv::tracker::instance().get_hedge_delay(hosts.at(0u))
+    };
+
+    std::unique_lock<std::mutex> lock{ st->mtx };
+
+    while (handled < launched)
+    {
+        const auto is_answered {
+            [&st, handled]() -> bool { return st->results.size() > handled; }
+        };
+
+        const auto wake_at {
+            (launched < hedges_num) ? std::min(hedge_at, __deadline) : __deadline
+        };
+
+        if (clock::time_point::max() == wake_at)
+        {
+            st->cv.wait(lock, is_answered);
+        }
+        else
+        {
+            st->cv.wait_until(lock, wake_at, is_answered);
+        }
+
+        while (st->results.size() > handled)
+        {
+            const auto &[host, res]{ st->results.at(handled) };
+            handled += 1u;
+
+            const auto error{ res.__errors.find(host) };
+
+            if (res.__errors.end() != error)
+            {
+                __errors[host] = error->second;
+                continue;
+            }
+
+            srv::copy_parsed(res.__info, __info, srv::utiler{}.get_host_id(host));
+            return;
+        }
+
+        if (clock::now() >= __deadline)
+        {
+            break;
+        }
+
+        // The first host is late or has failed, so it's hedged.
+        if (launched < hedges_num and
+            (clock::now() >= hedge_at or handled == launched))
+        {
+            launch(hosts.at(launched));
+            launched += 1u;
+        }
+    }
+
+    // The hosts which haven't answered by the deadline.
+    for (std::size_t i{ 0u }; i < launched; i++)
+    {
+        if (0u == __errors.count(hosts.at(i)))
+        {
+            __set_timeout_error(hosts.at(i));
+        }
+    }
+
+    return;
+}
+
+void
+ipinfo::usr::informer::set_retries_num(const std::uint8_t n)
+{
+    __retries_num = n;
+}
+
+void
+ipinfo::usr::informer::set_parser(const std::uint8_t parser_id)
+{
+    if (constants::PARSERS_IDS::STREAMING >= parser_id)
+    {
+        __parser_id = parser_id;
+    }
+}
+
+void
+ipinfo::usr::informer::set_cache(const std::shared_ptr<usr::cache> &cache)
+{
+    __cache = cache;
+}
+
+void
+ipinfo::usr::informer::set_database(
+    const std::shared_ptr<usr::database> &db,
+    const std::uint8_t mode_id)
+{
+    __database = db;
+    __database_mode = mode_id;
+}
+
+void
+ipinfo::usr::informer::set_connections_num(const std::uint8_t n)
+{
+    __conn_num = n;
+}
+
+void
+ipinfo::usr::informer::set_run_mode(const std::uint8_t mode_id)
+{
+    if (constants::RUN_MODES_IDS::HEDGED >= mode_id)
+    {
+        __run_mode = mode_id;
+    }
+}
+
+void
+ipinfo::usr::informer::set_pool_size(const std::size_t n)
+{
+    srv::pool::instance().set_size(n);
+}
+
+void
+ipinfo::usr::informer::set_pool_idle_timeout(
+    const std::chrono::milliseconds &timeout)
+{
+    srv::pool::instance().set_idle_timeout(timeout);
+}
+
+void
+ipinfo::usr::informer::set_rate_limit(
+    const std::string &host,
+    const std::uint32_t per_minute)
+{
+    if (srv::utiler{}.is_host_supported(host))
+    {
+        srv::scheduler::instance().set_limit(host, per_minute);
+    }
+}
+
+void
+ipinfo::usr::informer::set_rate_limit(
+    const std::uint8_t host_id,
+    const std::uint32_t per_minute)
+{
+    if (srv::utiler{}.is_host_supported(host_id))
+    {
+        set_rate_limit(constants::AVAILABLE_HOSTS.at(host_id), per_minute);
+    }
+}
+
+ipinfo::usr::types::quota
+ipinfo::usr::informer::get_quota(const std::string &host)
+{
+    if (not srv::utiler{}.is_host_supported(host))
+    {
+        return {};
+    }
+
+    return srv::scheduler::instance().get_quota(host);
+}
+
+ipinfo::usr::types::quota
+ipinfo::usr::informer::get_quota(const std::uint8_t host_id)
+{
+    if (not srv::utiler{}.is_host_supported(host_id))
+    {
+        return {};
+    }
+
+    return get_quota(constants::AVAILABLE_HOSTS.at(host_id));
+}
+
+void
+ipinfo::usr::informer::set_breaker_threshold(const std::uint32_t failures)
+{
+    srv::breaker::instance().set_threshold(failures);
+}
+
+void
+ipinfo::usr::informer::set_breaker_cooldown(
+    const std::chrono::milliseconds &cooldown)
+{
+    srv::breaker::instance().set_cooldown(cooldown);
+}
+
+std::uint8_t
+ipinfo::usr::informer::get_host_state(const std::string &host)
+{
+    if (not srv::utiler{}.is_host_supported(host))
+    {
+        return constants::BREAKER_STATES_IDS::CLOSED;
+    }
+
+    return srv::breaker::instance().get_state(host);
+}
+
+std::uint8_t
+ipinfo::usr::informer::get_host_state(const std::uint8_t host_id)
+{
+    if (not srv::utiler{}.is_host_supported(host_id))
+    {
+        return constants::BREAKER_STATES_IDS::CLOSED;
+    }
+
+    return get_host_state(constants::AVAILABLE_HOSTS.at(host_id));
+}
+
+void
+ipinfo::usr::informer::set_ip(const std::string &ip)
+{
+    __ip = ip;
+}
+
+void
+ipinfo::usr::informer::set_lang(const std::string &lang)
+{
+    __lang = __utiler->to_lower_case(lang);
+}
+
+void
+ipinfo::usr::informer::set_lang(const std::uint8_t lang_id)
+{
+    if (__utiler->is_lang_supported(lang_id))
+    {
+        __lang = constants::AVAILABLE_LANGS.at(lang_id);
+    }
+}
+
+void
+ipinfo::usr::informer::set_api_key(
+        const std::string &host,
+        const std::string &key)
+{
+    if (__utiler->is_host_supported(host) and not key.empty())
+    {
+        __api_keys.insert(std::make_pair(host, key));
+    }
+}
+
+void
+ipinfo::usr::informer::informer::set_api_key(
+    const std::uint8_t host_id,
+    const std::string &key)
+{
+    if (__utiler->is_host_supported(host_id))
+    {
+        set_api_key(constants::AVAILABLE_HOSTS.at(host_id), key);
+    }
+}
+
+void
+ipi::usr::informer::set_api_keys(const std::map<als::str, als::str> &host_key)
+{
+    for (const auto &[host, api_key] : host_key)
+    {
+        set_api_key(host, api_key);
+    }
+}
+
+void
+ipi::usr::informer::set_api_keys(const std::map<als::u8, als::str> &host_id_key)
+{
+    for (const auto &[host_id, api_key] : host_id_key)
+    {
+        this->set_api_key(host_id, api_key);
+    }
+}
+
+void
+ipinfo::usr::informer::exclude_host(const std::string &host)
+{
+    if (__utiler->is_host_supported(host) and not __is_host_excluded(host))
+    {
+        __excluded_hosts.push_back(host);
+    }
+}
+
+void
+ipinfo::usr::informer::exclude_host(const std::uint8_t host_id)
+{
+    if (__utiler->is_host_supported(host_id))
+    {
+        __excluded_hosts.push_back(constants::AVAILABLE_HOSTS.at(host_id));
+    }
+}
+
+void
+ipinfo::usr::informer::exclude_hosts(const std::vector<std::string> &hosts)
+{
+    for (const std::string &host : hosts)
+    {
+        exclude_host(host);
+    }
+}
+
+void
+ipinfo::usr::informer::exclude_hosts(const std::vector<std::uint8_t> &hosts_ids)
+{
+    for (const std::uint8_t &id : hosts_ids)
+    {
+        exclude_host(id);
+    }
+}
+
+void
+ipinfo::usr::informer::run()
+{
+    run(std::chrono::steady_clock::time_point::max());
+}
+
+void
+ipinfo::usr::informer::run(const std::chrono::milliseconds &budget)
+{
+    run(std::chrono::steady_clock::now() + budget);
+}
+
+void
+ipinfo::usr::informer::run(const std::chrono::steady_clock::time_point &deadline)
+{
+    __utiler->clear_info(__info);
+    __errors.clear();
+    __deadline = deadline;
+
+    if (__run_locally())
+    {
+        return;
+    }
+
+    const std::vector<std::string> hosts{ __get_active_hosts() };
+    const std::uint8_t hosts_mask{ __get_hosts_mask(hosts) };
+
+    bool is_stale{ false };
+
+    if (__cache and __cache->__find(__ip, __lang, hosts_mask, __info, __errors, is_stale))
+    {
+        if (is_stale)
+        {
+            __cache->__refresh(*this, hosts_mask);
+        }
+
+        return;
+    }
+
+    // If another informer is looking the key up, its result is
+    // taken instead of sending the same requests once again.
+
+    bool is_leader{ true };
+    usr::cache::flight_ptr flight{};
+
+    if (__cache)
+    {
+        flight = __cache->__join(__ip, __lang, hosts_mask, is_leader);
+    }
+
+    if (not is_leader)
+    {
+        if (not usr::cache::__wait(*flight, __deadline, __info, __errors))
+        {
+            for (const std::string &host : hosts)
+            {
+                __set_timeout_error(host);
+            }
+        }
+
+        return;
+    }
+
+    // The leader must land its flight whatever happens, else waiters
+    // without a deadline are blocked forever. If the run throws, the
+    // guard abandons the flight on the way out.
+
+    struct flight_guard
+    {
+        usr::informer &infr;
+        const std::uint8_t hosts_mask{ 0u };
+        usr::cache::flight_ptr &flight;
+
+        ~flight_guard()
+        {
+            if (flight)
+            {
+                infr.__cache->__abandon(infr.__ip, infr.__lang, hosts_mask, flight);
+            }
+        }
+    };
+
+    const flight_guard guard{ *this, hosts_mask, flight };
+
+    if (constants::RUN_MODES_IDS::CONCURRENT == __run_mode and 1u < hosts.size())
+    {
+        __run_concurrently(hosts);
+    }
+    else if (constants::RUN_MODES_IDS::HEDGED == __run_mode and 1u < hosts.size())
+    {
+        __run_hedged(hosts);
+    }
+    else
+    {
+        __run_sequentially(hosts);
+    }
+
+    // failed lookups are cached too, if their errors are permanent
+    if (__cache)
+    {
+        __cache->__land(__ip, __lang, hosts_mask, flight, __info, __errors);
+        flight.reset();
+    }
+
+    return;
+}
+
+ipinfo::usr::types::error
+ipinfo::usr::informer::get_last_error(const std::string &host) const
+{
+    if (host.empty())
+    {
+        return {
+            .code{ constants::ERRORS_IDS::EMPTY_HOST },
+            .desc{ "Empty host string" }
+        };
+    }
+
+    if (not __utiler->is_host_supported(host))
+    {
+        return {
+            .code{ constants::ERRORS_IDS::UNSUPPORTED_HOST },
+            .desc{ "This host in unsuppoted by ipinfo" }
+        };
+    }
+
+    if (__is_host_excluded(host))
+    {
+        return {
+            .code{ constants::ERRORS_IDS::EXCLUDED_HOST },
+            .desc{ "This host is excluded" }
+        };
+    }
+
+    return (__errors.find(host) != __errors.end()) ?
+        __errors.at(host) : als::err{};
+}
+
+ipinfo::usr::types::error
+ipinfo::usr::informer::get_last_error(const std::uint8_t host_id) const
+{
+    if (not __utiler->is_host_supported(host_id))
+    {
+        return {
+            .code{ constants::ERRORS_IDS::UNSUPPORTED_HOST },
+            .desc{ "This host is unsuppoted by ipinfo" }
+        };
+    }
+
+    return get_last_error(constants::AVAILABLE_HOSTS.at(host_id));
+}
+
+
+std::uint8_t
+ipinfo::usr::informer::get_errors_num() const
+{
+    std::uint8_t i{ 0u };
+
+    for (const auto &[_, __error] : __errors)
+    {
+        if (constants::ERRORS_IDS::NO_ERRORS != __error.code)
+        {
+            i += 1;
+        }
+    }
+
+    return i;
+}
+
+std::string
+ipinfo::usr::informer::get_ip() const
+{
+    return get_ip_ex().val;
+}
+
+std::string
+ipinfo::usr::informer::get_ip_type() const
+{
+    return get_ip_type_ex().val;
+}
+
+std::string
+ipinfo::usr::informer::get_continent() const
+{
+    return get_continent_ex().val;
+}
+
+std::string
+ipinfo::usr::informer::get_continent_code() const
+{
+    return get_continent_code_ex().val;
+}
+
+std::string
+ipinfo::usr::informer::get_country() const
+{
+    return get_country_ex().val;
+}
+
+std::string
+ipinfo::usr::informer::get_country_code() const
+{
+    return get_country_code_ex().val;
+}
+
+std::string
+ipinfo::usr::informer::get_country_capital() const
+{
+    return get_country_capital_ex().val;
+}
+
+std::string
+ipinfo::usr::informer::get_country_ph_code() const
+{
+    return get_country_ph_code_ex().val;
+}
+
+std::string
+ipinfo::usr::informer::get_country_neighbors() const
+{
+    return get_country_neighbors_ex().val;
+}
+
+std::string
+ipinfo::usr::informer::get_region() const
+{
+    return get_region_ex().val;
+}
+
+std::string
+ipinfo::usr::informer::get_region_code() const
 {
     return get_region_code_ex().val;
 }
@@ -457,832 +1180,243 @@ ipinfo::usr::informer::get_currency_plural() const
     return get_currency_plural_ex().val;
 }
 
-ipinfo::usr::types::node<std::string>
-ipinfo::usr::informer::get_ip_ex() const
+bool
+ipinfo::usr::informer::get_reserved_status() const
 {
-    const auto &node{ __info.ip };
+    return get_reserved_status_ex().val;
+}
 
-    for (const auto &host : constants::AVAILABLE_HOSTS)
-    {
-        const auto &content{ node.cont.at(host) };
+template<typename node_T> auto
+ipinfo::usr::informer::__get_node_ex(
+    const node_T &node,
+    const std::uint8_t field_id) const
+{
+    using val_T = typename decltype(node.cont)::value_type;
+
+    const std::string desc{ constants::INFO_FIELDS.at(field_id).desc };
 
-        if (content.is_parsed)
+    for (std::size_t i{ 0u }; i < node.cont.size(); i++)
+    {
+        if (srv::is_parsed(__info, i, field_id))
         {
-            return {
+            return usr::types::node<val_T> {
                 .is_parsed{ true },
-                .val{ content.val },
-                .host{ host },
-                .desc{ node.desc }
+                .val{ node.cont[i] },
+                .host {
+                    constants::LOCAL_SOURCE_ID == i ?
+                        constants::LOCAL_SOURCE : constants::AVAILABLE_HOSTS.at(i)
+                },
+                .desc{ desc }
             };
         }
     }
 
-    return {
-        .desc{ node.desc }
+    return usr::types::node<val_T> {
+        .desc{ desc }
     };
 }
 
 ipinfo::usr::types::node<std::string>
-ipinfo::usr::informer::get_ip_type_ex() const
+ipinfo::usr::informer::get_ip_ex() const
 {
-    const auto &node{ __info.ip_type };
-
-    for (const auto &host : constants::AVAILABLE_HOSTS)
-    {
-        const auto &content{ node.cont.at(host) };
-
-        if (content.is_parsed)
-        {
-            return {
-                .is_parsed{ true },
-                .val{ content.val },
-                .host{ host },
-                .desc{ node.desc }
-            };
-        }
-    }
+    return __get_node_ex(__info.ip, constants::INFO_FIELDS_IDS::IP);
+}
 
-    return {
-        .desc{ node.desc }
-    };
+ipinfo::usr::types::node<std::string>
+ipinfo::usr::informer::get_ip_type_ex() const
+{
+    return __get_node_ex(__info.ip_type, constants::INFO_FIELDS_IDS::IP_TYPE);
 }
 
 ipinfo::usr::types::node<std::string>
 ipinfo::usr::informer::get_continent_ex() const
 {
-    const auto &node{__info.continent};
-
-    for (const auto &host : constants::AVAILABLE_HOSTS)
-    {
-        const auto &content{ node.cont.at(host) };
-
-        if (content.is_parsed)
-        {
-            return {
-                .is_parsed{ true },
-                .val{ content.val },
-                .host{ host },
-                .desc{ node.desc }
-            };
-        }
-    }
-
-    return {
-        .desc{ node.desc }
-    };
+    return __get_node_ex(__info.continent, constants::INFO_FIELDS_IDS::CONTINENT);
 }
 
 ipinfo::usr::types::node<std::string>
 ipinfo::usr::informer::get_continent_code_ex() const
 {
-    const auto &node{ __info.continent_code };
-
-    for (const auto &host : constants::AVAILABLE_HOSTS)
-    {
-        const auto &content{ node.cont.at(host) };
-
-        if (content.is_parsed)
-        {
-            return {
-                .is_parsed{ true },
-                .val{ content.val },
-                .host{ host },
-                .desc{ node.desc }
-            };
-        }
-    }
-
-    return {
-        .desc{ node.desc }
-    };
+    return __get_node_ex(__info.continent_code, constants::INFO_FIELDS_IDS::CONTINENT_CODE);
 }
 
 ipinfo::usr::types::node<std::string>
 ipinfo::usr::informer::get_country_ex() const
 {
-    const auto &node{ __info.country_code };
-
-    for (const auto &host : constants::AVAILABLE_HOSTS)
-    {
-        const auto &content{ node.cont.at(host) };
-
-        if (content.is_parsed)
-        {
-            return {
-                .is_parsed{ true },
-                .val{ content.val },
-                .host{ host },
-                .desc{ node.desc }
-            };
-        }
-    }
-
-    return {
-        .desc{ node.desc }
-    };
+    return __get_node_ex(__info.country_code, constants::INFO_FIELDS_IDS::COUNTRY_CODE);
 }
 
 ipinfo::usr::types::node<std::string>
 ipinfo::usr::informer::get_country_code_ex() const
 {
-    const auto &node{ __info.country_code };
-
-    for (const auto &host : constants::AVAILABLE_HOSTS)
-    {
-        const auto &content{ node.cont.at(host) };
-
-        if (content.is_parsed)
-        {
-            return {
-                .is_parsed{ true },
-                .val{ content.val },
-                .host{ host },
-                .desc{ node.desc }
-            };
-        }
-    }
-
-    return {
-        .desc{ node.desc }
-    };
+    return __get_node_ex(__info.country_code, constants::INFO_FIELDS_IDS::COUNTRY_CODE);
 }
 
 ipinfo::usr::types::node<std::string>
 ipinfo::usr::informer::get_country_capital_ex() const
 {
-    const auto &node{ __info.country_capital };
-
-    for (const auto &host : constants::AVAILABLE_HOSTS)
-    {
-        const auto &content{ node.cont.at(host) };
-
-        if (content.is_parsed)
-        {
-            return {
-                .is_parsed{ true },
-                .val{ content.val },
-                .host{ host },
-                .desc{ node.desc }
-            };
-        }
-    }
-
-    return {
-        .desc{ node.desc }
-    };
+    return __get_node_ex(__info.country_capital, constants::INFO_FIELDS_IDS::COUNTRY_CAPITAL);
 }
 
 ipinfo::usr::types::node<std::string>
 ipinfo::usr::informer::get_country_ph_code_ex() const
 {
-    const auto &node{ __info.country_ph_code };
-
-    for (const auto &host : constants::AVAILABLE_HOSTS)
-    {
-        const auto &content{ node.cont.at(host) };
-
-        if (content.is_parsed)
-        {
-            return {
-                .is_parsed{ true },
-                .val{ content.val },
-                .host{ host },
-                .desc{ node.desc }
-            };
-        }
-    }
-
-    return {
-        .desc{ node.desc }
-    };
+    return __get_node_ex(__info.country_ph_code, constants::INFO_FIELDS_IDS::COUNTRY_PH_CODE);
 }
 
 ipinfo::usr::types::node<std::string>
 ipinfo::usr::informer::get_country_neighbors_ex() const
 {
-    const auto &node{ __info.country_neighbors };
-
-    for (const auto &host : constants::AVAILABLE_HOSTS)
-    {
-        const auto &content{ node.cont.at(host) };
-
-        if (content.is_parsed)
-        {
-            return {
-                .is_parsed{ true },
-                .val{ content.val },
-                .host{ host },
-                .desc{ node.desc }
-            };
-        }
-    }
-
-    return {
-        .desc{ node.desc }
-    };
+    return __get_node_ex(__info.country_neighbors, constants::INFO_FIELDS_IDS::COUNTRY_NEIGHBORS);
 }
 
 ipinfo::usr::types::node<std::string>
 ipinfo::usr::informer::get_region_ex() const
 {
-    const auto &node{ __info.region };
-
-    for (const auto &host : constants::AVAILABLE_HOSTS)
-    {
-        const auto &content{ node.cont.at(host) };
-
-        if (content.is_parsed)
-        {
-            return {
-                .is_parsed{ true },
-                .val{ content.val },
-                .host{ host },
-                .desc{ node.desc }
-            };
-        }
-    }
-
-    return {
-        .desc{ node.desc }
-    };
+    return __get_node_ex(__info.region, constants::INFO_FIELDS_IDS::REGION);
 }
 
 ipinfo::usr::types::node<std::string>
 ipinfo::usr::informer::get_region_code_ex() const
 {
-    const auto &node{ __info.region_code };
-
-    for (const auto &host : constants::AVAILABLE_HOSTS)
-    {
-        const auto &content{ node.cont.at(host) };
-
-        if (content.is_parsed)
-        {
-            return {
-                .is_parsed{ true },
-                .val{ content.val },
-                .host{ host },
-                .desc{ node.desc }
-            };
-        }
-    }
-
-    return {
-        .desc{ node.desc }
-    };
+    return __get_node_ex(__info.region_code, constants::INFO_FIELDS_IDS::REGION_CODE);
 }
 
 ipinfo::usr::types::node<std::string>
-ipinfo::usr::informer::get_city_ex() const
-{
-    const auto &node{ __info.city };
-
-    for (const auto &host : constants::AVAILABLE_HOSTS)
-    {
-        const auto &content{ node.cont.at(host) };
-
-        if (content.is_parsed)
-        {
-            return {
-                .is_parsed{ true },
-                .val{ content.val },
-                .host{ host },
-                .desc{ node.desc }
-            };
-        }
-    }
-
-    return {
-        .desc{ node.desc }
-    };
+ipinfo::usr::informer::get_city_ex() const
+{
+    return __get_node_ex(__info.city, constants::INFO_FIELDS_IDS::CITY);
 }
 
 
 ipinfo::usr::types::node<std::string>
 ipinfo::usr::informer::get_city_district_ex() const
 {
-    const auto &node{ __info.city_district };
-
-    for (const auto &host : constants::AVAILABLE_HOSTS)
-    {
-        const auto &content{ node.cont.at(host) };
-
-        if (content.is_parsed)
-        {
-            return {
-                .is_parsed{ true },
-                .val{ content.val },
-                .host{ host },
-                .desc{ node.desc }
-            };
-        }
-    }
-
-    return {
-        .desc{ node.desc }
-    };
+    return __get_node_ex(__info.city_district, constants::INFO_FIELDS_IDS::CITY_DISTRICT);
 }
 
 ipinfo::usr::types::node<std::string>
 ipinfo::usr::informer::get_zip_code_ex() const
 {
-    const auto &node{ __info.zip_code };
-
-    for (const auto &host : constants::AVAILABLE_HOSTS)
-    {
-        const auto &content{ node.cont.at(host) };
-
-        if (content.is_parsed)
-        {
-            return {
-                .is_parsed{ true },
-                .val{ content.val },
-                .host{ host },
-                .desc{ node.desc }
-            };
-        }
-    }
-
-    return {
-        .desc{ node.desc }
-    };
+    return __get_node_ex(__info.zip_code, constants::INFO_FIELDS_IDS::ZIP_CODE);
 }
 
 ipinfo::usr::types::node<double>
 ipinfo::usr::informer::get_latitude_ex() const
 {
-    const auto &node{ __info.latitude };
-
-    for (const auto &host : constants::AVAILABLE_HOSTS)
-    {
-        const auto &content{ node.cont.at(host) };
-
-        if (content.is_parsed)
-        {
-            return {
-                .is_parsed{ true },
-                .val{ __utiler->round_val(content.val, 2u) },
-                .host{ host },
-                .desc{ node.desc }
-            };
-        }
-    }
-
-    return {
-        .desc{ node.desc }
-    };
+    return __get_node_ex(__info.latitude, constants::INFO_FIELDS_IDS::LATITUDE);
 }
 
 ipinfo::usr::types::node<double>
 ipinfo::usr::informer::get_longitude_ex() const
 {
-    const auto &node{ __info.longitude };
-
-    for (const auto &host : constants::AVAILABLE_HOSTS)
-    {
-        const auto &content{ node.cont.at(host) };
-
-        if (content.is_parsed)
-        {
-            return {
-                .is_parsed{ true },
-                .val{ __utiler->round_val(content.val, 2u) },
-                .host{ host },
-                .desc{ node.desc }
-            };
-        }
-    }
-
-    return {
-        .desc{ node.desc }
-    };
+    return __get_node_ex(__info.longitude, constants::INFO_FIELDS_IDS::LONGITUDE);
 }
 
 ipinfo::usr::types::node<std::string>
-ipi::usr::informer::get_timezone_ex() const
+ipinfo::usr::informer::get_timezone_ex() const
 {
-    const auto &node{__info.timezone};
-    const auto &avl_hosts{ipinfo::constants::AVAILABLE_HOSTS};
-
-    for (const auto &host : avl_hosts)
-    {
-        const auto &content{node.cont.at(host)};
-
-        if (content.is_parsed)
-        {
-            return {
-                .is_parsed{ true },
-                .val{ content.val },
-                .host{ host },
-                .desc{ node.desc }
-            };
-        }
-    }
-
-    return {
-        .desc{ node.desc }
-    };
+    return __get_node_ex(__info.timezone, constants::INFO_FIELDS_IDS::TIMEZONE);
 }
 
 ipinfo::usr::types::node<std::string>
-ipi::usr::informer::get_city_timezone_ex() const
+ipinfo::usr::informer::get_city_timezone_ex() const
 {
-    const auto &node{__info.city_timezone};
-    const auto &avl_hosts{ipinfo::constants::AVAILABLE_HOSTS};
-
-    for (const auto &host : avl_hosts)
-    {
-        const auto &content{node.cont.at(host)};
-
-        if (content.is_parsed)
-        {
-            return {
-                .is_parsed{ true },
-                .val{ content.val },
-                .host{ host },
-                .desc{ node.desc }
-            };
-        }
-    }
-
-    return {
-        .desc{ node.desc }
-    };
+    return __get_node_ex(__info.city_timezone, constants::INFO_FIELDS_IDS::CITY_TIMEZONE);
 }
 
 ipinfo::usr::types::node<std::string>
-ipi::usr::informer::get_timezone_gmt_ex() const
+ipinfo::usr::informer::get_timezone_gmt_ex() const
 {
-    const auto &node{__info.timezone_gmt};
-    const auto &avl_hosts{ipinfo::constants::AVAILABLE_HOSTS};
-
-    for (const auto &host : avl_hosts)
-    {
-        const auto &content{node.cont.at(host)};
-
-        if (content.is_parsed)
-        {
-            return {
-                .is_parsed{ true },
-                .val{ content.val },
-                .host{ host },
-                .desc{ node.desc }
-            };
-        }
-    }
-
-    return {
-        .desc{ node.desc }
-    };
+    return __get_node_ex(__info.timezone_gmt, constants::INFO_FIELDS_IDS::TIMEZONE_GMT);
 }
 
 ipinfo::usr::types::node<std::int32_t>
-ipi::usr::informer::get_gmt_offset_ex() const
+ipinfo::usr::informer::get_gmt_offset_ex() const
 {
-    const auto &node{__info.gmt_offset};
-    const auto &avl_hosts{ipinfo::constants::AVAILABLE_HOSTS};
-
-    for (const auto &host : avl_hosts)
-    {
-        const auto &content{node.cont.at(host)};
-
-        if (content.is_parsed)
-        {
-            return {
-                .is_parsed{ true },
-                .val = content.val,
-                .host{ host },
-                .desc{ node.desc }
-            };
-        }
-    }
-
-    return {
-        .desc{ node.desc }
-    };
+    return __get_node_ex(__info.gmt_offset, constants::INFO_FIELDS_IDS::GMT_OFFSET);
 }
 
 ipinfo::usr::types::node<std::int32_t>
 ipinfo::usr::informer::get_dst_offset_ex() const
 {
-    const auto &node{ __info.dst_offset };
-
-    for (const auto &host : constants::AVAILABLE_HOSTS)
-    {
-        const auto &content{ node.cont.at(host) };
-
-        if (content.is_parsed)
-        {
-            return {
-                .is_parsed{ true },
-                .val{ content.val },
-                .host{ host },
-                .desc{ node.desc }
-            };
-        }
-    }
-
-    return {
-        .desc{ node.desc }
-    };
+    return __get_node_ex(__info.dst_offset, constants::INFO_FIELDS_IDS::DST_OFFSET);
 }
 
 ipinfo::usr::types::node<std::string>
 ipinfo::usr::informer::get_isp_ex() const
 {
-    const auto &node{ __info.isp };
-
-    for (const auto &host : constants::AVAILABLE_HOSTS)
-    {
-        const auto &content{ node.cont.at(host) };
-
-        if (content.is_parsed)
-        {
-            return {
-                .is_parsed{ true },
-                .val{ content.val },
-                .host{ host },
-                .desc{ node.desc }
-            };
-        }
-    }
-
-    return {
-        .desc{ node.desc }
-    };
+    return __get_node_ex(__info.isp, constants::INFO_FIELDS_IDS::ISP);
 }
 
 ipinfo::usr::types::node<std::string>
 ipinfo::usr::informer::get_as_ex() const
 {
-    const auto &node{ __info.as };
-
-    for (const auto &host : constants::AVAILABLE_HOSTS)
-    {
-        const auto &content{ node.cont.at(host) };
-
-        if (content.is_parsed)
-        {
-            return {
-                .is_parsed{ true },
-                .val{ content.val },
-                .host{ host },
-                .desc{ node.desc }
-            };
-        }
-    }
-
-    return {
-        .desc{ node.desc }
-    };
+    return __get_node_ex(__info.as, constants::INFO_FIELDS_IDS::AS);
 }
 
 ipinfo::usr::types::node<std::string>
 ipinfo::usr::informer::get_org_ex() const
 {
-    const auto &node{ __info.org };
-
-    for (const std::string &host : constants::AVAILABLE_HOSTS)
-    {
-        const auto &content{ node.cont.at(host) };
-
-        if (content.is_parsed)
-        {
-            return {
-                .is_parsed{ true },
-                .val{ content.val },
-                .host{ host },
-                .desc{ node.desc }
-            };
-        }
-    }
-
-    return {
-        .desc{ node.desc }
-    };
+    return __get_node_ex(__info.org, constants::INFO_FIELDS_IDS::ORG);
 }
 
 ipinfo::usr::types::node<std::string>
 ipinfo::usr::informer::get_reverse_dns_ex() const
 {
-    const auto &node{__info.reverse_dns};
-
-    for (const std::string &host : constants::AVAILABLE_HOSTS)
-    {
-        const auto &content{ node.cont.at(host) };
-
-        if (content.is_parsed)
-        {
-            return {
-                .is_parsed{ true },
-                .val{ content.val },
-                .host{ host },
-                .desc{ node.desc }
-            };
-        }
-    }
-
-    return {
-        .desc{ node.desc }
-    };
+    return __get_node_ex(__info.reverse_dns, constants::INFO_FIELDS_IDS::REVERSE_DNS);
 }
 
 ipinfo::usr::types::node<bool>
 ipinfo::usr::informer::get_hosting_status_ex() const
 {
-    const auto &node{ __info.is_hosting };
-
-    for (const std::string &host : constants::AVAILABLE_HOSTS)
-    {
-        const auto &content{ node.cont.at(host) };
-
-        if (content.is_parsed)
-        {
-            return {
-                .is_parsed{ true },
-                .val{ content.val },
-                .host{ host },
-                .desc{ node.desc }
-            };
-        }
-    }
-
-    return {
-        .desc{ node.desc }
-    };
+    return __get_node_ex(__info.is_hosting, constants::INFO_FIELDS_IDS::IS_HOSTING);
 }
 
 ipinfo::usr::types::node<bool>
 ipinfo::usr::informer::get_proxy_status_ex() const
 {
-    const auto &node{ __info.is_proxy };
-
-    for (const std::string &host : constants::AVAILABLE_HOSTS)
-    {
-        const auto &content{ node.cont.at(host) };
-
-        if (content.is_parsed)
-        {
-            return {
-                .is_parsed{ true },
-                .val{ content.val },
-                .host{ host },
-                .desc{ node.desc }
-            };
-        }
-    }
-
-    return {
-        .desc{ node.desc }
-    };
+    return __get_node_ex(__info.is_proxy, constants::INFO_FIELDS_IDS::IS_PROXY);
 }
 
 ipinfo::usr::types::node<bool>
 ipinfo::usr::informer::get_mobile_status_ex() const
 {
-    const auto &node{ __info.is_mobile };
-
-    for (const std::string &host : constants::AVAILABLE_HOSTS)
-    {
-        const auto &content{ node.cont.at(host) };
-
-        if (content.is_parsed)
-        {
-            return {
-                .is_parsed{ true },
-                .val{ content.val },
-                .host{ host },
-                .desc{ node.desc }
-            };
-        }
-    }
-
-    return {
-        .desc{ node.desc }
-    };
+    return __get_node_ex(__info.is_mobile, constants::INFO_FIELDS_IDS::IS_MOBILE);
 }
 
 ipinfo::usr::types::node<std::string>
 ipinfo::usr::informer::get_currency_ex() const
 {
-    const auto &node{ __info.currency };
-
-    for (const std::string &host : constants::AVAILABLE_HOSTS)
-    {
-        const auto &content{ node.cont.at(host) };
-
-        if (content.is_parsed)
-        {
-            return {
-                .is_parsed{ true },
-                .val{ content.val },
-                .host{ host },
-                .desc{ node.desc }
-            };
-        }
-    }
-
-    return {
-        .desc{ node.desc }
-    };
+    return __get_node_ex(__info.currency, constants::INFO_FIELDS_IDS::CURRENCY);
 }
 
 ipinfo::usr::types::node<std::string>
 ipinfo::usr::informer::get_currency_code_ex() const
 {
-    const auto &node{ __info.currency_code };
-
-    for (const std::string &host : constants::AVAILABLE_HOSTS)
-    {
-        const auto &content{ node.cont.at(host) };
-
-        if (content.is_parsed)
-        {
-            return {
-                .is_parsed{ true },
-                .val{ content.val },
-                .host{ host },
-                .desc{ node.desc }
-            };
-        }
-    }
-
-    return {
-        .desc{ node.desc }
-    };
+    return __get_node_ex(__info.currency_code, constants::INFO_FIELDS_IDS::CURRENCY_CODE);
 }
 
 ipinfo::usr::types::node<std::string>
 ipinfo::usr::informer::get_currency_symbol_ex() const
 {
-    const auto &node{ __info.currency_symbol };
-
-    for (const std::string &host : constants::AVAILABLE_HOSTS)
-    {
-        const auto &content{ node.cont.at(host) };
-
-        if (content.is_parsed)
-        {
-            return {
-                .is_parsed{ true },
-                .val{ content.val },
-                .host{ host },
-                .desc{ node.desc }
-            };
-        }
-    }
-
-    return {
-        .desc{ node.desc }
-    };
+    return __get_node_ex(__info.currency_symbol, constants::INFO_FIELDS_IDS::CURRENCY_SYMBOL);
 }
 
 ipinfo::usr::types::node<double>
 ipinfo::usr::informer::get_currency_rates_ex() const
 {
-    const auto &node{ __info.currency_rates };
-
-    for (const std::string &host : constants::AVAILABLE_HOSTS)
-    {
-        const auto &content{ node.cont.at(host) };
-
-        if (content.is_parsed)
-        {
-            return {
-                .is_parsed{ true },
-                .val{ content.val },
-                .host{ host },
-                .desc{ node.desc }
-            };
-        }
-    }
-
-    return {
-        .desc{ node.desc }
-    };
+    return __get_node_ex(__info.currency_rates, constants::INFO_FIELDS_IDS::CURRENCY_RATES);
 }
 
 ipinfo::usr::types::node<std::string>
 ipinfo::usr::informer::get_currency_plural_ex() const
 {
-    const auto &node{ __info.currency_plural };
-
-    for (const std::string &host : constants::AVAILABLE_HOSTS)
-    {
-        const auto &content{ node.cont.at(host) };
-
-        if (content.is_parsed)
-        {
-            return {
-                .is_parsed{ true },
-                .val{ content.val },
-                .host{ host },
-                .desc{ node.desc }
-            };
-        }
-    }
+    return __get_node_ex(__info.currency_plural, constants::INFO_FIELDS_IDS::CURRENCY_PLURAL);
+}
 
-    return {
-        .desc{ node.desc }
-    };
+ipinfo::usr::types::node<bool>
+ipinfo::usr::informer::get_reserved_status_ex() const
+{
+    return __get_node_ex(__info.is_reserved, constants::INFO_FIELDS_IDS::IS_RESERVED);
 }
@@ -0,0 +1,522 @@
+#include "../../include/ipinfo/ipinfo_types.hpp"
+#include "../../include/ipinfo/ipinfo_constants.hpp"
+#include "../../include/ipinfo/ipinfo_aliases.hpp"
+
+#include "../../include/ipinfo/ipinfo_loop.hpp"
+#include "../../include/ipinfo/ipinfo_informer.hpp"
+#include "../../include/ipinfo/ipinfo_requester.hpp"
+#include "../../include/ipinfo/ipinfo_utiler.hpp"
+#include "../../include/ipinfo/ipinfo_scheduler.hpp"
+#include "../../include/ipinfo/ipinfo_tracker.hpp"
+#include "../../include/ipinfo/ipinfo_breaker.hpp"
+#include "../../include/ipinfo/ipinfo_cache.hpp"
+
+#include <curl/curl.h>
+
+#include <algorithm> // std::min, std::equal
+#include <cctype>    // std::tolower
+#include <chrono>
+#include <cstddef>   // std::size_t
+#include <memory>    // std::shared_ptr, std::unique_ptr
+#include <mutex>     // std::lock_guard
+#include <string>
+#include <utility>   // std::move, std::swap
+#include <vector>
+
+ipinfo::srv::loop::loop(const std::size_t max_host_requests)
+{
+    // The first call isn't thread-safe in old libcurl
+    // versions, function-local static makes it once.
+
+    static const ::CURLcode global_init {
+        ::curl_global_init(CURL_GLOBAL_DEFAULT)
+    };
+
+    (void)global_init;
+
+    __multi = ::curl_multi_init();
+
+    // Transfers over the limit are queued inside
+    // libcurl until a connection to the host is free.
+
+    ::curl_multi_setopt(__multi, CURLMOPT_MAX_HOST_CONNECTIONS,
+        static_cast<long>(max_host_requests));
+
+    __worker = std::thread{ &loop::__run, this };
+}
+
+ipinfo::srv::loop::~loop()
+{
+    __is_stopped = true;
+    ::curl_multi_wakeup(__multi);
+
+    if (__worker.joinable())
+    {
+        __worker.join();
+    }
+
+    for (::CURL * const easy : __idle_easies)
+    {
+        ::curl_easy_cleanup(easy);
+    }
+
+    ::curl_multi_cleanup(__multi);
+}
+
+std::size_t
+ipinfo::srv::loop::__write(
+    char *data,
+    std::size_t size,
+    std::size_t n,
+    void *answ)
+{
+    static_cast<std::string *>(answ)->append(data, size * n);
+    return size * n;
+}
+
+std::size_t
+ipinfo::srv::loop::__read_header(
+    char *data,
+    std::size_t size,
+    std::size_t n,
+    void *trns)
+{
+    const std::string line{ data, size * n };
+    const auto colon{ line.find(':') };
+
+    if (std::string::npos == colon)
+    {
+        return size * n;
+    }
+
+    const auto is_named {
+        [&line, colon](const std::string &name) -> bool {
+            return (name.size() == colon) and std::equal(
+                name.begin(), name.end(), line.begin(),
+                [](const char a, const char b) -> bool {
+                    return std::tolower(a) == std::tolower(b);
+                });
+        }
+    };
+
+    const auto first{ line.find_first_not_of(" \t", colon + 1u) };
+    const auto last{ line.find_last_not_of(" \t\r\n") };
+
+    const std::string val {
+        (std::string::npos == first or last < first) ?
+            std::string{} : line.substr(first, last - first + 1u)
+    };
+
+    auto * const t{ static_cast<__transfer *>(trns) };
+
+    if (is_named(constants::RATE_LIMIT_REMAINING_HEADER))
+    {
+        t->remaining = val;
+    }
+
+    if (is_named(constants::RATE_LIMIT_RESET_HEADER))
+    {
+        t->reset_in = val;
+    }
+
+    return size * n;
+}
+
+::CURL *
+ipinfo::srv::loop::__acquire_easy()
+{
+    if (__idle_easies.empty())
+    {
+        return ::curl_easy_init();
+    }
+
+    ::CURL * const easy{ __idle_easies.back() };
+    __idle_easies.pop_back();
+
+    return easy;
+}
+
+void
+ipinfo::srv::loop::__release_easy(::CURL *easy)
+{
+    ::curl_easy_reset(easy);
+    __idle_easies.push_back(easy);
+}
+
+void
+ipinfo::srv::loop::__start(const std::shared_ptr<__lookup> &lkp)
+{
+    const std::vector<std::string> hosts{ lkp->infr.__get_active_hosts() };
+
+    srv::utiler{}.clear_info(lkp->infr.__info);
+    lkp->infr.__errors.clear();
+    lkp->infr.__deadline = lkp->deadline;
+
+    usr::informer &infr{ lkp->infr };
+    const std::uint8_t hosts_mask{ usr::informer::__get_hosts_mask(hosts) };
+
+    if (infr.__run_locally())
+    {
+        __complete(*lkp);
+        return;
+    }
+
+    bool is_stale{ false };
+
+    if (infr.__cache and
+        infr.__cache->__find(infr.__ip, infr.__lang, hosts_mask, infr.__info, infr.__errors, is_stale))
+    {
+        if (is_stale)
+        {
+            infr.__cache->__refresh(infr, hosts_mask);
+        }
+
+        __complete(*lkp);
+        return;
+    }
+
+    lkp->hosts_mask = hosts_mask;
+
+    if (hosts.empty())
+    {
+        __complete(*lkp);
+        return;
+    }
+
+    lkp->pending = hosts.size();
+
+    for (const std::string &host : hosts)
+    {
+        __start_transfer(lkp, host);
+    }
+}
+
+void
+ipinfo::srv::loop::__start_transfer(
+    const std::shared_ptr<__lookup> &lkp,
+    const std::string &host)
+{
+    // The loop mustn't be blocked while a host's bucket is
+    // empty, thus the request is deferred until a token.
+
+    using clock = std::chrono::steady_clock;
+    clock::duration wait{};
+
+    if (clock::now() >= lkp->deadline)
+    {
+        lkp->infr.__set_timeout_error(host);
+        __settle(*lkp);
+
+        return;
+    }
+
+    // The breaker is asked first, so a token isn't spent on a
+    // request which isn't sent: tokens count against the quota.
+
+    auto &brkr{ srv::breaker::instance() };
+
+    if (not brkr.allow(host))
+    {
+        lkp->infr.__errors[host] = {
+            .code{ constants::ERRORS_IDS::UNAVAILABLE_HOST },
+            .desc{ "The host is failing, it's skipped until the cooldown" }
+        };
+
+        __settle(*lkp);
+        return;
+    }
+
+    if (not srv::scheduler::instance().try_acquire(host, wait))
+    {
+        // a probe slot isn't held while the request waits
+        brkr.on_abort(host);
+
+        __deferreds.push_back({
+            .lookup{ lkp },
+            .host{ host },
+            .ready_at{ std::min(clock::now() + wait, lkp->deadline) }
+        });
+
+        return;
+    }
+
+    const srv::requester rqstr{};
+    auto trns{ std::make_unique<__transfer>() };
+    const std::string url{ rqstr.get_url(lkp->infr.__get_request_attributes(host)) };
+
+    trns->lookup = lkp;
+    trns->host = host;
+    trns->easy = __acquire_easy();
+
+    ::curl_easy_setopt(trns->easy, CURLOPT_URL, url.c_str());
+    ::curl_easy_setopt(trns->easy, CURLOPT_NOSIGNAL, 1L);
+    ::curl_easy_setopt(trns->easy, CURLOPT_ACCEPT_ENCODING, "");
+    ::curl_easy_setopt(trns->easy, CURLOPT_WRITEFUNCTION, &loop::__write);
+    ::curl_easy_setopt(trns->easy, CURLOPT_WRITEDATA, &trns->answ);
+    ::curl_easy_setopt(trns->easy, CURLOPT_HEADERFUNCTION, &loop::__read_header);
+    ::curl_easy_setopt(trns->easy, CURLOPT_HEADERDATA, trns.get());
+    ::curl_easy_setopt(trns->easy, CURLOPT_PRIVATE, trns.get());
+
+    if (clock::time_point::max() != lkp->deadline)
+    {
+        const auto time_left {
+            std::chrono::duration_cast<std::chrono::milliseconds>(
+                lkp->deadline - clock::now())
+        };
+
+        ::curl_easy_setopt(trns->easy, CURLOPT_TIMEOUT_MS,
+            static_cast<long>(std::max<std::chrono::milliseconds::rep>(time_left.count(), 1)));
+    }
+
+    ::curl_multi_add_handle(__multi, trns->easy);
+    __easies.insert(trns->easy);
+
+    // The transfer is owned by its easy handle from now,
+    // it's deleted when the handle finishes.
+
+    (void)trns.release();
+}
+
+std::chrono::milliseconds
+ipinfo::srv::loop::__start_deferreds()
+{
+    using namespace std::chrono;
+
+    milliseconds timeout{ 1000 };
+    std::vector<__deferred> deferreds{};
+
+    std::swap(deferreds, __deferreds);
+    const steady_clock::time_point now{ steady_clock::now() };
+
+    for (const __deferred &dfrd : deferreds)
+    {
+        if (dfrd.ready_at > now)
+        {
+            timeout = std::min(timeout,
+                duration_cast<milliseconds>(dfrd.ready_at - now) + milliseconds{ 1 });
+
+            __deferreds.push_back(dfrd);
+            continue;
+        }
+
+        // it may be deferred again, if another
+        // request has taken the token
+        __start_transfer(dfrd.lookup, dfrd.host);
+    }
+
+    return timeout;
+}
+
+void
+ipinfo::srv::loop::__start_queued()
+{
+    std::vector<std::shared_ptr<__lookup>> queue{};
+
+    {
+        const std::lock_guard<std::mutex> lock{ __mtx };
+        std::swap(queue, __queue);
+    }
+
+    for (const auto &lkp : queue)
+    {
+        __start(lkp);
+    }
+}
+
+void
+ipinfo::srv::loop::__finish(::CURL *easy, const ::CURLcode result)
+{
+    __transfer *raw_trns{};
+
+    ::curl_easy_getinfo(easy, CURLINFO_PRIVATE, &raw_trns);
+    const std::unique_ptr<__transfer> trns{ raw_trns };
+
+    long status_code{ 0 };
+    ::curl_easy_getinfo(easy, CURLINFO_RESPONSE_CODE, &status_code);
+
+    ::curl_off_t total_time{ 0 }; // us
+    ::curl_easy_getinfo(easy, CURLINFO_TOTAL_TIME_T, &total_time);
+
+    ::curl_multi_remove_handle(__multi, easy);
+    __easies.erase(easy);
+    __release_easy(easy);
+
+    auto &schdlr{ srv::scheduler::instance() };
+
+    if (429 == status_code)
+    {
+        schdlr.throttle(trns->host, trns->reset_in);
+    }
+    else
+    {
+        schdlr.update(trns->host, trns->remaining, trns->reset_in);
+    }
+
+    __lookup &lkp{ *trns->lookup };
+    usr::informer &infr{ lkp.infr };
+
+    // Transfers which are aborted by the loop's
+    // stop say nothing about the host's health.
+
+    if (CURLE_ABORTED_BY_CALLBACK == result)
+    {
+        srv::breaker::instance().on_abort(trns->host);
+    }
+    else if (CURLE_OK != result or 500 <= status_code)
+    {
+        srv::breaker::instance().on_failure(trns->host);
+    }
+    else
+    {
+        srv::breaker::instance().on_success(trns->host);
+    }
+
+    if (CURLE_OPERATION_TIMEDOUT == result)
+    {
+        infr.__set_timeout_error(trns->host);
+    }
+    else if (CURLE_OK != result)
+    {
+        infr.__errors[trns->host] = {
+            .code{ constants::ERRORS_IDS::FAILED_REQUEST },
+            .desc{ ::curl_easy_strerror(result) }
+        };
+    }
+    else if (429 == status_code)
+    {
+        infr.__errors[trns->host] = {
+            .code{ constants::ERRORS_IDS::THROTTLED_REQUEST },
+            .desc{ "Response status code is 429" }
+        };
+    }
+    else if (200 != status_code)
+    {
+        infr.__errors[trns->host] = {
+            .code{ constants::ERRORS_IDS::UNSUCCESSFULL_RESPONSE_STATUS_CODE },
+            .desc{ "Response status code is " + std::to_string(status_code) }
+        };
+    }
+    else if (trns->answ.empty())
+    {
+        infr.__errors[trns->host] = {
+            .code{ constants::ERRORS_IDS::EMPTY_REQUEST_ANSWER },
+            .desc{ "Empty answer to the request" }
+        };
+    }
+    else
+    {
+        srv::tracker::instance().add_sample(trns->host,
+            std::chrono::milliseconds{ total_time / 1000 });
+
+        infr.__parse(trns->answ, trns->host);
+    }
+
+    __settle(lkp);
+}
+
+void
+ipinfo::srv::loop::__settle(__lookup &lkp)
+{
+    lkp.pending -= 1u;
+
+    if (0u == lkp.pending)
+    {
+        __complete(lkp);
+    }
+}
+
+void
+ipinfo::srv::loop::__complete(__lookup &lkp)
+{
+    const auto &infr{ lkp.infr };
+
+    if (infr.__cache and 0u != lkp.hosts_mask)
+    {
+        infr.__cache->__insert(infr.__ip, infr.__lang, lkp.hosts_mask, infr.__info, infr.__errors);
+    }
+
+    if (lkp.cb)
+    {
+        lkp.cb(std::move(lkp.infr));
+    }
+}
+
+void
+ipinfo::srv::loop::__run()
+{
+    int running{ 0 };
+
+    while (not __is_stopped)
+    {
+        __start_queued();
+        const std::chrono::milliseconds timeout{ __start_deferreds() };
+
+        ::curl_multi_perform(__multi, &running);
+
+        int left{ 0 };
+        const ::CURLMsg *msg{};
+
+        while ((msg = ::curl_multi_info_read(__multi, &left)))
+        {
+            if (CURLMSG_DONE == msg->msg)
+            {
+                __finish(msg->easy_handle, msg->data.result);
+            }
+        }
+
+        ::curl_multi_poll(__multi, nullptr, 0u,
+            static_cast<int>(timeout.count()), nullptr);
+    }
+
+    // Lookups which are still in flight are completed with
+    // the data which has been parsed by now, queued ones are
+    // completed empty. Thus no callback is lost.
+
+    while (not __easies.empty())
+    {
+        __finish(*__easies.begin(), CURLE_ABORTED_BY_CALLBACK);
+    }
+
+    std::vector<__deferred> deferreds{};
+    std::swap(deferreds, __deferreds);
+
+    for (const __deferred &dfrd : deferreds)
+    {
+        dfrd.lookup->infr.__set_timeout_error(dfrd.host);
+        __settle(*dfrd.lookup);
+    }
+
+    std::vector<std::shared_ptr<__lookup>> queue{};
+
+    {
+        const std::lock_guard<std::mutex> lock{ __mtx };
+        std::swap(queue, __queue);
+    }
+
+    for (const auto &lkp : queue)
+    {
+        __complete(*lkp);
+    }
+}
+
+void
+ipinfo::srv::loop::submit(
+    const usr::informer &infr,
+    const std::chrono::steady_clock::time_point &deadline,
+    callback cb)
+{
+    auto lkp {
+        std::make_shared<__lookup>(__lookup{
+            .infr{ infr },
+            .cb{ std::move(cb) },
+            .deadline{ deadline }
+        })
+    };
+
+    {
+        const std::lock_guard<std::mutex> lock{ __mtx };
+        __queue.push_back(std::move(lkp));
+    }
+
+    ::curl_multi_wakeup(__multi);
+}
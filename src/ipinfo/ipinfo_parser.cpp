@@ -1,162 +1,182 @@
 #include "../../include/ipinfo/ipinfo_types.hpp"
 #include "../../include/ipinfo/ipinfo_parser.hpp"
 #include "../../include/ipinfo/ipinfo_utiler.hpp"
+#include "../../include/ipinfo/ipinfo_fields.hpp"
 
 #include <string>
 #include <cstdint>
+#include <cstddef>
+#include <vector>
 
 #include <cjson/cJSON.h>
 
 ::cJSON *
 ipinfo::srv::parser::__prepare(const std::string &json)
 {
+    if (json.empty())
+    {
+        __error = {
+            .code{ constants::ERRORS_IDS::EMPTY_JSON_STRING },
+            .desc{ "JSON string is empty" }
+        };
+
+        return nullptr;
+    }
+
     ::cJSON * const data{ ::cJSON_Parse(json.c_str()) };
 
     if (not data)
     {
-        std::string error_location{ "unknown" };
+        // the error's location is in the json, if cJSON knows it
         const char * const json_error{ ::cJSON_GetErrorPtr() };
 
-        // If we couldn't get an information about parsing error.
-
-        if (not json_error or std::string{ json_error }.empty())
-        {
-            // if an execution is in this block, 'data' is
-            // nullptr, thus we can return nullptr directly
-
-            return nullptr;
-        }
-
-        error_location = json_error;
+        __error = {
+            .code{ constants::ERRORS_IDS::FAILED_JSON_PARSING },
+            .desc {
+                json_error ?
+                    "Failed to parse JSON at position " + std::to_string(json_error - json.c_str()) :
+                    "Failed to parse JSON"
+            }
+        };
     }
 
     return data;
 }
 
-template<template<typename ...> class T> void
+template<template<typename ...> class T> bool
 ipinfo::srv::parser::__fill_node(
     T<std::string> &node,
     const ::cJSON &item,
-    const std::string &host)
+    const std::uint8_t host_id)
 {
-    if (::cJSON_IsString(&item))
+    if (not ::cJSON_IsString(&item))
     {
-        auto &content{ node.cont.at(host) };
-        const char * const val{ item.valuestring };
+        return false;
+    }
 
-        if (not val or std::string{ val }.empty())
-        {
-            content.is_parsed = false;
-            return;
-        }
+    const char * const val{ item.valuestring };
 
-        content.val = val;
-        content.is_parsed = true;
+    if (not val or '\0' == *val)
+    {
+        return false;
     }
+
+    node.cont[host_id] = val;
+    return true;
 }
 
-template<template<typename ...> class T> void
+template<template<typename ...> class T> bool
 ipinfo::srv::parser::__fill_node(
     T<std::int32_t> &node,
     const ::cJSON &item,
-    const std::string &host)
+    const std::uint8_t host_id)
 {
-    auto &content{ node.cont.at(host) };
-
     if (::cJSON_IsString(&item))
     {
         const char * const val{ item.valuestring };
 
-        if (not val or std::string{val}.empty())
+        if (not val or '\0' == *val)
         {
-            content.is_parsed = false;
-            return;
+            return false;
         }
 
-        content.val = std::stoi(val);
-        content.is_parsed = true;
+        node.cont[host_id] = std::stoi(val);
+        return true;
     }
 
     if (::cJSON_IsNumber(&item))
     {
-        const auto &val{ item.valueint };
-
-        content.val = val;
-        content.is_parsed = true;
+        node.cont[host_id] = item.valueint;
+        return true;
     }
+
+    return false;
 }
 
-template<template<typename ...> class T> void
+template<template<typename ...> class T> bool
 ipinfo::srv::parser::__fill_node(
     T<double> &node,
     const ::cJSON &item,
-    const std::string &host)
+    const std::uint8_t host_id)
 {
-    auto &content{ node.cont.at(host) };
-
     if (::cJSON_IsString(&item))
     {
         const char * const val{ item.valuestring };
 
-        if (not val ||
-            std::string{val}.empty())
+        if (not val or '\0' == *val)
         {
-            content.is_parsed = false;
-            return;
+            return false;
         }
 
-        content.val = std::stod(val);
-        content.is_parsed = true;
+        node.cont[host_id] = std::stod(val);
+        return true;
     }
 
     if (::cJSON_IsNumber(&item))
     {
-        content.val = item.valuedouble;
-        content.is_parsed = true;
+        node.cont[host_id] = item.valuedouble;
+        return true;
     }
+
+    return false;
 }
 
-template<template<typename ...> class T> void
+template<template<typename ...> class T> bool
 ipinfo::srv::parser::__fill_node(
     T<bool> &node,
     const ::cJSON &item,
-    const std::string &host)
+    const std::uint8_t host_id)
 {
-    auto &content{ node.cont.at(host) };
-
     if (::cJSON_IsString(&item))
     {
         const char * const val{ item.valuestring };
 
-        if (not val or std::string{ val }.empty())
+        if (not val or '\0' == *val)
         {
-            content.is_parsed = false;
-            return;
+            return false;
         }
 
-        content.val = ("true" == std::string{ val });
-        content.is_parsed = true;
+        node.cont[host_id] = ("true" == std::string{ val });
+        return true;
     }
 
     if (::cJSON_IsBool(&item))
     {
-        content.val = item.valueint;
-        content.is_parsed = true;
+        node.cont[host_id] = ::cJSON_IsTrue(&item);
+        return true;
     }
+
+    return false;
 }
 
-template<template<typename ...> class T, typename sub_T> void
-ipinfo::srv::parser::__catch_node(
+void
+ipinfo::srv::parser::__parse_object(
     const ::cJSON &data,
-    T<sub_T> &node,
-    const std::string &host)
+    ipinfo::srv::types::info &info,
+    const std::uint8_t host_id)
 {
-    const auto &node_name{ node.cont.at(host).json_name.c_str() };
-    const ::cJSON * const item {
-        ::cJSON_GetObjectItemCaseSensitive(&data, node_name)
-    };
+    const ::cJSON *item{};
+
+    // Every member of the object is matched by the host's fields
+    // table, instead of searching the object for every field.
 
-    __fill_node(node, *item, host);
+    cJSON_ArrayForEach(item, &data)
+    {
+        if (not item->string)
+        {
+            continue;
+        }
+
+        const std::uint8_t field_id {
+            FIELDS_TABLES[host_id].find(item->string)
+        };
+
+        visit_field(info, field_id, [&] (auto &node)
+        {
+            set_parsed(info, host_id, field_id,
+                __fill_node(node, *item, host_id));
+        });
+    }
 }
 
 void
@@ -165,6 +185,52 @@ ipinfo::srv::parser::parse(
     ipinfo::srv::types::info &info,
     const std::string &host)
 {
+    __error = {};
+
+    const std::uint8_t host_id{ srv::utiler{}.get_host_id(host) };
+
+    if (constants::AVAILABLE_HOSTS_NUM <= host_id)
+    {
+        return;
+    }
+
+    ::cJSON * const data{ __prepare(json) };
+
+    if (not data)
+    {
+        return;
+    }
+
+    if (not ::cJSON_IsObject(data))
+    {
+        __error = {
+            .code{ constants::ERRORS_IDS::FAILED_JSON_PARSING },
+            .desc{ "An object is expected" }
+        };
+
+        ::cJSON_Delete(data);
+        return;
+    }
+
+    __parse_object(*data, info, host_id);
+    ::cJSON_Delete(data);
+}
+
+void
+ipinfo::srv::parser::parse_batch(
+    const std::string &json,
+    std::vector<ipinfo::srv::types::info> &infos,
+    const std::string &host)
+{
+    __error = {};
+
+    const std::uint8_t host_id{ srv::utiler{}.get_host_id(host) };
+
+    if (constants::AVAILABLE_HOSTS_NUM <= host_id)
+    {
+        return;
+    }
+
     ::cJSON * const data{ __prepare(json) };
 
     if (not data)
@@ -172,40 +238,31 @@ ipinfo::srv::parser::parse(
         return;
     }
 
-    // think about a shorting of the call list below
-    __catch_node(*data, info.ip, host);
-    __catch_node(*data, info.ip_type, host);
-    __catch_node(*data, info.continent, host);
-    __catch_node(*data, info.continent_code, host);
-    __catch_node(*data, info.country, host);
-    __catch_node(*data, info.country_code, host);
-    __catch_node(*data, info.country_capital, host);
-    __catch_node(*data, info.country_ph_code, host);
-    __catch_node(*data, info.country_neighbors, host);
-    __catch_node(*data, info.region, host);
-    __catch_node(*data, info.region_code, host);
-    __catch_node(*data, info.city, host);
-    __catch_node(*data, info.city_district, host);
-    __catch_node(*data, info.zip_code, host);
-    __catch_node(*data, info.latitude, host);
-    __catch_node(*data, info.longitude, host);
-    __catch_node(*data, info.city_timezone, host);
-    __catch_node(*data, info.timezone, host);
-    __catch_node(*data, info.gmt_offset, host);
-    __catch_node(*data, info.dst_offset, host);
-    __catch_node(*data, info.timezone_gmt, host);
-    __catch_node(*data, info.isp, host);
-    __catch_node(*data, info.as, host);
-    __catch_node(*data, info.org, host);
-    __catch_node(*data, info.reverse_dns, host);
-    __catch_node(*data, info.is_hosting, host);
-    __catch_node(*data, info.is_proxy, host);
-    __catch_node(*data, info.is_mobile, host);
-    __catch_node(*data, info.currency, host);
-    __catch_node(*data, info.currency_code, host);
-    __catch_node(*data, info.currency_symbol, host);
-    __catch_node(*data, info.currency_rates, host);
-    __catch_node(*data, info.currency_plural, host);
+    if (not ::cJSON_IsArray(data))
+    {
+        __error = {
+            .code{ constants::ERRORS_IDS::FAILED_JSON_PARSING },
+            .desc{ "An array is expected" }
+        };
+
+        ::cJSON_Delete(data);
+        return;
+    }
+
+    infos.resize(static_cast<std::size_t>(::cJSON_GetArraySize(data)));
+
+    const ::cJSON *item{};
+    std::size_t i{ 0u };
+
+    cJSON_ArrayForEach(item, data)
+    {
+        if (::cJSON_IsObject(item))
+        {
+            __parse_object(*item, infos.at(i), host_id);
+        }
+
+        i += 1u;
+    }
 
     ::cJSON_Delete(data);
 }
@@ -213,5 +270,5 @@ ipinfo::srv::parser::parse(
 ipinfo::usr::types::error
 ipinfo::srv::parser::get_last_error() const
 {
-    return {}; // !!!
+    return __error;
 }
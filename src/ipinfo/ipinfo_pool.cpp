@@ -0,0 +1,102 @@
+#include "../../include/ipinfo/ipinfo_constants.hpp"
+#include "../../include/ipinfo/ipinfo_pool.hpp"
+
+#include <cpr/cpr.h>
+
+#include <algorithm> // std::remove_if
+#include <cstddef>   // std::ptrdiff_t
+#include <utility>   // std::move
+
+ipinfo::srv::pool &
+ipinfo::srv::pool::instance()
+{
+    static pool p{};
+    return p;
+}
+
+void
+ipinfo::srv::pool::__drop_expired(
+    std::vector<__entry> &entries,
+    const clock::time_point now)
+{
+    const auto is_expired {
+        [this, now](const __entry &e) -> bool {
+            return (now - e.last_use) > __idle_timeout;
+        }
+    };
+
+    entries.erase(
+        std::remove_if(entries.begin(), entries.end(), is_expired),
+        entries.end());
+}
+
+std::unique_ptr<cpr::Session>
+ipinfo::srv::pool::acquire(const std::string &host)
+{
+    {
+        const std::lock_guard<std::mutex> lock{ __mtx };
+        auto &entries{ __idle[host] };
+
+        __drop_expired(entries, clock::now());
+
+        // The most recently used session is taken first,
+        // its connection is the most likely to be alive.
+
+        if (not entries.empty())
+        {
+            std::unique_ptr<cpr::Session> session {
+                std::move(entries.back().session)
+            };
+
+            entries.pop_back();
+            return session;
+        }
+    }
+
+    return std::make_unique<cpr::Session>();
+}
+
+void
+ipinfo::srv::pool::release(
+    const std::string &host,
+    std::unique_ptr<cpr::Session> session)
+{
+    if (not session)
+    {
+        return;
+    }
+
+    const std::lock_guard<std::mutex> lock{ __mtx };
+    auto &entries{ __idle[host] };
+
+    if (entries.size() < __size)
+    {
+        entries.push_back({
+            .session{ std::move(session) },
+            .last_use{ clock::now() }
+        });
+    }
+}
+
+void
+ipinfo::srv::pool::set_size(const std::size_t n)
+{
+    const std::lock_guard<std::mutex> lock{ __mtx };
+    __size = n;
+
+    for (auto &[_, entries] : __idle)
+    {
+        if (entries.size() > __size)
+        {
+            const auto extra{ static_cast<std::ptrdiff_t>(entries.size() - __size) };
+            entries.erase(entries.begin(), entries.begin() + extra);
+        }
+    }
+}
+
+void
+ipinfo::srv::pool::set_idle_timeout(const std::chrono::milliseconds &timeout)
+{
+    const std::lock_guard<std::mutex> lock{ __mtx };
+    __idle_timeout = timeout;
+}
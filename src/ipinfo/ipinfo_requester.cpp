@@ -3,25 +3,146 @@
 #include "../../include/ipinfo/ipinfo_constants.hpp"
 #include "../../include/ipinfo/ipinfo_utiler.hpp"
 #include "../../include/ipinfo/ipinfo_requester.hpp"
+#include "../../include/ipinfo/ipinfo_pool.hpp"
+#include "../../include/ipinfo/ipinfo_scheduler.hpp"
+#include "../../include/ipinfo/ipinfo_tracker.hpp"
 
 #include <cpr/cpr.h>
 
+#include <chrono>
 #include <cstddef>    // std::size_t
-#include <numeric>    // std::accumulate
+#include <cstdint>    // std::int32_t
+#include <array>      // std::array
+#include <string_view>
+#include <memory>     // std::unique_ptr
+#include <utility>    // std::move
+
+namespace
+{
+    // The quota of the host's bucket is corrected
+    // by the rate limit headers of the answer.
+
+    void
+    update_quota(const std::string &bucket, const cpr::Response &resp)
+    {
+        auto &schdlr{ ipinfo::srv::scheduler::instance() };
+
+        const auto find_header {
+            [&resp](const std::string &name) -> std::string {
+                const auto res{ resp.header.find(name) };
+                return (resp.header.end() != res) ? res->second : std::string{};
+            }
+        };
+
+        const std::string
+            remaining{ find_header(ipinfo::constants::RATE_LIMIT_REMAINING_HEADER) },
+            reset_in{ find_header(ipinfo::constants::RATE_LIMIT_RESET_HEADER) };
+
+        if (429 == resp.status_code)
+        {
+            schdlr.throttle(bucket, reset_in);
+            return;
+        }
+
+        schdlr.update(bucket, remaining, reset_in);
+    }
+
+    // the answer of a sent request, failures are classified
+    // the same way for single and batch requests
+    ipinfo::srv::types::response
+    make_response(const cpr::Response &resp)
+    {
+        namespace constants = ipinfo::constants;
+
+        if (cpr::ErrorCode::OPERATION_TIMEDOUT == resp.error.code)
+        {
+            return {
+                .error {
+                    .code{ constants::ERRORS_IDS::REQUEST_TIMEOUT },
+                    .desc{ "The request isn't done by the deadline" }
+                },
+                .is_sent{ true }
+            };
+        }
+
+        if (resp.error)
+        {
+            return {
+                .error {
+                    .code{ constants::ERRORS_IDS::FAILED_REQUEST },
+                    .desc{ resp.error.message }
+                },
+                .is_sent{ true }
+            };
+        }
+
+        if (200u != resp.status_code)
+        {
+            return {
+                .error {
+                    .code{ constants::ERRORS_IDS::UNSUCCESSFULL_RESPONSE_STATUS_CODE },
+                    .desc{ "Response status code is " + std::to_string(resp.status_code) }
+                },
+                .status_code{ static_cast<std::int32_t>(resp.status_code) },
+                .is_sent{ true }
+            };
+        }
+
+        if (resp.text.empty())
+        {
+            return {
+                .error {
+                    .code{ constants::ERRORS_IDS::EMPTY_REQUEST_ANSWER },
+                    .desc{ "Empty answer to the request" }
+                },
+                .is_sent{ true }
+            };
+        }
+
+        return {
+            .answ{ resp.text },
+            .status_code{ static_cast<std::int32_t>(resp.status_code) },
+            .is_sent{ true }
+        };
+    }
+}
 
 std::string
 ipinfo::srv::requester::__get_info_fields(const std::string &host) const
 {
-    const auto &fields{ constants::REQUEST_INFO_FIELDS.at(host) };
-    const auto itemize {
-        [](const std::string &s, const std::string &elem) -> std::string {
-            return s + ',' + elem;
-        }
+    // Lists are built once from the fields' descriptions, a host
+    // is asked for exactly the fields which could be parsed.
+
+    static const std::array<std::string, constants::AVAILABLE_HOSTS_NUM> lists {
+        [] ()
+        {
+            std::array<std::string, constants::AVAILABLE_HOSTS_NUM> res{};
+
+            for (std::size_t i{ 0u }; i < res.size(); i++)
+            {
+                for (const constants::info_field &field : constants::INFO_FIELDS)
+                {
+                    const std::string_view name{ field.json_names.at(i) };
+
+                    if (name.empty())
+                    {
+                        continue;
+                    }
+
+                    if (not res.at(i).empty())
+                    {
+                        res.at(i) += ',';
+                    }
+
+                    res.at(i) += name;
+                }
+            }
+
+            return res;
+        }()
     };
 
-    return std::accumulate(
-        std::next(fields.begin()),
-        fields.end(), fields.at(0u), itemize);
+    return lists.at(srv::utiler{}.get_host_id(host));
 }
 
 std::string
@@ -41,8 +162,41 @@ ipinfo::srv::requester::__get_lang(
 }
 
 std::string
+ipinfo::srv::requester::__get_batch_body(const std::vector<std::string> &ips) const
+{
+    // The body is a JSON array of IP strings: ["1.1.1.1","8.8.8.8"]
+    std::string body{ '[' };
+
+    for (const std::string &ip : ips)
+    {
+        if ('[' != body.back())
+        {
+            body += ',';
+        }
+
+        body += '"';
+
+        for (const char c : ip)
+        {
+            if ('"' == c or '\\' == c)
+            {
+                body += '\\';
+            }
+
+            body += c;
+        }
+
+        body += '"';
+    }
+
+    return body + ']';
+}
+
+ipinfo::srv::types::response
 ipinfo::srv::requester::request(const srv::types::request_attributes &ra) const
 {
+    using clock = std::chrono::steady_clock;
+
     const std::string &path {
         constants::REQUEST_START_PATHS.at(ra.host)};
 
@@ -60,22 +214,161 @@ ipinfo::srv::requester::request(const srv::types::request_attributes &ra) const
         { param_titles.at("api_key"), ra.api_key }
     };
 
-    const cpr::Url url{ path + ra.ip };
-    const cpr::Response resp{ cpr::Get(url, params) };
+    const srv::types::response timeout {
+        .error {
+            .code{ constants::ERRORS_IDS::REQUEST_TIMEOUT },
+            .desc{ "The request isn't done by the deadline" }
+        }
+    };
+
+    // The request waits for a token of the host's bucket,
+    // so the host's rate limit is never exceeded.
+
+    if (not srv::scheduler::instance().acquire(ra.host, ra.deadline))
+    {
+        return timeout;
+    }
+
+    // Zero timeout means there is no timeout for cpr.
+    std::chrono::milliseconds time_left{ 0 };
+
+    if (clock::time_point::max() != ra.deadline)
+    {
+        time_left = std::chrono::duration_cast<std::chrono::milliseconds>(
+            ra.deadline - clock::now());
+
+        if (time_left <= std::chrono::milliseconds{ 0 })
+        {
+            return timeout;
+        }
+    }
+
+    // A session is borrowed from the pool and returned back
+    // after the request, so its connection stays alive.
+
+    auto &pl{ srv::pool::instance() };
+    std::unique_ptr<cpr::Session> session{ pl.acquire(ra.host) };
+
+    session->SetUrl(cpr::Url{ path + ra.ip });
+    session->SetParameters(params);
+    session->SetTimeout(cpr::Timeout{ time_left });
+
+    const auto start{ clock::now() };
+    const cpr::Response resp{ session->Get() };
+    const auto finish{ clock::now() };
+
+    // The deadline's timeout would be left to the next request of
+    // the session, so it's reset before releasing.
+
+    session->SetTimeout(cpr::Timeout{ std::chrono::milliseconds{ 0 } });
+    pl.release(ra.host, std::move(session));
+    update_quota(ra.host, resp);
+
+    if (not resp.error and 200u == resp.status_code)
+    {
+        srv::tracker::instance().add_sample(ra.host,
+            std::chrono::duration_cast<std::chrono::milliseconds>(finish - start));
+    }
+
+    return make_response(resp);
+}
+
+ipinfo::srv::types::response
+ipinfo::srv::requester::request_batch(
+    const srv::types::batch_request_attributes &bra) const
+{
+    const auto path{ constants::BATCH_REQUEST_PATHS.find(bra.host) };
+
+    if (constants::BATCH_REQUEST_PATHS.end() == path)
+    {
+        return {
+            .error {
+                .code{ constants::ERRORS_IDS::UNSUPPORTED_HOST },
+                .desc{ "The host has no batch endpoint" }
+            }
+        };
+    }
+
+    const auto &param_titles {
+        constants::REQUEST_PARAMETERS_TITLES.at(bra.host)
+    };
+
+    const std::string
+        fields{ __get_info_fields(bra.host) },
+        lang{ __get_lang(bra.host, bra.lang) };
 
-    if (200u != resp.status_code)
+    const cpr::Parameters params = {
+        { param_titles.at("fields"), fields },
+        { param_titles.at("lang"), lang },
+        { param_titles.at("api_key"), bra.api_key }
+    };
+
+    // The batch endpoint has its own bucket. If there will be no
+    // token within the batch's timeout, the batch isn't sent.
+
+    const std::string bucket{ bra.host + "/batch" };
+    const auto deadline{ std::chrono::steady_clock::now() + constants::BATCH_REQUEST_TIMEOUT };
+
+    if (not srv::scheduler::instance().acquire(bucket, deadline))
     {
-        // error
-        return {};
+        return {
+            .error {
+                .code{ constants::ERRORS_IDS::REQUEST_TIMEOUT },
+                .desc{ "The batch isn't sent by its timeout" }
+            }
+        };
     }
 
-    if (resp.text.empty())
+    auto &pl{ srv::pool::instance() };
+    std::unique_ptr<cpr::Session> session{ pl.acquire(bra.host) };
+
+    session->SetUrl(cpr::Url{ path->second });
+    session->SetParameters(params);
+    session->SetHeader(cpr::Header{ { "Content-Type", "application/json" } });
+    session->SetBody(cpr::Body{ __get_batch_body(bra.ips) });
+    session->SetTimeout(cpr::Timeout{ constants::BATCH_REQUEST_TIMEOUT });
+
+    const cpr::Response resp{ session->Post() };
+
+    // The session's body, header and timeout would be sent with
+    // the next request, so they are reset before releasing.
+
+    session->SetHeader(cpr::Header{});
+    session->SetBody(cpr::Body{ std::string{} });
+    session->SetTimeout(cpr::Timeout{ std::chrono::milliseconds{ 0 } });
+    pl.release(bra.host, std::move(session));
+
+    update_quota(bucket, resp);
+
+    return make_response(resp);
+}
+
+std::string
+ipinfo::srv::requester::get_url(const srv::types::request_attributes &ra) const
+{
+    const srv::utiler utlr{};
+    const auto &param_titles {
+        constants::REQUEST_PARAMETERS_TITLES.at(ra.host)
+    };
+
+    std::string url {
+        constants::REQUEST_START_PATHS.at(ra.host) +
+        utlr.url_encode(ra.ip)
+    };
+
+    url += '?' + param_titles.at("fields") + '=' +
+        utlr.url_encode(__get_info_fields(ra.host));
+
+    url += '&' + param_titles.at("lang") + '=' +
+        utlr.url_encode(__get_lang(ra.host, ra.lang));
+
+    if (not ra.api_key.empty())
     {
-        // error
-        return {};
+        url += '&' + param_titles.at("api_key") + '=' +
+            utlr.url_encode(ra.api_key);
     }
 
-    return resp.text;
+    return url;
 }
 
 ipinfo::usr::types::error
@@ -0,0 +1,247 @@
+#include "../../include/ipinfo/ipinfo_types.hpp"
+#include "../../include/ipinfo/ipinfo_constants.hpp"
+#include "../../include/ipinfo/ipinfo_scheduler.hpp"
+
+#include <algorithm> // std::min, std::max
+#include <charconv>  // std::from_chars
+#include <chrono>
+#include <cmath>     // std::floor
+#include <cstdint>   // std::uint32_t
+#include <mutex>     // std::lock_guard
+#include <string>
+#include <thread>    // std::this_thread::sleep_until
+
+namespace
+{
+    constexpr std::chrono::seconds WINDOW{ 60 };
+
+    bool
+    to_uint(const std::string &s, std::uint32_t &n)
+    {
+        const auto res{ std::from_chars(s.data(), s.data() + s.size(), n) };
+        return (std::errc{} == res.ec);
+    }
+}
+
+ipinfo::srv::scheduler &
+ipinfo::srv::scheduler::instance()
+{
+    static scheduler s{};
+    return s;
+}
+
+ipinfo::srv::scheduler::__bucket &
+ipinfo::srv::scheduler::__get_bucket(const std::string &host)
+{
+    const auto bkt{ __buckets.find(host) };
+
+    if (__buckets.end() != bkt)
+    {
+        return bkt->second;
+    }
+
+    const auto lim{ constants::RATE_LIMITS.find(host) };
+    const std::uint32_t limit {
+        (constants::RATE_LIMITS.end() != lim) ? lim->second : 0u
+    };
+
+    return __buckets[host] = {
+        .limit{ limit },
+        .tokens{ static_cast<double>(limit) },
+        .last_refill{ clock::now() }
+    };
+}
+
+void
+ipinfo::srv::scheduler::__refill(__bucket &bkt, const clock::time_point now) const
+{
+    if (clock::time_point{} != bkt.reset_at)
+    {
+        if (now < bkt.reset_at)
+        {
+            return;
+        }
+
+        bkt.tokens = bkt.limit;
+        bkt.reset_at = {};
+        bkt.last_refill = now;
+
+        return;
+    }
+
+    const std::chrono::duration<double> elapsed{ now - bkt.last_refill };
+    const double rate{ bkt.limit / std::chrono::duration<double>{ WINDOW }.count() };
+
+    bkt.tokens = std::min<double>(bkt.limit, bkt.tokens + elapsed.count() * rate);
+    bkt.last_refill = now;
+}
+
+ipinfo::srv::scheduler::clock::time_point
+ipinfo::srv::scheduler::__get_next_token_time(
+    const __bucket &bkt,
+    const clock::time_point now) const
+{
+    if (clock::time_point{} != bkt.reset_at)
+    {
+        return bkt.reset_at;
+    }
+
+    const double rate{ bkt.limit / std::chrono::duration<double>{ WINDOW }.count() };
+    const std::chrono::duration<double> wait{ (1.0 - bkt.tokens) / rate };
+
+    return now + std::chrono::duration_cast<clock::duration>(wait);
+}
+
+bool
+ipinfo::srv::scheduler::try_acquire(
+    const std::string &host,
+    clock::duration &wait)
+{
+    const std::lock_guard<std::mutex> lock{ __mtx };
+    __bucket &bkt{ __get_bucket(host) };
+    const clock::time_point now{ clock::now() };
+
+    // A host without the known limit is only waited
+    // for after it has throttled us.
+
+    if (0u == bkt.limit)
+    {
+        if (now < bkt.reset_at)
+        {
+            wait = bkt.reset_at - now;
+            return false;
+        }
+
+        return true;
+    }
+
+    __refill(bkt, now);
+
+    if (1.0 <= bkt.tokens)
+    {
+        bkt.tokens -= 1.0;
+        return true;
+    }
+
+    wait = __get_next_token_time(bkt, now) - now;
+    return false;
+}
+
+bool
+ipinfo::srv::scheduler::acquire(
+    const std::string &host,
+    const clock::time_point deadline)
+{
+    clock::duration wait{};
+
+    while (not try_acquire(host, wait))
+    {
+        if (clock::now() + wait > deadline)
+        {
+            return false;
+        }
+
+        std::this_thread::sleep_for(wait);
+    }
+
+    return true;
+}
+
+void
+ipinfo::srv::scheduler::update(
+    const std::string &host,
+    const std::string &remaining,
+    const std::string &reset_in)
+{
+    std::uint32_t rl{}, ttl{};
+
+    if (not to_uint(remaining, rl) or not to_uint(reset_in, ttl))
+    {
+        return;
+    }
+
+    const std::lock_guard<std::mutex> lock{ __mtx };
+    __bucket &bkt{ __get_bucket(host) };
+
+    if (0u == bkt.limit)
+    {
+        return;
+    }
+
+    // The host's numbers are the truth. Requests which are in
+    // flight now have already taken their tokens, so the bucket
+    // is never raised above the own counter.
+
+    const clock::time_point now{ clock::now() };
+
+    bkt.tokens = std::min<double>(bkt.tokens, rl);
+    bkt.reset_at = now + std::chrono::seconds{ ttl };
+    bkt.last_refill = now;
+}
+
+void
+ipinfo::srv::scheduler::throttle(
+    const std::string &host,
+    const std::string &reset_in)
+{
+    std::uint32_t ttl{};
+
+    if (not to_uint(reset_in, ttl))
+    {
+        ttl = static_cast<std::uint32_t>(WINDOW.count());
+    }
+
+    const std::lock_guard<std::mutex> lock{ __mtx };
+    __bucket &bkt{ __get_bucket(host) };
+
+    bkt.tokens = 0.0;
+    bkt.reset_at = clock::now() + std::chrono::seconds{ ttl };
+}
+
+void
+ipinfo::srv::scheduler::set_limit(
+    const std::string &host,
+    const std::uint32_t per_minute)
+{
+    const std::lock_guard<std::mutex> lock{ __mtx };
+    __bucket &bkt{ __get_bucket(host) };
+
+    // An unlimited bucket becomes full, a limited one
+    // keeps its tokens, but not more than the new limit.
+
+    bkt.tokens = (0u == bkt.limit) ?
+        per_minute : std::min<double>(bkt.tokens, per_minute);
+
+    bkt.limit = per_minute;
+}
+
+ipinfo::usr::types::quota
+ipinfo::srv::scheduler::get_quota(const std::string &host)
+{
+    const std::lock_guard<std::mutex> lock{ __mtx };
+    __bucket &bkt{ __get_bucket(host) };
+
+    if (0u == bkt.limit)
+    {
+        return {};
+    }
+
+    const clock::time_point now{ clock::now() };
+    __refill(bkt, now);
+
+    const clock::time_point reset_at {
+        (clock::time_point{} != bkt.reset_at) ?
+            bkt.reset_at : __get_next_token_time(bkt, now)
+    };
+
+    return {
+        .is_limited{ true },
+        .remaining{ static_cast<std::uint32_t>(std::floor(bkt.tokens)) },
+        .limit{ bkt.limit },
+        .reset_in {
+            std::max(
+                std::chrono::duration_cast<std::chrono::milliseconds>(reset_at - now),
+                std::chrono::milliseconds{ 0 })
+        }
+    };
+}
@@ -0,0 +1,85 @@
+#include "../../include/ipinfo/ipinfo_sketch.hpp"
+
+#include <algorithm> // std::max, std::min
+#include <atomic>    // std::memory_order_relaxed
+#include <bit>       // std::bit_ceil
+#include <cstddef>   // std::size_t
+#include <cstdint>   // std::uint8_t, std::uint64_t
+#include <memory>    // std::make_unique
+
+ipinfo::srv::sketch::sketch(const std::size_t entries_num)
+{
+    resize(entries_num);
+}
+
+std::size_t
+ipinfo::srv::sketch::__get_index(
+    const std::size_t hash,
+    const std::size_t row) const
+{
+    // Rows need independent indexes, so the key's hash is mixed
+    // with the row's seed (the finalizer of SplitMix64).
+
+    std::uint64_t x{ static_cast<std::uint64_t>(hash) + (row + 1u) * 0x9E3779B97F4A7C15u };
+
+    x = (x ^ (x >> 30u)) * 0xBF58476D1CE4E5B9u;
+    x = (x ^ (x >> 27u)) * 0x94D049BB133111EBu;
+    x = x ^ (x >> 31u);
+
+    return row * __width + static_cast<std::size_t>(x & (__width - 1u));
+}
+
+void
+ipinfo::srv::sketch::__age()
+{
+    for (std::size_t i{ 0u }; i < __DEPTH * __width; i++)
+    {
+        const std::uint8_t count{ __counters[i].load(std::memory_order_relaxed) };
+        __counters[i].store(static_cast<std::uint8_t>(count >> 1u), std::memory_order_relaxed);
+    }
+}
+
+void
+ipinfo::srv::sketch::resize(const std::size_t entries_num)
+{
+    __width = std::bit_ceil(std::max(entries_num, std::size_t{ 1u }));
+    __samples_limit = __SAMPLES_FACTOR * __width;
+    __samples_num = 0u;
+
+    // value-initialized, so all counters are zeros
+    __counters = std::make_unique<std::atomic<std::uint8_t>[]>(__DEPTH * __width);
+}
+
+void
+ipinfo::srv::sketch::record(const std::size_t hash)
+{
+    for (std::size_t row{ 0u }; row < __DEPTH; row++)
+    {
+        std::atomic<std::uint8_t> &counter{ __counters[__get_index(hash, row)] };
+
+        if (__MAX_COUNT > counter.load(std::memory_order_relaxed))
+        {
+            counter.fetch_add(1u, std::memory_order_relaxed);
+        }
+    }
+
+    // only one of the threads reaches the limit exactly
+    if (__samples_limit == __samples_num.fetch_add(1u, std::memory_order_relaxed) + 1u)
+    {
+        __age();
+        __samples_num.fetch_sub(__samples_limit / 2u, std::memory_order_relaxed);
+    }
+}
+
+std::uint8_t
+ipinfo::srv::sketch::estimate(const std::size_t hash) const
+{
+    std::uint8_t count{ __MAX_COUNT };
+
+    for (std::size_t row{ 0u }; row < __DEPTH; row++)
+    {
+        count = std::min(count, __counters[__get_index(hash, row)].load(std::memory_order_relaxed));
+    }
+
+    return count;
+}
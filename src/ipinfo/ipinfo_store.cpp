@@ -0,0 +1,905 @@
+#include "../../include/ipinfo/ipinfo_types.hpp"
+#include "../../include/ipinfo/ipinfo_constants.hpp"
+#include "../../include/ipinfo/ipinfo_store.hpp"
+#include "../../include/ipinfo/ipinfo_fields.hpp"
+
+#include <algorithm>     // std::max, std::min, std::sort
+#include <array>         // std::array
+#include <bit>           // std::bit_ceil
+#include <chrono>
+#include <cstddef>       // std::size_t, offsetof
+#include <cstdint>       // std::uint32_t, std::uint64_t, std::int64_t
+#include <cstdio>        // std::rename
+#include <cstring>       // std::memcpy, std::memcmp
+#include <functional>    // std::function
+#include <mutex>         // std::unique_lock
+#include <shared_mutex>  // std::shared_lock
+#include <string>        // std::string
+#include <string_view>   // std::string_view
+#include <type_traits>   // std::is_same_v, std::is_trivially_copyable_v
+#include <unordered_map> // std::unordered_map
+#include <utility>       // std::pair
+#include <vector>        // std::vector
+
+#include <fcntl.h>    // open
+#include <sys/mman.h> // mmap, munmap
+#include <sys/stat.h> // fstat
+#include <unistd.h>   // pread, pwrite, fsync, ftruncate, close
+
+namespace
+{
+    constexpr char MAGIC[8]{ 'I', 'P', 'I', 'N', 'F', 'O', 'C', '\0' };
+    constexpr std::uint32_t VERSION{ 2u };
+
+    constexpr std::array<std::uint32_t, 256u> make_crc_table()
+    {
+        std::array<std::uint32_t, 256u> table{};
+
+        for (std::uint32_t i{ 0u }; i < table.size(); i++)
+        {
+            std::uint32_t c{ i };
+
+            for (std::uint8_t k{ 0u }; k < 8u; k++)
+            {
+                c = (c & 1u) ? (0xEDB88320u ^ (c >> 1u)) : (c >> 1u);
+            }
+
+            table[i] = c;
+        }
+
+        return table;
+    }
+
+    constexpr std::array<std::uint32_t, 256u> CRC_TABLE{ make_crc_table() };
+
+    // CRC-32 (IEEE 802.3)
+    std::uint32_t get_crc(const char *data, const std::size_t n)
+    {
+        std::uint32_t crc{ 0xFFFFFFFFu };
+
+        for (std::size_t i{ 0u }; i < n; i++)
+        {
+            crc = CRC_TABLE[(crc ^ static_cast<std::uint8_t>(data[i])) & 0xFFu] ^ (crc >> 8u);
+        }
+
+        return crc ^ 0xFFFFFFFFu;
+    }
+
+    bool write_all(
+        const int fd,
+        const char *data,
+        std::size_t n,
+        std::uint64_t offset)
+    {
+        while (0u < n)
+        {
+            const ssize_t written {
+                ::pwrite(fd, data, n, static_cast<off_t>(offset))
+            };
+
+            if (0 >= written)
+            {
+                return false;
+            }
+
+            data += written;
+            n -= static_cast<std::size_t>(written);
+            offset += static_cast<std::uint64_t>(written);
+        }
+
+        return true;
+    }
+
+    std::int64_t to_ms(const ipinfo::srv::store::clock::time_point &tp)
+    {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+            tp.time_since_epoch()).count();
+    }
+
+    // the directory's entry of a renamed file is durable after it's synced
+    void sync_dir(const std::string &path)
+    {
+        const std::size_t slash{ path.find_last_of('/') };
+        const std::string dir{ std::string::npos == slash ? "." : path.substr(0u, slash + 1u) };
+        const int fd{ ::open(dir.c_str(), O_RDONLY | O_CLOEXEC) };
+
+        if (0 <= fd)
+        {
+            ::fsync(fd);
+            ::close(fd);
+        }
+    }
+}
+
+ipinfo::srv::store::~store()
+{
+    close();
+}
+
+std::uint64_t
+ipinfo::srv::store::__hash(const std::string_view key)
+{
+    std::uint64_t h{ 14695981039346656037u }; // FNV-1a
+
+    for (const char c : key)
+    {
+        h = (h ^ static_cast<std::uint8_t>(c)) * 1099511628211u;
+    }
+
+    return h;
+}
+
+bool
+ipinfo::srv::store::__fail(const std::uint8_t code, const std::string &desc)
+{
+    __error = {
+        .code{ code },
+        .desc{ desc + ": " + __path }
+    };
+
+    return false;
+}
+
+bool
+ipinfo::srv::store::__map()
+{
+    const std::size_t map_size {
+        std::max(constants::CACHE_FILE_MIN_MAP_SIZE, 2u * __file_size)
+    };
+
+    // Pages after the file's end aren't touched until
+    // the file grows, so the mapping may be larger.
+
+    void *data{ ::mmap(nullptr, map_size, PROT_READ, MAP_SHARED, __fd, 0) };
+
+    if (MAP_FAILED == data)
+    {
+        return __fail(constants::ERRORS_IDS::FAILED_FILE_ACCESS, "Failed to map the file");
+    }
+
+    __data = static_cast<const char *>(data);
+    __map_size = map_size;
+
+    return true;
+}
+
+void
+ipinfo::srv::store::__unmap()
+{
+    if (nullptr != __data)
+    {
+        ::munmap(const_cast<char *>(__data), __map_size);
+    }
+
+    __data = nullptr;
+    __map_size = 0u;
+}
+
+bool
+ipinfo::srv::store::__init_file()
+{
+    __hdr = {};
+
+    std::memcpy(__hdr.magic, MAGIC, sizeof(MAGIC));
+    __hdr.version = VERSION;
+    __hdr.table_offset = sizeof(__header);
+    __hdr.tail_offset = sizeof(__header);
+    __hdr.crc = get_crc(reinterpret_cast<const char *>(&__hdr), offsetof(__header, crc));
+
+    if (0 != ::ftruncate(__fd, 0) or
+        not write_all(__fd, reinterpret_cast<const char *>(&__hdr), sizeof(__header), 0u) or
+        0 != ::fsync(__fd))
+    {
+        return __fail(constants::ERRORS_IDS::FAILED_FILE_ACCESS, "Failed to write the file");
+    }
+
+    __file_size = sizeof(__header);
+    return true;
+}
+
+bool
+ipinfo::srv::store::__read_header()
+{
+    if (sizeof(__header) > __file_size or
+        static_cast<ssize_t>(sizeof(__header)) != ::pread(__fd, &__hdr, sizeof(__header), 0))
+    {
+        return __fail(constants::ERRORS_IDS::CORRUPTED_FILE, "The file has no header");
+    }
+
+    const std::uint64_t table_end {
+        __hdr.table_offset + std::uint64_t{ __hdr.slots_num } * sizeof(__slot)
+    };
+
+    if (0 != std::memcmp(__hdr.magic, MAGIC, sizeof(MAGIC)) or
+        VERSION != __hdr.version or
+        __hdr.crc != get_crc(reinterpret_cast<const char *>(&__hdr), offsetof(__header, crc)) or
+        (0u != __hdr.slots_num and std::bit_ceil(__hdr.slots_num) != __hdr.slots_num) or
+        table_end != __hdr.tail_offset or
+        __hdr.tail_offset > __file_size)
+    {
+        return __fail(constants::ERRORS_IDS::CORRUPTED_FILE, "The file isn't a cache file");
+    }
+
+    return true;
+}
+
+bool
+ipinfo::srv::store::__view_record(
+    const std::uint64_t offset,
+    __record_header &rec,
+    std::string_view &key,
+    std::string_view &value) const
+{
+    // offsets of the table come from the file, they may point anywhere
+    if (sizeof(__header) > offset or offset + sizeof(__record_header) > __file_size)
+    {
+        return false;
+    }
+
+    std::memcpy(&rec, __data + offset, sizeof(__record_header));
+
+    if (sizeof(__record_header) + std::uint64_t{ rec.key_len } > rec.size or
+        offset + rec.size > __file_size)
+    {
+        return false;
+    }
+
+    const char *rec_data{ __data + offset };
+
+    key = { rec_data + sizeof(__record_header), rec.key_len };
+    value = {
+        rec_data + sizeof(__record_header) + rec.key_len,
+        rec.size - sizeof(__record_header) - rec.key_len
+    };
+
+    return true;
+}
+
+bool
+ipinfo::srv::store::__read_record(
+    const std::uint64_t offset,
+    __record_header &rec,
+    std::string_view &key,
+    std::string_view &value) const
+{
+    if (not __view_record(offset, rec, key, value))
+    {
+        return false;
+    }
+
+    const std::size_t covered{ offsetof(__record_header, expires_at) };
+    return rec.crc == get_crc(__data + offset + covered, rec.size - covered);
+}
+
+void
+ipinfo::srv::store::__scan_tail()
+{
+    std::uint64_t offset{ __hdr.tail_offset };
+
+    __record_header rec{};
+    std::string_view key{}, value{};
+
+    while (__read_record(offset, rec, key, value))
+    {
+        __tail.insert_or_assign(std::string{ key }, offset);
+        offset += rec.size;
+    }
+
+    // The rest is a torn write, it's dropped. A read-only file may be
+    // appended by its writer right now, so the rest is only ignored.
+    if (offset < __file_size and (__is_read_only or 0 == ::ftruncate(__fd, static_cast<off_t>(offset))))
+    {
+        __file_size = offset;
+    }
+}
+
+std::uint64_t
+ipinfo::srv::store::__find_offset(const std::string &key) const
+{
+    // appended records are newer than the table's ones
+    if (const auto it{ __tail.find(key) }; __tail.end() != it)
+    {
+        return it->second;
+    }
+
+    if (0u == __hdr.slots_num)
+    {
+        return 0u;
+    }
+
+    const std::uint64_t h{ __hash(key) };
+    const std::uint64_t mask{ __hdr.slots_num - 1u };
+
+    for (std::uint64_t i{ h & mask }, n{ 0u }; n < __hdr.slots_num; i = (i + 1u) & mask, n++)
+    {
+        __slot slot{};
+        std::memcpy(&slot, __data + __hdr.table_offset + i * sizeof(__slot), sizeof(__slot));
+
+        if (0u == slot.offset)
+        {
+            return 0u;
+        }
+
+        if (h != slot.hash)
+        {
+            continue;
+        }
+
+        // The CRC isn't checked on every lookup, only the bounds: a
+        // broken record fails its deserialization or its key's match.
+
+        __record_header rec{};
+        std::string_view rec_key{}, value{};
+
+        if (__view_record(slot.offset, rec, rec_key, value) and key == rec_key)
+        {
+            return slot.offset;
+        }
+    }
+
+    return 0u;
+}
+
+bool
+ipinfo::srv::store::__append(
+    const std::string &key,
+    const std::string &value,
+    const std::int64_t expires_at)
+{
+    __record_header rec {
+        .size{ static_cast<std::uint32_t>(sizeof(__record_header) + key.size() + value.size()) },
+        .crc{ 0u },
+        .expires_at{ expires_at },
+        .key_len{ static_cast<std::uint32_t>(key.size()) },
+        .reserved{ 0u }
+    };
+
+    std::string buf{};
+    const std::size_t covered{ offsetof(__record_header, expires_at) };
+
+    buf.reserve(rec.size);
+    buf.append(reinterpret_cast<const char *>(&rec), sizeof(__record_header));
+    buf.append(key).append(value);
+
+    rec.crc = get_crc(buf.data() + covered, buf.size() - covered);
+    std::memcpy(buf.data() + offsetof(__record_header, crc), &rec.crc, sizeof(rec.crc));
+
+    if (not write_all(__fd, buf.data(), buf.size(), __file_size))
+    {
+        // a partial record is cut, the next scan would drop it anyway
+        static_cast<void>(::ftruncate(__fd, static_cast<off_t>(__file_size)));
+        return __fail(constants::ERRORS_IDS::FAILED_FILE_ACCESS, "Failed to write the file");
+    }
+
+    __tail.insert_or_assign(key, __file_size);
+    __file_size += buf.size();
+
+    if (__file_size > __map_size)
+    {
+        __unmap();
+        return __map();
+    }
+
+    return true;
+}
+
+bool
+ipinfo::srv::store::__open(const std::string &path, const bool is_read_only)
+{
+    const std::unique_lock<std::shared_mutex> lock{ __mtx };
+
+    __is_open.store(false, std::memory_order_release);
+    __unmap();
+
+    if (0 <= __fd)
+    {
+        ::close(__fd);
+    }
+
+    __fd = is_read_only ?
+        ::open(path.c_str(), O_RDONLY | O_CLOEXEC) :
+        ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+
+    __path = path;
+    __is_read_only = is_read_only;
+    __tail.clear();
+    __error = {};
+
+    struct stat st{};
+
+    if (0 > __fd or 0 != ::fstat(__fd, &st))
+    {
+        __fail(constants::ERRORS_IDS::FAILED_FILE_ACCESS, "Failed to open the file");
+    }
+    else
+    {
+        __file_size = static_cast<std::size_t>(st.st_size);
+
+        // An empty file is a new one, the error is set by the failed
+        // step. A read-only one isn't written, it has no header then.
+        if ((0u != __file_size or (not is_read_only and __init_file())) and
+            __read_header() and __map())
+        {
+            __scan_tail();
+            __is_open.store(true, std::memory_order_release);
+
+            return true;
+        }
+    }
+
+    __unmap();
+
+    if (0 <= __fd)
+    {
+        ::close(__fd);
+        __fd = -1;
+    }
+
+    return false;
+}
+
+bool
+ipinfo::srv::store::open(const std::string &path)
+{
+    return __open(path, false);
+}
+
+bool
+ipinfo::srv::store::open_read_only(const std::string &path)
+{
+    return __open(path, true);
+}
+
+void
+ipinfo::srv::store::close()
+{
+    const std::unique_lock<std::shared_mutex> lock{ __mtx };
+
+    __is_open.store(false, std::memory_order_release);
+    __unmap();
+
+    if (0 <= __fd)
+    {
+        ::close(__fd);
+    }
+
+    __fd = -1;
+    __is_read_only = false;
+    __file_size = 0u;
+    __hdr = {};
+    __tail.clear();
+}
+
+bool
+ipinfo::srv::store::is_open() const
+{
+    return __is_open.load(std::memory_order_acquire);
+}
+
+bool
+ipinfo::srv::store::find(
+    const std::string &key,
+    ipinfo::srv::types::info &info,
+    clock::time_point &expires_at) const
+{
+    if (not __is_open.load(std::memory_order_acquire))
+    {
+        return false;
+    }
+
+    const std::shared_lock<std::shared_mutex> lock{ __mtx };
+
+    if (0 > __fd)
+    {
+        return false;
+    }
+
+    const std::uint64_t offset{ __find_offset(key) };
+
+    if (0u == offset)
+    {
+        return false;
+    }
+
+    __record_header rec{};
+    std::string_view rec_key{}, value{};
+
+    // erased records have the zero time
+    if (not __view_record(offset, rec, rec_key, value) or rec.expires_at <= to_ms(clock::now()))
+    {
+        return false;
+    }
+
+    // a broken time mustn't overflow the clock's duration
+    const std::int64_t ms{ std::min(rec.expires_at, to_ms(clock::time_point::max())) };
+
+    expires_at = clock::time_point{ std::chrono::milliseconds{ ms } };
+    return deserialize(value, info);
+}
+
+bool
+ipinfo::srv::store::insert(
+    const std::string &key,
+    const ipinfo::srv::types::info &info,
+    const clock::time_point &expires_at)
+{
+    if (not __is_open.load(std::memory_order_acquire))
+    {
+        return false;
+    }
+
+    std::string value{};
+    serialize(info, value);
+
+    const std::unique_lock<std::shared_mutex> lock{ __mtx };
+
+    if (0 > __fd or __is_read_only)
+    {
+        return false;
+    }
+
+    return __append(key, value, to_ms(expires_at));
+}
+
+bool
+ipinfo::srv::store::erase_prefix(const std::string &prefix)
+{
+    const std::unique_lock<std::shared_mutex> lock{ __mtx };
+
+    if (0 > __fd or __is_read_only)
+    {
+        return false;
+    }
+
+    std::vector<std::string> keys{};
+
+    for (const auto &[key, offset] : __tail)
+    {
+        if (key.starts_with(prefix))
+        {
+            keys.push_back(key);
+        }
+    }
+
+    for (std::uint64_t i{ 0u }; i < __hdr.slots_num; i++)
+    {
+        __slot slot{};
+        std::memcpy(&slot, __data + __hdr.table_offset + i * sizeof(__slot), sizeof(__slot));
+
+        __record_header rec{};
+        std::string_view key{}, value{};
+
+        if (0u == slot.offset or not __view_record(slot.offset, rec, key, value))
+        {
+            continue;
+        }
+
+        // a key of the tail is already taken
+        if (key.starts_with(prefix) and __tail.end() == __tail.find(std::string{ key }))
+        {
+            keys.emplace_back(key);
+        }
+    }
+
+    for (const std::string &key : keys)
+    {
+        if (not __append(key, {}, 0))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool
+ipinfo::srv::store::clear()
+{
+    const std::unique_lock<std::shared_mutex> lock{ __mtx };
+
+    if (0 > __fd or __is_read_only)
+    {
+        return false;
+    }
+
+    // The file isn't truncated in place, its other mappings (e.g. of a
+    // reader process) would fault on pages beyond the new end.
+    return __rewrite({});
+}
+
+void
+ipinfo::srv::store::__get_live(std::unordered_map<std::string_view, std::uint64_t> &live) const
+{
+    const std::int64_t now{ to_ms(clock::now()) };
+
+    // Records of the table are fully checked here, so the compaction
+    // doesn't copy broken ones. Records of the tail are checked
+    // by the scan at the opening.
+
+    for (std::uint64_t i{ 0u }; i < __hdr.slots_num; i++)
+    {
+        __slot slot{};
+        std::memcpy(&slot, __data + __hdr.table_offset + i * sizeof(__slot), sizeof(__slot));
+
+        __record_header rec{};
+        std::string_view key{}, value{};
+
+        if (0u != slot.offset and __read_record(slot.offset, rec, key, value))
+        {
+            live.insert_or_assign(key, slot.offset);
+        }
+    }
+
+    for (const auto &[key, offset] : __tail)
+    {
+        live.insert_or_assign(key, offset);
+    }
+
+    std::erase_if(live, [this, now] (const auto &kv)
+    {
+        __record_header rec{};
+        std::memcpy(&rec, __data + kv.second, sizeof(__record_header));
+
+        return rec.expires_at <= now;
+    });
+}
+
+bool
+ipinfo::srv::store::__rewrite(const std::unordered_map<std::string_view, std::uint64_t> &live)
+{
+    const std::string tmp_path{ __path + ".tmp" };
+    const int fd{ ::open(tmp_path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644) };
+
+    if (0 > fd)
+    {
+        return __fail(constants::ERRORS_IDS::FAILED_FILE_ACCESS, "Failed to create a file");
+    }
+
+    // The load factor is a half at most, so probes are short
+    // and there is always an empty slot which ends a probe.
+
+    __header hdr{};
+    std::vector<__slot> slots(live.empty() ? 0u : std::bit_ceil(2u * live.size()));
+
+    std::memcpy(hdr.magic, MAGIC, sizeof(MAGIC));
+    hdr.version = VERSION;
+    hdr.slots_num = static_cast<std::uint32_t>(slots.size());
+
+    std::uint64_t offset{ sizeof(__header) };
+    bool is_written{ true };
+
+    for (const auto &[key, old_offset] : live)
+    {
+        __record_header rec{};
+        std::memcpy(&rec, __data + old_offset, sizeof(__record_header));
+
+        is_written = is_written and write_all(fd, __data + old_offset, rec.size, offset);
+
+        const std::uint64_t h{ __hash(key) };
+        std::uint64_t i{ h & (slots.size() - 1u) };
+
+        while (0u != slots[i].offset)
+        {
+            i = (i + 1u) & (slots.size() - 1u);
+        }
+
+        slots[i] = { .hash{ h }, .offset{ offset } };
+        offset += rec.size;
+    }
+
+    hdr.table_offset = offset;
+    hdr.tail_offset = offset + slots.size() * sizeof(__slot);
+    hdr.crc = get_crc(reinterpret_cast<const char *>(&hdr), offsetof(__header, crc));
+
+    is_written = is_written and
+        write_all(fd, reinterpret_cast<const char *>(slots.data()), slots.size() * sizeof(__slot), offset) and
+        write_all(fd, reinterpret_cast<const char *>(&hdr), sizeof(__header), 0u) and
+        0 == ::fsync(fd);
+
+    // the old file is kept, if the new one isn't complete
+    if (not is_written or 0 != std::rename(tmp_path.c_str(), __path.c_str()))
+    {
+        ::close(fd);
+        ::unlink(tmp_path.c_str());
+
+        return __fail(constants::ERRORS_IDS::FAILED_FILE_ACCESS, "Failed to rewrite the file");
+    }
+
+    sync_dir(__path);
+
+    __unmap();
+    ::close(__fd);
+
+    __fd = fd;
+    __hdr = hdr;
+    __file_size = hdr.tail_offset;
+    __tail.clear();
+
+    return __map();
+}
+
+bool
+ipinfo::srv::store::compact()
+{
+    const std::unique_lock<std::shared_mutex> lock{ __mtx };
+
+    if (0 > __fd or __is_read_only)
+    {
+        return false;
+    }
+
+    std::unordered_map<std::string_view, std::uint64_t> live{};
+    __get_live(live);
+
+    return __rewrite(live);
+}
+
+bool
+ipinfo::srv::store::for_each(
+    const std::function<void(const std::string_view key, const srv::types::info &info)> &f) const
+{
+    const std::shared_lock<std::shared_mutex> lock{ __mtx };
+
+    if (0 > __fd)
+    {
+        return false;
+    }
+
+    std::unordered_map<std::string_view, std::uint64_t> live{};
+    __get_live(live);
+
+    // the hash's order depends on the map, the keys' one doesn't
+    std::vector<std::pair<std::string_view, std::uint64_t>> sorted{ live.begin(), live.end() };
+    std::sort(sorted.begin(), sorted.end());
+
+    for (const auto &[key, offset] : sorted)
+    {
+        __record_header rec{};
+        std::string_view rec_key{}, value{};
+        srv::types::info info{};
+
+        // a broken record is skipped
+        if (__read_record(offset, rec, rec_key, value) and deserialize(value, info))
+        {
+            f(key, info);
+        }
+    }
+
+    return true;
+}
+
+ipinfo::usr::types::error
+ipinfo::srv::store::get_last_error() const
+{
+    const std::shared_lock<std::shared_mutex> lock{ __mtx };
+    return __error;
+}
+
+void
+ipinfo::srv::store::serialize(
+    const ipinfo::srv::types::info &info,
+    std::string &out)
+{
+    out.append(reinterpret_cast<const char *>(info.parsed.data()),
+        info.parsed.size() * sizeof(std::uint64_t));
+
+    for (std::uint8_t id{ 0u }; id < constants::INFO_FIELDS_NUM; id++)
+    {
+        srv::visit_field(info, id, [&] (const auto &node)
+        {
+            using val_T = typename std::remove_cvref_t<decltype(node.cont)>::value_type;
+
+            for (std::size_t i{ 0u }; i < constants::INFO_SOURCES_NUM; i++)
+            {
+                if (not srv::is_parsed(info, i, id))
+                {
+                    continue;
+                }
+
+                if constexpr (std::is_same_v<std::string, val_T>)
+                {
+                    const std::uint32_t len{ static_cast<std::uint32_t>(node.cont[i].size()) };
+
+                    out.append(reinterpret_cast<const char *>(&len), sizeof(len));
+                    out.append(node.cont[i]);
+                }
+                else if constexpr (std::is_same_v<bool, val_T>)
+                {
+                    out.push_back(node.cont[i] ? '\1' : '\0');
+                }
+                else
+                {
+                    static_assert(std::is_trivially_copyable_v<val_T>);
+                    out.append(reinterpret_cast<const char *>(&node.cont[i]), sizeof(val_T));
+                }
+            }
+        });
+    }
+}
+
+bool
+ipinfo::srv::store::deserialize(
+    std::string_view data,
+    ipinfo::srv::types::info &info)
+{
+    const std::size_t masks_size{ info.parsed.size() * sizeof(std::uint64_t) };
+
+    if (data.size() < masks_size)
+    {
+        return false;
+    }
+
+    std::memcpy(info.parsed.data(), data.data(), masks_size);
+    data.remove_prefix(masks_size);
+
+    bool is_read{ true };
+
+    for (std::uint8_t id{ 0u }; id < constants::INFO_FIELDS_NUM and is_read; id++)
+    {
+        srv::visit_field(info, id, [&] (auto &node)
+        {
+            using val_T = typename std::remove_cvref_t<decltype(node.cont)>::value_type;
+
+            for (std::size_t i{ 0u }; i < constants::INFO_SOURCES_NUM and is_read; i++)
+            {
+                if (not srv::is_parsed(info, i, id))
+                {
+                    continue;
+                }
+
+                if constexpr (std::is_same_v<std::string, val_T>)
+                {
+                    std::uint32_t len{ 0u };
+
+                    if (data.size() < sizeof(len))
+                    {
+                        is_read = false;
+                        break;
+                    }
+
+                    std::memcpy(&len, data.data(), sizeof(len));
+                    data.remove_prefix(sizeof(len));
+
+                    if (data.size() < len)
+                    {
+                        is_read = false;
+                        break;
+                    }
+
+                    node.cont[i].assign(data.data(), len);
+                    data.remove_prefix(len);
+                }
+                else if constexpr (std::is_same_v<bool, val_T>)
+                {
+                    if (data.empty())
+                    {
+                        is_read = false;
+                        break;
+                    }
+
+                    // a byte of a broken file mustn't make an invalid bool
+                    node.cont[i] = (0u != static_cast<std::uint8_t>(data.front()));
+                    data.remove_prefix(1u);
+                }
+                else
+                {
+                    if (data.size() < sizeof(val_T))
+                    {
+                        is_read = false;
+                        break;
+                    }
+
+                    std::memcpy(&node.cont[i], data.data(), sizeof(val_T));
+                    data.remove_prefix(sizeof(val_T));
+                }
+            }
+        });
+    }
+
+    if (not is_read)
+    {
+        info.parsed.fill(0u);
+    }
+
+    return is_read;
+}
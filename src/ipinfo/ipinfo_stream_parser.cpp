@@ -0,0 +1,616 @@
+#include "../../include/ipinfo/ipinfo_types.hpp"
+#include "../../include/ipinfo/ipinfo_constants.hpp"
+#include "../../include/ipinfo/ipinfo_stream_parser.hpp"
+#include "../../include/ipinfo/ipinfo_fields.hpp"
+#include "../../include/ipinfo/ipinfo_utiler.hpp"
+
+#include <charconv>      // std::from_chars
+#include <cstdint>       // std::int32_t, std::uint32_t
+#include <cstddef>       // std::size_t
+#include <limits>        // std::numeric_limits
+#include <string>        // std::string
+#include <string_view>   // std::string_view
+#include <system_error>  // std::errc
+#include <vector>        // std::vector
+
+namespace
+{
+    template<typename T>
+        bool parse_number(const std::string_view text, T &val)
+    {
+        const char * const last{ text.data() + text.size() };
+        const auto [ptr, ec]{ std::from_chars(text.data(), last, val) };
+
+        return std::errc{} == ec and text.data() != ptr;
+    }
+
+    // the four hex digits of '\uXXXX' are in [first, last)
+    bool is_hex_escape(const char *first, const char * const last)
+    {
+        if (last - first < 4)
+        {
+            return false;
+        }
+
+        for (const char * const end{ first + 4 }; first != end; first++)
+        {
+            const char c{ *first };
+
+            if (not (('0' <= c and c <= '9') or ('a' <= c and c <= 'f') or ('A' <= c and c <= 'F')))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+}
+
+void
+ipinfo::srv::stream_parser::__unescape(
+    std::string_view raw,
+    std::string &out)
+{
+    // 'clear()' keeps the capacity, so the node's value
+    // is reallocated only if the new one is longer.
+
+    out.clear();
+
+    const auto read_hex = [&raw] (const std::size_t pos, std::uint32_t &cp)
+    {
+        if (raw.size() < pos + 4u)
+        {
+            return false;
+        }
+
+        const char * const first{ raw.data() + pos };
+        const auto [ptr, ec]{ std::from_chars(first, first + 4, cp, 16) };
+
+        return std::errc{} == ec and first + 4 == ptr;
+    };
+
+    for (std::size_t i{ 0u }; i < raw.size(); i++)
+    {
+        if ('\\' != raw[i] or i + 1u == raw.size())
+        {
+            out.push_back(raw[i]);
+            continue;
+        }
+
+        i += 1u;
+
+        switch (raw[i])
+        {
+            case 'b': out.push_back('\b'); break;
+            case 'f': out.push_back('\f'); break;
+            case 'n': out.push_back('\n'); break;
+            case 'r': out.push_back('\r'); break;
+            case 't': out.push_back('\t'); break;
+
+            case 'u':
+            {
+                std::uint32_t cp{ 0u };
+
+                if (not read_hex(i + 1u, cp))
+                {
+                    return;
+                }
+
+                i += 4u;
+
+                // a high surrogate is followed by a low one
+                if (0xD800u <= cp and cp <= 0xDBFFu)
+                {
+                    std::uint32_t low{ 0u };
+
+                    if (i + 2u < raw.size() and '\\' == raw[i + 1u] and
+                        'u' == raw[i + 2u] and read_hex(i + 3u, low) and
+                        0xDC00u <= low and low <= 0xDFFFu)
+                    {
+                        cp = 0x10000u + ((cp - 0xD800u) << 10u) + (low - 0xDC00u);
+                        i += 6u;
+                    }
+                }
+
+                if (cp < 0x80u)
+                {
+                    out.push_back(static_cast<char>(cp));
+                }
+                else if (cp < 0x800u)
+                {
+                    out.push_back(static_cast<char>(0xC0u | (cp >> 6u)));
+                    out.push_back(static_cast<char>(0x80u | (cp & 0x3Fu)));
+                }
+                else if (cp < 0x10000u)
+                {
+                    out.push_back(static_cast<char>(0xE0u | (cp >> 12u)));
+                    out.push_back(static_cast<char>(0x80u | ((cp >> 6u) & 0x3Fu)));
+                    out.push_back(static_cast<char>(0x80u | (cp & 0x3Fu)));
+                }
+                else
+                {
+                    out.push_back(static_cast<char>(0xF0u | (cp >> 18u)));
+                    out.push_back(static_cast<char>(0x80u | ((cp >> 12u) & 0x3Fu)));
+                    out.push_back(static_cast<char>(0x80u | ((cp >> 6u) & 0x3Fu)));
+                    out.push_back(static_cast<char>(0x80u | (cp & 0x3Fu)));
+                }
+
+                break;
+            }
+
+            default: out.push_back(raw[i]); // '"', '\\' and '/'
+        }
+    }
+}
+
+void
+ipinfo::srv::stream_parser::__skip_spaces()
+{
+    while (__cur != __end and
+        (' ' == *__cur or '\t' == *__cur or '\n' == *__cur or '\r' == *__cur))
+    {
+        __cur += 1;
+    }
+}
+
+bool
+ipinfo::srv::stream_parser::__expect(const char c)
+{
+    __skip_spaces();
+
+    if (__cur == __end or c != *__cur)
+    {
+        return false;
+    }
+
+    __cur += 1;
+    return true;
+}
+
+bool
+ipinfo::srv::stream_parser::__read_string(
+    std::string_view &raw,
+    bool &is_escaped)
+{
+    if (not __expect('"'))
+    {
+        return __fail("A string is expected");
+    }
+
+    const char * const first{ __cur };
+    is_escaped = false;
+
+    while (__cur != __end and '"' != *__cur)
+    {
+        if ('\\' == *__cur)
+        {
+            is_escaped = true;
+            __cur += 1;
+
+            if (__cur == __end)
+            {
+                break;
+            }
+
+            // escapes are checked here, '__unescape()' trusts them
+            if (std::string_view::npos == std::string_view{ "\"\\/bfnrtu" }.find(*__cur))
+            {
+                return __fail("Invalid escape");
+            }
+
+            if ('u' == *__cur and not is_hex_escape(__cur + 1, __end))
+            {
+                return __fail("Invalid unicode escape");
+            }
+        }
+
+        __cur += 1;
+    }
+
+    if (__cur == __end)
+    {
+        return __fail("Unterminated string");
+    }
+
+    raw = { first, static_cast<std::size_t>(__cur - first) };
+    __cur += 1;
+
+    return true;
+}
+
+bool
+ipinfo::srv::stream_parser::__read_literal(const std::string_view literal)
+{
+    if (static_cast<std::size_t>(__end - __cur) < literal.size() or
+        literal != std::string_view{ __cur, literal.size() })
+    {
+        return __fail("Unknown literal");
+    }
+
+    __cur += literal.size();
+    return true;
+}
+
+bool
+ipinfo::srv::stream_parser::__skip_composite()
+{
+    // Nested values aren't needed, brackets are just
+    // counted. Strings are read to skip brackets in them.
+
+    std::size_t depth{ 0u };
+
+    do
+    {
+        __skip_spaces();
+
+        if (__cur == __end)
+        {
+            return __fail("Unterminated object or array");
+        }
+
+        switch (*__cur)
+        {
+            case '"':
+            {
+                std::string_view raw{};
+                bool is_escaped{ false };
+
+                if (not __read_string(raw, is_escaped))
+                {
+                    return false;
+                }
+
+                continue;
+            }
+
+            case '{': case '[': depth += 1u; break;
+            case '}': case ']': depth -= 1u; break;
+
+            default: break;
+        }
+
+        __cur += 1;
+    }
+    while (0u != depth);
+
+    return true;
+}
+
+bool
+ipinfo::srv::stream_parser::__read_token(__token &tkn)
+{
+    __skip_spaces();
+
+    if (__cur == __end)
+    {
+        return __fail("A value is expected");
+    }
+
+    tkn.is_escaped = false;
+
+    switch (*__cur)
+    {
+        case '"':
+        {
+            bool is_escaped{ false };
+            tkn.id = __TOKENS_IDS::STRING;
+
+            const bool res{ __read_string(tkn.text, is_escaped) };
+            tkn.is_escaped = is_escaped;
+
+            return res;
+        }
+
+        case '{': case '[':
+            tkn.id = __TOKENS_IDS::COMPOSITE;
+            return __skip_composite();
+
+        case 't':
+            tkn.id = __TOKENS_IDS::LITERAL_TRUE;
+            return __read_literal("true");
+
+        case 'f':
+            tkn.id = __TOKENS_IDS::LITERAL_FALSE;
+            return __read_literal("false");
+
+        case 'n':
+            tkn.id = __TOKENS_IDS::LITERAL_NULL;
+            return __read_literal("null");
+
+        default: break;
+    }
+
+    const char * const first{ __cur };
+
+    while (__cur != __end and (('0' <= *__cur and *__cur <= '9') or
+        '-' == *__cur or '+' == *__cur or '.' == *__cur or
+        'e' == *__cur or 'E' == *__cur))
+    {
+        __cur += 1;
+    }
+
+    if (first == __cur)
+    {
+        return __fail("Unexpected character");
+    }
+
+    tkn.id = __TOKENS_IDS::NUMBER;
+    tkn.text = { first, static_cast<std::size_t>(__cur - first) };
+
+    return true;
+}
+
+bool
+ipinfo::srv::stream_parser::__fail(const std::string &desc)
+{
+    __error = {
+        .code{ constants::ERRORS_IDS::FAILED_JSON_PARSING },
+        .desc{ desc + " at position " + std::to_string(__cur - __first) }
+    };
+
+    return false;
+}
+
+bool
+ipinfo::srv::stream_parser::__fill_node(
+    str_node &node,
+    const __token &tkn,
+    const std::uint8_t host_id)
+{
+    if (__TOKENS_IDS::STRING != tkn.id or tkn.text.empty())
+    {
+        return false;
+    }
+
+    std::string &val{ node.cont[host_id] };
+
+    if (tkn.is_escaped)
+    {
+        __unescape(tkn.text, val);
+    }
+    else
+    {
+        val.assign(tkn.text);
+    }
+
+    return true;
+}
+
+bool
+ipinfo::srv::stream_parser::__fill_node(
+    i32_node &node,
+    const __token &tkn,
+    const std::uint8_t host_id)
+{
+    std::int32_t &val{ node.cont[host_id] };
+
+    if (__TOKENS_IDS::STRING == tkn.id)
+    {
+        return parse_number(tkn.text, val);
+    }
+
+    // Numbers are saturated as cJSON does it for 'valueint'.
+
+    double num{ 0.0 };
+
+    if (__TOKENS_IDS::NUMBER != tkn.id or not parse_number(tkn.text, num))
+    {
+        return false;
+    }
+
+    constexpr auto min{ std::numeric_limits<std::int32_t>::min() };
+    constexpr auto max{ std::numeric_limits<std::int32_t>::max() };
+
+    val =
+        num >= max ? max :
+        num <= min ? min : static_cast<std::int32_t>(num);
+
+    return true;
+}
+
+bool
+ipinfo::srv::stream_parser::__fill_node(
+    dbl_node &node,
+    const __token &tkn,
+    const std::uint8_t host_id)
+{
+    if (__TOKENS_IDS::STRING != tkn.id and __TOKENS_IDS::NUMBER != tkn.id)
+    {
+        return false;
+    }
+
+    return parse_number(tkn.text, node.cont[host_id]);
+}
+
+bool
+ipinfo::srv::stream_parser::__fill_node(
+    bool_node &node,
+    const __token &tkn,
+    const std::uint8_t host_id)
+{
+    bool &val{ node.cont[host_id] };
+
+    if (__TOKENS_IDS::STRING == tkn.id)
+    {
+        val = ("true" == tkn.text);
+        return not tkn.text.empty();
+    }
+
+    if (__TOKENS_IDS::LITERAL_TRUE == tkn.id or __TOKENS_IDS::LITERAL_FALSE == tkn.id)
+    {
+        val = (__TOKENS_IDS::LITERAL_TRUE == tkn.id);
+        return true;
+    }
+
+    return false;
+}
+
+bool
+ipinfo::srv::stream_parser::__parse_object(
+    ipinfo::srv::types::info &info,
+    const std::uint8_t host_id)
+{
+    if (not __expect('{'))
+    {
+        return __fail("An object is expected");
+    }
+
+    if (__expect('}'))
+    {
+        return true;
+    }
+
+    do
+    {
+        std::string_view key{};
+        bool is_escaped{ false };
+        __token tkn{};
+
+        if (not __read_string(key, is_escaped) or not __expect(':'))
+        {
+            return __fail("A key is expected");
+        }
+
+        if (not __read_token(tkn))
+        {
+            return false;
+        }
+
+        // Known keys never contain escaped characters.
+
+        if (is_escaped)
+        {
+            continue;
+        }
+
+        const std::uint8_t field_id{ FIELDS_TABLES[host_id].find(key) };
+
+        visit_field(info, field_id, [&] (auto &node)
+        {
+            set_parsed(info, host_id, field_id,
+                __fill_node(node, tkn, host_id));
+        });
+    }
+    while (__expect(','));
+
+    if (not __expect('}'))
+    {
+        return __fail("Unterminated object");
+    }
+
+    return true;
+}
+
+bool
+ipinfo::srv::stream_parser::__begin(
+    const std::string &json,
+    const std::uint8_t host_id)
+{
+    if (constants::AVAILABLE_HOSTS_NUM <= host_id)
+    {
+        return false;
+    }
+
+    __first = json.data();
+    __cur = json.data();
+    __end = json.data() + json.size();
+    __error = {};
+
+    if (json.empty())
+    {
+        __error = {
+            .code{ constants::ERRORS_IDS::EMPTY_JSON_STRING },
+            .desc{ "JSON string is empty" }
+        };
+
+        return false;
+    }
+
+    return true;
+}
+
+void
+ipinfo::srv::stream_parser::parse(
+    const std::string &json,
+    ipinfo::srv::types::info &info,
+    const std::string &host)
+{
+    const std::uint8_t host_id{ srv::utiler{}.get_host_id(host) };
+
+    if (not __begin(json, host_id))
+    {
+        return;
+    }
+
+    __parse_object(info, host_id);
+}
+
+void
+ipinfo::srv::stream_parser::parse_batch(
+    const std::string &json,
+    std::vector<ipinfo::srv::types::info> &infos,
+    const std::string &host)
+{
+    const std::uint8_t host_id{ srv::utiler{}.get_host_id(host) };
+
+    if (not __begin(json, host_id))
+    {
+        return;
+    }
+
+    if (not __expect('['))
+    {
+        __fail("An array is expected");
+        return;
+    }
+
+    std::size_t i{ 0u };
+
+    if (not __expect(']'))
+    {
+        do
+        {
+            if (infos.size() == i)
+            {
+                infos.resize(i + 1u);
+            }
+
+            __skip_spaces();
+
+            // Elements which aren't objects are skipped.
+
+            if (__cur != __end and '{' == *__cur)
+            {
+                if (not __parse_object(infos.at(i), host_id))
+                {
+                    return;
+                }
+            }
+            else
+            {
+                __token tkn{};
+
+                if (not __read_token(tkn))
+                {
+                    return;
+                }
+            }
+
+            i += 1u;
+        }
+        while (__expect(','));
+
+        if (not __expect(']'))
+        {
+            __fail("Unterminated array");
+        }
+    }
+
+    infos.resize(i);
+}
+
+ipinfo::usr::types::error
+ipinfo::srv::stream_parser::get_last_error() const
+{
+    return __error;
+}
@@ -0,0 +1,67 @@
+#include "../../include/ipinfo/ipinfo_constants.hpp"
+#include "../../include/ipinfo/ipinfo_tracker.hpp"
+
+#include <algorithm> // std::clamp
+#include <chrono>
+#include <cmath>     // std::abs
+#include <mutex>     // std::lock_guard
+#include <string>
+
+namespace
+{
+    // gains of RFC 6298
+    constexpr double LATENCY_GAIN{ 0.125 };
+    constexpr double DEVIATION_GAIN{ 0.25 };
+    constexpr double DEVIATION_FACTOR{ 4.0 };
+}
+
+ipinfo::srv::tracker &
+ipinfo::srv::tracker::instance()
+{
+    static tracker t{};
+    return t;
+}
+
+void
+ipinfo::srv::tracker::add_sample(
+    const std::string &host,
+    const std::chrono::milliseconds &latency)
+{
+    const auto sample{ static_cast<double>(latency.count()) };
+
+    const std::lock_guard<std::mutex> lock{ __mtx };
+    __stats &sts{ __hosts[host] };
+
+    if (not sts.has_samples)
+    {
+        sts.has_samples = true;
+        sts.latency = sample;
+        sts.deviation = sample / 2.0;
+
+        return;
+    }
+
+    sts.deviation += DEVIATION_GAIN * (std::abs(sample - sts.latency) - sts.deviation);
+    sts.latency += LATENCY_GAIN * (sample - sts.latency);
+}
+
+std::chrono::milliseconds
+ipinfo::srv::tracker::get_hedge_delay(const std::string &host)
+{
+    const std::lock_guard<std::mutex> lock{ __mtx };
+    const auto sts{ __hosts.find(host) };
+
+    if (__hosts.end() == sts or not sts->second.has_samples)
+    {
+        return constants::HEDGE_INITIAL_DELAY;
+    }
+
+    const std::chrono::milliseconds delay {
+        static_cast<std::chrono::milliseconds::rep>(
+            sts->second.latency + DEVIATION_FACTOR * sts->second.deviation)
+    };
+
+    return std::clamp(delay,
+        constants::HEDGE_MIN_DELAY,
+        constants::HEDGE_MAX_DELAY);
+}
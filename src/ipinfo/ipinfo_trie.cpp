@@ -0,0 +1,419 @@
+#include "../../include/ipinfo/ipinfo_types.hpp"
+#include "../../include/ipinfo/ipinfo_trie.hpp"
+
+#include <algorithm>   // std::stable_sort
+#include <bit>         // std::popcount
+#include <cstddef>     // std::size_t
+#include <cstdint>     // std::uint8_t, std::uint32_t, std::uint64_t, std::uintptr_t
+#include <cstring>     // std::memcpy, std::memcmp
+#include <string>      // std::string
+#include <string_view> // std::string_view
+#include <utility>     // std::move
+#include <vector>      // std::vector
+
+namespace
+{
+    constexpr char MAGIC[8]{ 'I', 'P', 'I', 'N', 'F', 'O', 'T', '\0' };
+    constexpr std::uint32_t VERSION{ 1u };
+
+    // IPv4 is mapped to '::ffff:0:0/96'
+    constexpr std::uint64_t V4_MAPPED_LO{ std::uint64_t{ 0xFFFFu } << 32u };
+    constexpr std::uint8_t V4_MAPPED_LEN{ 96u };
+
+    constexpr std::uint64_t get_mask(const std::size_t bits_num)
+    {
+        return (0u == bits_num) ? 0u : (~std::uint64_t{ 0u } << (64u - bits_num));
+    }
+
+    // the first 'len' bits of both addresses are equal
+    bool is_same_prefix(
+        const std::uint64_t a_hi,
+        const std::uint64_t a_lo,
+        const std::uint64_t b_hi,
+        const std::uint64_t b_lo,
+        const std::size_t len)
+    {
+        if (64u >= len)
+        {
+            return 0u == ((a_hi ^ b_hi) & get_mask(len));
+        }
+
+        return a_hi == b_hi and 0u == ((a_lo ^ b_lo) & get_mask(len - 64u));
+    }
+
+    // the slots up to the index, its one included (all of them for 63)
+    std::uint64_t get_slots_mask(const std::uint32_t index)
+    {
+        return (std::uint64_t{ 2u } << index) - 1u;
+    }
+}
+
+ipinfo::srv::trie::trie(std::vector<prefix> prefixes)
+{
+    build(std::move(prefixes));
+}
+
+std::size_t
+ipinfo::srv::trie::__to_family(std::uint64_t &hi, std::uint64_t &lo)
+{
+    if (0u == hi and V4_MAPPED_LO == (lo & ~std::uint64_t{ 0xFFFFFFFFu }))
+    {
+        hi = lo << 32u;
+        lo = 0u;
+
+        return 0u;
+    }
+
+    return __TOP_SIZE;
+}
+
+std::uint32_t
+ipinfo::srv::trie::__get_bits(
+    const std::uint64_t hi,
+    const std::uint64_t lo,
+    const std::size_t offset,
+    const std::size_t bits_num)
+{
+    if (64u <= offset)
+    {
+        return static_cast<std::uint32_t>((lo << (offset - 64u)) >> (64u - bits_num));
+    }
+
+    // the bits may be split between the halves
+    const std::uint64_t window{ (0u == offset) ? hi : ((hi << offset) | (lo >> (64u - offset))) };
+
+    return static_cast<std::uint32_t>(window >> (64u - bits_num));
+}
+
+std::uint32_t
+ipinfo::srv::trie::__add_draft(
+    std::vector<__draft> &drafts,
+    const std::uint32_t value)
+{
+    drafts.emplace_back();
+
+    for (std::uint32_t &slot : drafts.back().values)
+    {
+        slot = value;
+    }
+
+    return static_cast<std::uint32_t>(drafts.size() - 1u);
+}
+
+void
+ipinfo::srv::trie::__insert(
+    std::vector<std::uint32_t> &table,
+    std::vector<std::uint32_t> &table_children,
+    std::vector<__draft> &drafts,
+    const std::size_t table_offset,
+    const prefix &pfx)
+{
+    // A prefix covers a power of two of slots at the level where it
+    // ends. Shorter prefixes are inserted before, so it overwrites
+    // them, and nodes below got their values when they were added.
+
+    const std::uint32_t top{ __get_bits(pfx.hi, pfx.lo, 0u, __TOP_BITS) };
+
+    if (__TOP_BITS >= pfx.len)
+    {
+        const std::uint32_t slots_num{ std::uint32_t{ 1u } << (__TOP_BITS - pfx.len) };
+        const std::uint32_t first{ top & ~(slots_num - 1u) };
+
+        for (std::uint32_t i{ 0u }; i < slots_num; i++)
+        {
+            table[table_offset + first + i] = pfx.value;
+        }
+
+        return;
+    }
+
+    std::uint32_t &top_child{ table_children[table_offset + top] };
+
+    if (0u == top_child)
+    {
+        top_child = __add_draft(drafts, table[table_offset + top]) + 1u;
+    }
+
+    std::uint32_t node{ top_child - 1u };
+    std::size_t offset{ __TOP_BITS };
+
+    while (offset + __STRIDE < pfx.len)
+    {
+        const std::uint32_t index{ __get_bits(pfx.hi, pfx.lo, offset, __STRIDE) };
+
+        if (0u == drafts[node].children[index])
+        {
+            // the vector may grow, so the draft is indexed again
+            const std::uint32_t child{ __add_draft(drafts, drafts[node].values[index]) };
+            drafts[node].children[index] = child + 1u;
+        }
+
+        node = drafts[node].children[index] - 1u;
+        offset += __STRIDE;
+    }
+
+    const std::uint32_t index{ __get_bits(pfx.hi, pfx.lo, offset, __STRIDE) };
+    const std::uint32_t slots_num{ std::uint32_t{ 1u } << (offset + __STRIDE - pfx.len) };
+    const std::uint32_t first{ index & ~(slots_num - 1u) };
+
+    for (std::uint32_t i{ 0u }; i < slots_num; i++)
+    {
+        drafts[node].values[first + i] = pfx.value;
+    }
+}
+
+void
+ipinfo::srv::trie::__set_own()
+{
+    __table = __own_table.data();
+    __nodes = __own_nodes.data();
+    __leaves = __own_leaves.data();
+    __nodes_num = __own_nodes.size();
+    __leaves_num = __own_leaves.size();
+}
+
+void
+ipinfo::srv::trie::build(std::vector<prefix> prefixes)
+{
+    std::stable_sort(prefixes.begin(), prefixes.end(), [] (const prefix &a, const prefix &b)
+    {
+        return a.len < b.len;
+    });
+
+    std::vector<std::uint32_t> table(2u * __TOP_SIZE, NO_VALUE);
+    std::vector<std::uint32_t> table_children(2u * __TOP_SIZE, 0u);
+    std::vector<__draft> drafts{};
+
+    for (const prefix &pfx : prefixes)
+    {
+        if (NO_VALUE == pfx.value or 0u != (pfx.value & __NODE_BIT) or 128u < pfx.len)
+        {
+            continue;
+        }
+
+        if (V4_MAPPED_LEN <= pfx.len and is_same_prefix(pfx.hi, pfx.lo, 0u, V4_MAPPED_LO, V4_MAPPED_LEN))
+        {
+            __insert(table, table_children, drafts, 0u, {
+                .hi{ pfx.lo << 32u },
+                .lo{ 0u },
+                .len{ static_cast<std::uint8_t>(pfx.len - V4_MAPPED_LEN) },
+                .value{ pfx.value }
+            });
+
+            continue;
+        }
+
+        // a short IPv6 prefix may cover all of IPv4
+        if (is_same_prefix(pfx.hi, pfx.lo, 0u, V4_MAPPED_LO, pfx.len))
+        {
+            __insert(table, table_children, drafts, 0u, {
+                .len{ 0u },
+                .value{ pfx.value }
+            });
+        }
+
+        __insert(table, table_children, drafts, __TOP_SIZE, pfx);
+    }
+
+    // Nodes are written by levels, so a node's children are next to
+    // each other and one index with a popcount finds any of them.
+
+    std::vector<std::uint32_t> order{};
+    order.reserve(drafts.size());
+
+    for (std::size_t i{ 0u }; i < table.size(); i++)
+    {
+        if (0u != table_children[i])
+        {
+            table[i] = __NODE_BIT | static_cast<std::uint32_t>(order.size());
+            order.push_back(table_children[i] - 1u);
+        }
+    }
+
+    __own_nodes.clear();
+    __own_nodes.reserve(drafts.size());
+    __own_leaves.clear();
+
+    for (std::size_t i{ 0u }; i < order.size(); i++)
+    {
+        const __draft &draft{ drafts[order[i]] };
+
+        __node node {
+            .children_base{ static_cast<std::uint32_t>(order.size()) },
+            .leaves_base{ static_cast<std::uint32_t>(__own_leaves.size()) }
+        };
+
+        for (std::uint32_t slot{ 0u }; slot < __SLOTS_NUM; slot++)
+        {
+            const std::uint64_t bit{ std::uint64_t{ 1u } << slot };
+
+            if (0u != draft.children[slot])
+            {
+                node.children |= bit;
+                order.push_back(draft.children[slot] - 1u);
+            }
+            else if (node.leaves_base == __own_leaves.size() or draft.values[slot] != __own_leaves.back())
+            {
+                node.runs |= bit;
+                __own_leaves.push_back(draft.values[slot]);
+            }
+        }
+
+        __own_nodes.push_back(node);
+    }
+
+    __own_table = std::move(table);
+    __set_own();
+}
+
+void
+ipinfo::srv::trie::serialize(std::string &out) const
+{
+    __header hdr {
+        .version{ VERSION },
+        .nodes_num{ __nodes_num },
+        .leaves_num{ __leaves_num }
+    };
+
+    std::memcpy(hdr.magic, MAGIC, sizeof(MAGIC));
+
+    out.append(reinterpret_cast<const char *>(&hdr), sizeof(hdr));
+
+    // a trie which isn't built has no prefixes
+    if (nullptr == __table)
+    {
+        out.append(2u * __TOP_SIZE * sizeof(std::uint32_t), '\0');
+    }
+    else
+    {
+        out.append(reinterpret_cast<const char *>(__table), 2u * __TOP_SIZE * sizeof(std::uint32_t));
+    }
+
+    out.append(reinterpret_cast<const char *>(__nodes), __nodes_num * sizeof(__node));
+    out.append(reinterpret_cast<const char *>(__leaves), __leaves_num * sizeof(std::uint32_t));
+}
+
+bool
+ipinfo::srv::trie::view(const std::string_view data)
+{
+    __header hdr{};
+
+    const std::size_t table_size{ 2u * __TOP_SIZE * sizeof(std::uint32_t) };
+
+    if (0u != reinterpret_cast<std::uintptr_t>(data.data()) % alignof(__node) or
+        sizeof(hdr) + table_size > data.size())
+    {
+        return false;
+    }
+
+    std::memcpy(&hdr, data.data(), sizeof(hdr));
+
+    const std::size_t rest{ data.size() - sizeof(hdr) - table_size };
+
+    if (0 != std::memcmp(hdr.magic, MAGIC, sizeof(MAGIC)) or VERSION != hdr.version or
+        __NODE_BIT <= hdr.nodes_num or hdr.nodes_num > rest / sizeof(__node) or
+        hdr.leaves_num > (rest - hdr.nodes_num * sizeof(__node)) / sizeof(std::uint32_t))
+    {
+        return false;
+    }
+
+    const auto *table{ reinterpret_cast<const std::uint32_t *>(data.data() + sizeof(hdr)) };
+    const auto *nodes{ reinterpret_cast<const __node *>(data.data() + sizeof(hdr) + table_size) };
+
+    const auto *leaves {
+        reinterpret_cast<const std::uint32_t *>(
+            data.data() + sizeof(hdr) + table_size + hdr.nodes_num * sizeof(__node))
+    };
+
+    // Lookups don't check indexes, so they're checked here. Children
+    // are after their parents, so lookups can't loop.
+
+    for (std::size_t i{ 0u }; i < 2u * __TOP_SIZE; i++)
+    {
+        if (0u != (table[i] & __NODE_BIT) and (table[i] & ~__NODE_BIT) >= hdr.nodes_num)
+        {
+            return false;
+        }
+    }
+
+    for (std::size_t i{ 0u }; i < hdr.nodes_num; i++)
+    {
+        const __node &node{ nodes[i] };
+        const std::uint64_t leaf_slots{ ~node.children };
+
+        if (0u != (node.runs & node.children) or
+            (0u != leaf_slots and 0u == (node.runs & leaf_slots & (~leaf_slots + 1u))) or
+            (0u != node.children and
+                (i >= node.children_base or
+                node.children_base + static_cast<std::uint64_t>(std::popcount(node.children)) > hdr.nodes_num)) or
+            node.leaves_base + static_cast<std::uint64_t>(std::popcount(node.runs)) > hdr.leaves_num)
+        {
+            return false;
+        }
+    }
+
+    __own_table.clear();
+    __own_nodes.clear();
+    __own_leaves.clear();
+
+    __table = table;
+    __nodes = nodes;
+    __leaves = leaves;
+    __nodes_num = static_cast<std::size_t>(hdr.nodes_num);
+    __leaves_num = static_cast<std::size_t>(hdr.leaves_num);
+
+    return true;
+}
+
+std::uint32_t
+ipinfo::srv::trie::find(std::uint64_t hi, std::uint64_t lo) const
+{
+    if (nullptr == __table)
+    {
+        return NO_VALUE;
+    }
+
+    const std::size_t table_offset{ __to_family(hi, lo) };
+    std::uint32_t entry{ __table[table_offset + __get_bits(hi, lo, 0u, __TOP_BITS)] };
+
+    // a node deeper than the address is possible only in a broken file
+    for (std::size_t offset{ __TOP_BITS }; 0u != (entry & __NODE_BIT) and 128u > offset; offset += __STRIDE)
+    {
+        const __node &node{ __nodes[entry & ~__NODE_BIT] };
+
+        const std::uint32_t index{ __get_bits(hi, lo, offset, __STRIDE) };
+        const std::uint64_t mask{ get_slots_mask(index) };
+
+        if (0u == ((node.children >> index) & 1u))
+        {
+            return __leaves[node.leaves_base + static_cast<std::uint32_t>(std::popcount(node.runs & mask)) - 1u];
+        }
+
+        entry = __NODE_BIT | (node.children_base + static_cast<std::uint32_t>(std::popcount(node.children & mask)) - 1u);
+    }
+
+    return (0u != (entry & __NODE_BIT)) ? NO_VALUE : entry;
+}
+
+std::uint32_t
+ipinfo::srv::trie::find(const ipinfo::srv::types::address &addr) const
+{
+    std::uint64_t hi{ 0u }, lo{ 0u };
+
+    for (std::size_t i{ 0u }; i < 8u; i++)
+    {
+        hi = (hi << 8u) | addr.bytes[i];
+        lo = (lo << 8u) | addr.bytes[i + 8u];
+    }
+
+    return find(hi, lo);
+}
+
+std::size_t
+ipinfo::srv::trie::get_size() const
+{
+    return
+        ((nullptr == __table) ? 0u : 2u * __TOP_SIZE * sizeof(std::uint32_t)) +
+        __nodes_num * sizeof(__node) +
+        __leaves_num * sizeof(std::uint32_t);
+}
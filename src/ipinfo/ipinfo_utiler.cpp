@@ -5,58 +5,18 @@
 #include <cmath>     // std::pow, std::round
 #include <cstdint>   // std::uint8_t
 #include <locale>    // std::tolower
-#include <algorithm> // std::find
+#include <cstddef>   // std::size_t
+#include <string>    // std::string, std::to_string
+#include <algorithm> // std::find, std::min
+#include <iterator>  // std::distance
 
-template<template<typename ...> class T, typename sub_T> void
-ipinfo::srv::utiler::__clear_node(T<sub_T> &node) const
-{
-    for (const std::string &host : constants::AVAILABLE_HOSTS)
-    {
-        auto &content{ node.cont.at(host) };
-
-        content.val = {};
-        content.is_parsed = false;
-    }
-
-    return;
-}
+#include <arpa/inet.h> // inet_pton, inet_ntop
 
 void
 ipinfo::srv::utiler::clear_info(ipinfo::srv::types::info &info) const
 {
-    __clear_node(info.ip);
-    __clear_node(info.ip_type);
-    __clear_node(info.reverse_dns);
-    __clear_node(info.continent);
-    __clear_node(info.continent_code);
-    __clear_node(info.country);
-    __clear_node(info.country_capital);
-    __clear_node(info.country_ph_code);
-    __clear_node(info.country_neighbors);
-    __clear_node(info.region);
-    __clear_node(info.region_code);
-    __clear_node(info.city);
-    __clear_node(info.city_district);
-    __clear_node(info.city_timezone);
-    __clear_node(info.zip_code);
-    __clear_node(info.latitude);
-    __clear_node(info.longitude);
-    __clear_node(info.gmt_offset);
-    __clear_node(info.dst_offset);
-    __clear_node(info.timezone_gmt);
-    __clear_node(info.isp);
-    __clear_node(info.as);
-    __clear_node(info.org);
-    __clear_node(info.is_hosting);
-    __clear_node(info.is_proxy);
-    __clear_node(info.is_mobile);
-    __clear_node(info.currency);
-    __clear_node(info.currency_code);
-    __clear_node(info.currency_symbol);
-    __clear_node(info.currency_rates);
-    __clear_node(info.currency_plural);
-
-    return;
+    // every field of every host is invalidated at once
+    info.parsed.fill(0u);
 }
 
 double
@@ -68,6 +28,15 @@ ipinfo::srv::utiler::round_val(
     return std::round(value * n) / n;
 }
 
+std::uint8_t
+ipinfo::srv::utiler::get_host_id(const std::string &host) const
+{
+    const auto &avl_hosts{ constants::AVAILABLE_HOSTS };
+    const auto res{ std::find(avl_hosts.begin(), avl_hosts.end(), host) };
+
+    return static_cast<std::uint8_t>(std::distance(avl_hosts.begin(), res));
+}
+
 bool
 ipinfo::srv::utiler::is_host_supported(const std::string &host) const
 {
@@ -122,3 +91,94 @@ ipinfo::srv::utiler::to_lower_case(const std::string &s) const
 
     return lc_s;
 }
+
+std::string
+ipinfo::srv::utiler::url_encode(const std::string &s) const
+{
+    constexpr char hex[]{ "0123456789ABCDEF" };
+    std::string enc_s{};
+
+    enc_s.reserve(s.size());
+
+    for (const char c : s)
+    {
+        const auto uc{ static_cast<unsigned char>(c) };
+
+        if (std::isalnum(uc) or '-' == c or '.' == c or '_' == c or '~' == c)
+        {
+            enc_s += c;
+            continue;
+        }
+
+        enc_s += '%';
+        enc_s += hex[uc >> 4u];
+        enc_s += hex[uc & 0x0Fu];
+    }
+
+    return enc_s;
+}
+
+bool
+ipinfo::srv::utiler::parse_address(
+    const std::string &ip,
+    ipinfo::srv::types::address &addr) const
+{
+    addr = {};
+
+    // only IPv6 has colons, so the address is parsed once
+    if (std::string::npos != ip.find(':'))
+    {
+        return 1 == ::inet_pton(AF_INET6, ip.c_str(), addr.bytes.data());
+    }
+
+    if (1 == ::inet_pton(AF_INET, ip.c_str(), addr.bytes.data() + 12u))
+    {
+        addr.bytes[10] = 0xFFu;
+        addr.bytes[11] = 0xFFu;
+        addr.is_v4 = true;
+
+        return true;
+    }
+
+    return false;
+}
+
+void
+ipinfo::srv::utiler::mask_address(
+    ipinfo::srv::types::address &addr,
+    const std::uint8_t prefix_len) const
+{
+    const std::size_t bits_num {
+        std::min<std::size_t>(addr.is_v4 ? 96u + prefix_len : prefix_len, 128u)
+    };
+
+    for (std::size_t i{ 0u }; i < addr.bytes.size(); i++)
+    {
+        if (8u * (i + 1u) <= bits_num)
+        {
+            continue;
+        }
+
+        const std::size_t kept{ (8u * i < bits_num) ? bits_num - 8u * i : 0u };
+        addr.bytes[i] &= static_cast<std::uint8_t>(0xFFu << (8u - kept));
+    }
+}
+
+std::string
+ipinfo::srv::utiler::format_network(
+    const ipinfo::srv::types::address &addr,
+    const std::uint8_t prefix_len) const
+{
+    char buf[INET6_ADDRSTRLEN]{};
+
+    if (addr.is_v4)
+    {
+        ::inet_ntop(AF_INET, addr.bytes.data() + 12u, buf, sizeof(buf));
+    }
+    else
+    {
+        ::inet_ntop(AF_INET6, addr.bytes.data(), buf, sizeof(buf));
+    }
+
+    return std::string{ buf } + '/' + std::to_string(prefix_len);
+}
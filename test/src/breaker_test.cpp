@@ -0,0 +1,179 @@
+#include <ipinfo/ipinfo_breaker.hpp>   // ipinfo::srv::breaker
+#include <ipinfo/ipinfo_constants.hpp> // ipinfo::constants
+
+#include <fmt/core.h>                  // fmt::print
+#include <chrono>
+#include <cstddef>                     // std::size_t
+#include <string>                      // std::string
+#include <thread>                      // std::this_thread
+
+// Circuits of made-up hosts are walked through all the states: a host
+// is closed until its failures in a row reach the threshold, an open
+// one is skipped until the cooldown is over, then one probe is let
+// through and its result closes or opens the circuit again. A probe
+// which is aborted lets the next one through.
+
+namespace test
+{
+    using breaker = ipinfo::srv::breaker;
+    using ipinfo::constants::BREAKER_STATES_IDS;
+
+    constexpr std::chrono::milliseconds COOLDOWN{ 50 };
+
+    static std::size_t failures_num{ 0u };
+
+    static void
+    check(const bool is_ok,
+          const std::string &what);
+
+    static void
+    fail(const std::string &host,
+         const std::size_t n);
+
+    static void
+    check_threshold();
+
+    static void
+    check_probes();
+
+    static void
+    check_hosts();
+}
+
+int
+main()
+{
+    test::breaker::instance().set_threshold(3u);
+    test::breaker::instance().set_cooldown(test::COOLDOWN);
+
+    test::check_threshold();
+    test::check_probes();
+    test::check_hosts();
+
+    if (0u != test::failures_num)
+    {
+        fmt::print("breaker: {:d} checks failed\n", test::failures_num);
+        return 1;
+    }
+
+    fmt::print("breaker: all checks passed\n");
+    return 0;
+}
+
+void
+test::check(
+        const bool is_ok,
+        const std::string &what)
+{
+    if (not is_ok)
+    {
+        failures_num += 1u;
+
+        if (10u >= failures_num)
+        {
+            fmt::print("failed: {:s}\n", what);
+        }
+    }
+}
+
+void
+test::fail(
+        const std::string &host,
+        const std::size_t n)
+{
+    for (std::size_t i{ 0u }; i < n; i++)
+    {
+        breaker::instance().on_failure(host);
+    }
+}
+
+void
+test::check_threshold()
+{
+    breaker &brkr{ breaker::instance() };
+    const std::string host{ "threshold.test" };
+
+    check(BREAKER_STATES_IDS::CLOSED == brkr.get_state(host), "a new host is closed");
+    check(brkr.allow(host) and brkr.allow(host), "a closed host is requested");
+
+    // failures count in a row, a success resets them
+    fail(host, 2u);
+    check(BREAKER_STATES_IDS::CLOSED == brkr.get_state(host), "a host is closed below the threshold");
+
+    brkr.on_success(host);
+    fail(host, 2u);
+    check(BREAKER_STATES_IDS::CLOSED == brkr.get_state(host), "a success resets the failures");
+
+    fail(host, 1u);
+    check(BREAKER_STATES_IDS::OPEN == brkr.get_state(host), "a host is opened at the threshold");
+    check(not brkr.allow(host), "an open host isn't requested");
+
+    // the threshold is taken by the next failure
+    const std::string other_host{ "low-threshold.test" };
+
+    brkr.set_threshold(1u);
+    fail(other_host, 1u);
+    brkr.set_threshold(3u);
+
+    check(BREAKER_STATES_IDS::OPEN == brkr.get_state(other_host), "a lower threshold opens a host earlier");
+}
+
+void
+test::check_probes()
+{
+    breaker &brkr{ breaker::instance() };
+    const std::string host{ "probe.test" };
+
+    fail(host, 3u);
+    check(not brkr.allow(host), "an open host isn't requested during the cooldown");
+
+    std::this_thread::sleep_for(COOLDOWN + std::chrono::milliseconds{ 20 });
+
+    // only one probe is let through
+    check(brkr.allow(host), "a probe is let through after the cooldown");
+    check(BREAKER_STATES_IDS::HALF_OPEN == brkr.get_state(host), "a probed host is half open");
+    check(not brkr.allow(host), "the second probe isn't let through");
+
+    // an aborted probe tells nothing, the next one is let through
+    brkr.on_abort(host);
+
+    check(BREAKER_STATES_IDS::HALF_OPEN == brkr.get_state(host), "an aborted probe keeps the host half open");
+    check(brkr.allow(host), "a probe is let through after an aborted one");
+
+    // a failed probe opens the host at once, below the threshold
+    brkr.on_failure(host);
+
+    check(BREAKER_STATES_IDS::OPEN == brkr.get_state(host), "a failed probe opens the host");
+    check(not brkr.allow(host), "a host of a failed probe isn't requested during the cooldown");
+
+    std::this_thread::sleep_for(COOLDOWN + std::chrono::milliseconds{ 20 });
+
+    check(brkr.allow(host), "a probe is let through after the next cooldown");
+
+    brkr.on_success(host);
+
+    check(BREAKER_STATES_IDS::CLOSED == brkr.get_state(host), "a successful probe closes the host");
+    check(brkr.allow(host) and brkr.allow(host), "a closed host is requested again");
+
+    // the failures of the probe's run aren't kept
+    fail(host, 2u);
+    check(BREAKER_STATES_IDS::CLOSED == brkr.get_state(host), "a closed host counts failures from zero");
+}
+
+void
+test::check_hosts()
+{
+    breaker &brkr{ breaker::instance() };
+
+    const std::string failing_host{ "failing.test" };
+    const std::string healthy_host{ "healthy.test" };
+
+    fail(failing_host, 3u);
+
+    check(not brkr.allow(failing_host), "the failing host isn't requested");
+    check(BREAKER_STATES_IDS::CLOSED == brkr.get_state(healthy_host) and brkr.allow(healthy_host), "other hosts are requested");
+
+    // an abort of a closed host changes nothing
+    brkr.on_abort(healthy_host);
+    check(BREAKER_STATES_IDS::CLOSED == brkr.get_state(healthy_host), "an abort doesn't open a host");
+}
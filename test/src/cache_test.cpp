@@ -0,0 +1,782 @@
+#include <ipinfo/ipinfo_cache.hpp>     // ipinfo::usr::cache
+#include <ipinfo/ipinfo_constants.hpp> // ipinfo::constants
+#include <ipinfo/ipinfo_fields.hpp>    // ipinfo::srv::set_parsed, ipinfo::srv::is_parsed
+#include <ipinfo/ipinfo_types.hpp>
+
+#include <fmt/core.h>                  // fmt::print, fmt::format
+#include <chrono>
+#include <cstddef>                     // std::size_t
+#include <cstdint>                     // std::uint8_t
+#include <cstdio>                      // std::remove
+#include <filesystem>                  // std::filesystem::temp_directory_path
+#include <shared_mutex>                // std::shared_lock
+#include <string>                      // std::string
+#include <thread>                      // std::thread, std::this_thread
+#include <vector>                      // std::vector
+
+#include <unistd.h>                    // getpid
+
+// The cache is checked through its internals, the way informers use
+// it, so no lookup goes to the network: hits, misses and expirations,
+// the routing of keys to shards, hits of the IP's network, the file
+// which survives the cache, failed lookups of every class, concurrent
+// misses which wait for one flight, and TinyLFU, which keeps popular
+// results when a scan of new IPs passes through a full cache.
+
+namespace ipinfo::test
+{
+    // the cache's internals, it's a friend of the cache
+    struct cache_access
+    {
+        using errors_map = usr::cache::errors_map;
+        using flight_ptr = usr::cache::flight_ptr;
+
+        static bool
+        find(usr::cache &cache,
+             const std::string &ip,
+             const std::string &lang,
+             const std::uint8_t hosts_mask,
+             srv::types::info &info,
+             errors_map &errors,
+             bool &is_stale);
+
+        static void
+        insert(usr::cache &cache,
+               const std::string &ip,
+               const std::string &lang,
+               const std::uint8_t hosts_mask,
+               const srv::types::info &info,
+               const errors_map &errors);
+
+        static flight_ptr
+        join(usr::cache &cache,
+             const std::string &ip,
+             bool &is_leader);
+
+        static void
+        land(usr::cache &cache,
+             const std::string &ip,
+             const flight_ptr &flight,
+             const srv::types::info &info);
+
+        static void
+        abandon(usr::cache &cache,
+                const std::string &ip,
+                const flight_ptr &flight);
+
+        static bool
+        wait(const flight_ptr &flight,
+             const std::chrono::steady_clock::time_point &deadline,
+             srv::types::info &info);
+
+        static std::size_t
+        get_shards_num(const usr::cache &cache);
+
+        static std::size_t
+        get_shard_id(const usr::cache &cache,
+                     const std::string &ip);
+
+        static std::size_t
+        get_entries_num(const usr::cache &cache,
+                        const std::size_t shard_id);
+
+        // the key of the IP is in the shard
+        static bool
+        has_key(const usr::cache &cache,
+                const std::size_t shard_id,
+                const std::string &ip,
+                const std::string &lang,
+                const std::uint8_t hosts_mask);
+    };
+}
+
+namespace test
+{
+    using access = ipinfo::test::cache_access;
+    using errors_map = access::errors_map;
+
+    const std::string LANG{ "english" };
+    constexpr std::uint8_t HOSTS_MASK{ 1u };
+    constexpr std::size_t HOST_ID{ ipinfo::constants::AVAILABLE_HOSTS_IDS::IP_API_COM };
+
+    constexpr std::size_t MAX_BYTES{ 64u * 1024u * 1024u };
+
+    static std::size_t failures_num{ 0u };
+
+    static void
+    check(const bool is_ok,
+          const std::string &what);
+
+    // the host's address fields, the city and a flag
+    static ipinfo::srv::types::info
+    make_info(const std::string &ip,
+              const std::string &city);
+
+    static errors_map
+    make_errors(const std::uint8_t code);
+
+    // the language and the hosts are the same for all lookups
+    static bool
+    find(ipinfo::usr::cache &cache,
+         const std::string &ip,
+         ipinfo::srv::types::info &info,
+         errors_map &errors);
+
+    static bool
+    find(ipinfo::usr::cache &cache,
+         const std::string &ip);
+
+    static void
+    insert(ipinfo::usr::cache &cache,
+           const std::string &ip,
+           const ipinfo::srv::types::info &info,
+           const errors_map &errors = {});
+
+    static void
+    check_hits();
+
+    static void
+    check_shards();
+
+    static void
+    check_ranges();
+
+    static void
+    check_negative_results();
+
+    static void
+    check_file();
+
+    static void
+    check_flights();
+
+    static void
+    check_admission();
+}
+
+int
+main()
+{
+    test::check_hits();
+    test::check_shards();
+    test::check_ranges();
+    test::check_negative_results();
+    test::check_file();
+    test::check_flights();
+    test::check_admission();
+
+    if (0u != test::failures_num)
+    {
+        fmt::print("cache: {:d} checks failed\n", test::failures_num);
+        return 1;
+    }
+
+    fmt::print("cache: all checks passed\n");
+    return 0;
+}
+
+bool
+ipinfo::test::cache_access::find(
+        usr::cache &cache,
+        const std::string &ip,
+        const std::string &lang,
+        const std::uint8_t hosts_mask,
+        srv::types::info &info,
+        errors_map &errors,
+        bool &is_stale)
+{
+    return cache.__find(ip, lang, hosts_mask, info, errors, is_stale);
+}
+
+void
+ipinfo::test::cache_access::insert(
+        usr::cache &cache,
+        const std::string &ip,
+        const std::string &lang,
+        const std::uint8_t hosts_mask,
+        const srv::types::info &info,
+        const errors_map &errors)
+{
+    cache.__insert(ip, lang, hosts_mask, info, errors);
+}
+
+ipinfo::test::cache_access::flight_ptr
+ipinfo::test::cache_access::join(
+        usr::cache &cache,
+        const std::string &ip,
+        bool &is_leader)
+{
+    return cache.__join(ip, ::test::LANG, ::test::HOSTS_MASK, is_leader);
+}
+
+void
+ipinfo::test::cache_access::land(
+        usr::cache &cache,
+        const std::string &ip,
+        const flight_ptr &flight,
+        const srv::types::info &info)
+{
+    cache.__land(ip, ::test::LANG, ::test::HOSTS_MASK, flight, info, {});
+}
+
+void
+ipinfo::test::cache_access::abandon(
+        usr::cache &cache,
+        const std::string &ip,
+        const flight_ptr &flight)
+{
+    cache.__abandon(ip, ::test::LANG, ::test::HOSTS_MASK, flight);
+}
+
+bool
+ipinfo::test::cache_access::wait(
+        const flight_ptr &flight,
+        const std::chrono::steady_clock::time_point &deadline,
+        srv::types::info &info)
+{
+    errors_map errors{};
+    return usr::cache::__wait(*flight, deadline, info, errors);
+}
+
+std::size_t
+ipinfo::test::cache_access::get_shards_num(const usr::cache &cache)
+{
+    return cache.__shards_num;
+}
+
+std::size_t
+ipinfo::test::cache_access::get_shard_id(
+        const usr::cache &cache,
+        const std::string &ip)
+{
+    return static_cast<std::size_t>(&cache.__get_shard(ip) - cache.__shards.get());
+}
+
+std::size_t
+ipinfo::test::cache_access::get_entries_num(
+        const usr::cache &cache,
+        const std::size_t shard_id)
+{
+    const std::shared_lock<std::shared_mutex> lock{ cache.__shards[shard_id].mtx };
+    return cache.__shards[shard_id].entries_num;
+}
+
+bool
+ipinfo::test::cache_access::has_key(
+        const usr::cache &cache,
+        const std::size_t shard_id,
+        const std::string &ip,
+        const std::string &lang,
+        const std::uint8_t hosts_mask)
+{
+    std::string key{};
+    usr::cache::__get_key(ip, lang, hosts_mask, key);
+
+    const std::shared_lock<std::shared_mutex> lock{ cache.__shards[shard_id].mtx };
+    return cache.__shards[shard_id].index.contains(key);
+}
+
+void
+test::check(
+        const bool is_ok,
+        const std::string &what)
+{
+    if (not is_ok)
+    {
+        failures_num += 1u;
+
+        // a broken cache fails many lookups, the first ones are enough
+        if (10u >= failures_num)
+        {
+            fmt::print("failed: {:s}\n", what);
+        }
+    }
+}
+
+ipinfo::srv::types::info
+test::make_info(
+        const std::string &ip,
+        const std::string &city)
+{
+    ipinfo::srv::types::info info{};
+
+    info.ip.cont[HOST_ID] = ip;
+    info.reverse_dns.cont[HOST_ID] = "host.example.com";
+    info.city.cont[HOST_ID] = city;
+    info.is_hosting.cont[HOST_ID] = true;
+
+    ipinfo::srv::set_parsed(info, HOST_ID, ipinfo::constants::INFO_FIELDS_IDS::IP, true);
+    ipinfo::srv::set_parsed(info, HOST_ID, ipinfo::constants::INFO_FIELDS_IDS::REVERSE_DNS, true);
+    ipinfo::srv::set_parsed(info, HOST_ID, ipinfo::constants::INFO_FIELDS_IDS::CITY, true);
+    ipinfo::srv::set_parsed(info, HOST_ID, ipinfo::constants::INFO_FIELDS_IDS::IS_HOSTING, true);
+
+    return info;
+}
+
+test::errors_map
+test::make_errors(const std::uint8_t code)
+{
+    return {
+        { ipinfo::constants::AVAILABLE_HOSTS[HOST_ID], { .code{ code }, .desc{ fmt::format("error {:d}", code) } } }
+    };
+}
+
+bool
+test::find(
+        ipinfo::usr::cache &cache,
+        const std::string &ip,
+        ipinfo::srv::types::info &info,
+        errors_map &errors)
+{
+    bool is_stale{ false };
+    return access::find(cache, ip, LANG, HOSTS_MASK, info, errors, is_stale);
+}
+
+bool
+test::find(
+        ipinfo::usr::cache &cache,
+        const std::string &ip)
+{
+    ipinfo::srv::types::info info{};
+    errors_map errors{};
+
+    return find(cache, ip, info, errors);
+}
+
+void
+test::insert(
+        ipinfo::usr::cache &cache,
+        const std::string &ip,
+        const ipinfo::srv::types::info &info,
+        const errors_map &errors)
+{
+    access::insert(cache, ip, LANG, HOSTS_MASK, info, errors);
+}
+
+void
+test::check_hits()
+{
+    using namespace std::chrono_literals;
+
+    ipinfo::usr::cache cache{ 1000u, MAX_BYTES, 100ms, 4u };
+    cache.set_range_prefixes(0u, 0u);
+
+    insert(cache, "13.0.0.1", make_info("13.0.0.1", "Berlin"));
+
+    ipinfo::srv::types::info info{};
+    errors_map errors{};
+    bool is_stale{ false };
+
+    check(find(cache, "13.0.0.1", info, errors), "a result is found");
+    check("Berlin" == info.city.cont[HOST_ID] and info.is_hosting.cont[HOST_ID] and errors.empty(), "the found result is the inserted one");
+
+    check(not access::find(cache, "13.0.0.1", "german", HOSTS_MASK, info, errors, is_stale), "a result isn't found by another language");
+    check(not access::find(cache, "13.0.0.1", LANG, 3u, info, errors, is_stale), "a result isn't found by other hosts");
+    check(not find(cache, "13.0.0.2"), "a result isn't found by another IP");
+
+    ipinfo::usr::types::cache_stats stats{ cache.get_stats() };
+    check(1u == stats.hits and 3u == stats.misses and 1u == stats.entries, "hits, misses and entries are counted");
+
+    std::this_thread::sleep_for(150ms);
+
+    check(not find(cache, "13.0.0.1"), "an expired result isn't found");
+    check(1u == cache.get_stats().expirations, "the expiration is counted");
+
+    // the expired entry is replaced, not added
+    insert(cache, "13.0.0.1", make_info("13.0.0.1", "Hamburg"));
+
+    check(find(cache, "13.0.0.1", info, errors) and "Hamburg" == info.city.cont[HOST_ID], "an expired result is replaced");
+    check(1u == cache.get_stats().entries, "the replaced result isn't kept");
+
+    // a result is stale at once without the soft TTL, one hit refreshes it
+    ipinfo::usr::cache stale_cache{ 1000u, MAX_BYTES, 1h, 4u };
+    stale_cache.set_soft_ttl(0ms);
+    insert(stale_cache, "13.0.0.1", make_info("13.0.0.1", "Berlin"));
+
+    check(access::find(stale_cache, "13.0.0.1", LANG, HOSTS_MASK, info, errors, is_stale) and is_stale, "a stale result is refreshed");
+    check(access::find(stale_cache, "13.0.0.1", LANG, HOSTS_MASK, info, errors, is_stale) and not is_stale, "a stale result is refreshed once");
+    check(1u == stale_cache.get_stats().refreshes, "the refresh is counted");
+
+    // the second chance: a referenced result outlives an older one
+    ipinfo::usr::cache small_cache{ 4u, MAX_BYTES, 1h, 1u };
+    small_cache.set_range_prefixes(0u, 0u);
+
+    for (std::size_t i{ 0u }; i < 4u; i++)
+    {
+        insert(small_cache, fmt::format("13.0.0.{:d}", i), make_info("", "Berlin"));
+    }
+
+    check(find(small_cache, "13.0.0.0"), "the oldest result is found");
+    insert(small_cache, "13.0.0.4", make_info("", "Berlin"));
+
+    stats = small_cache.get_stats();
+
+    check(4u == stats.entries and 1u == stats.evictions, "a full cache evicts a result");
+    check(find(small_cache, "13.0.0.0") and not find(small_cache, "13.0.0.1"), "the referenced result gets the second chance");
+}
+
+void
+test::check_shards()
+{
+    using namespace std::chrono_literals;
+
+    // the number of shards is rounded up to a power of two
+    ipinfo::usr::cache cache{ 100000u, MAX_BYTES, 1h, 5u };
+    cache.set_range_prefixes(0u, 0u);
+
+    const std::size_t shards_num{ access::get_shards_num(cache) };
+    check(8u == shards_num, "the number of shards is a power of two");
+
+    const std::size_t ips_num{ 4096u };
+
+    for (std::size_t i{ 0u }; i < ips_num; i++)
+    {
+        const std::string ip{ fmt::format("13.0.{:d}.{:d}", i >> 8u, i & 0xFFu) };
+
+        insert(cache, ip, make_info(ip, "Berlin"));
+        access::insert(cache, ip, "german", HOSTS_MASK, make_info(ip, "Berlin"), {});
+    }
+
+    // all results of an IP are in its shard, so it's invalidated by one shard
+    for (std::size_t i{ 0u }; i < ips_num; i += 97u)
+    {
+        const std::string ip{ fmt::format("13.0.{:d}.{:d}", i >> 8u, i & 0xFFu) };
+        const std::size_t id{ access::get_shard_id(cache, ip) };
+
+        check(access::has_key(cache, id, ip, LANG, HOSTS_MASK) and access::has_key(cache, id, ip, "german", HOSTS_MASK),
+            fmt::format("results of {:s} are in its shard", ip));
+    }
+
+    // IPs are spread evenly enough, so shards' locks are shared
+    for (std::size_t id{ 0u }; id < shards_num; id++)
+    {
+        const std::size_t mean{ 2u * ips_num / shards_num };
+        const std::size_t n{ access::get_entries_num(cache, id) };
+
+        check(mean / 2u <= n and n <= 2u * mean, fmt::format("the shard {:d} has {:d} results of {:d} on average", id, n, mean));
+    }
+
+    cache.invalidate("13.0.0.1");
+
+    ipinfo::srv::types::info info{};
+    errors_map errors{};
+    bool is_stale{ false };
+
+    check(not find(cache, "13.0.0.1") and not access::find(cache, "13.0.0.1", "german", HOSTS_MASK, info, errors, is_stale),
+        "the invalidated IP has no results");
+
+    check(find(cache, "13.0.0.2"), "results of other IPs aren't invalidated");
+
+    // the limit of entries is split between the shards
+    ipinfo::usr::cache small_cache{ 10u, MAX_BYTES, 1h, 4u };
+    small_cache.set_range_prefixes(0u, 0u);
+
+    for (std::size_t i{ 0u }; i < 100u; i++)
+    {
+        insert(small_cache, fmt::format("13.0.0.{:d}", i), make_info("", "Berlin"));
+    }
+
+    for (std::size_t id{ 0u }; id < access::get_shards_num(small_cache); id++)
+    {
+        check(3u == access::get_entries_num(small_cache, id), fmt::format("the shard {:d} has its part of the limit", id));
+    }
+}
+
+void
+test::check_ranges()
+{
+    ipinfo::usr::cache cache{};
+
+    insert(cache, "93.184.216.34", make_info("93.184.216.34", "Berlin"));
+
+    ipinfo::srv::types::info info{};
+    errors_map errors{};
+
+    check(find(cache, "93.184.216.200", info, errors), "an IP of the /24 network is found");
+    check("Berlin" == info.city.cont[HOST_ID] and "93.184.216.200" == info.ip.cont[HOST_ID], "the network's result has the IP's address");
+    check(not ipinfo::srv::is_parsed(info, HOST_ID, ipinfo::constants::INFO_FIELDS_IDS::REVERSE_DNS), "the neighbour's reverse DNS isn't taken");
+    check(1u == cache.get_stats().range_hits, "the range hit is counted");
+
+    check(not find(cache, "93.184.217.1"), "an IP of another /24 network isn't found");
+
+    insert(cache, "2a00:1450:4001:81c::200e", make_info("2a00:1450:4001:81c::200e", "Frankfurt"));
+
+    check(find(cache, "2a00:1450:4001:ffff::1", info, errors) and "Frankfurt" == info.city.cont[HOST_ID], "an IP of the /48 network is found");
+    check(not find(cache, "2a00:1450:4002::1"), "an IP of another /48 network isn't found");
+
+    // a failed lookup belongs to the IP only
+    insert(cache, "94.1.1.1", {}, make_errors(ipinfo::constants::ERRORS_IDS::INVALID_QUERY));
+
+    check(find(cache, "94.1.1.1"), "a failed lookup is found");
+    check(not find(cache, "94.1.1.2"), "a failed lookup isn't shared by the network");
+
+    // results of other lengths aren't found after the change
+    cache.set_range_prefixes(16u, 0u);
+
+    check(not find(cache, "93.184.216.200"), "a result of the old length isn't found");
+    check(not find(cache, "2a00:1450:4001:ffff::2"), "a disabled range cache finds nothing");
+
+    insert(cache, "93.184.216.34", make_info("93.184.216.34", "Berlin"));
+    check(find(cache, "93.184.1.1"), "an IP of the /16 network is found");
+
+    cache.invalidate("93.184.216.34");
+    check(not find(cache, "93.184.1.1"), "the invalidated IP's network has no result");
+}
+
+void
+test::check_negative_results()
+{
+    using namespace std::chrono_literals;
+    using ipinfo::constants::ERRORS_IDS;
+
+    ipinfo::usr::cache cache{};
+    cache.set_range_prefixes(0u, 0u);
+    cache.set_negative_ttl(ipinfo::constants::NEGATIVE_CACHE_CLASSES_IDS::THROTTLED, 50ms);
+
+    insert(cache, "13.0.0.1", {}, make_errors(ERRORS_IDS::INVALID_QUERY));
+    insert(cache, "13.0.0.2", {}, make_errors(ERRORS_IDS::FAILED_LOOKUP));
+    insert(cache, "13.0.0.3", {}, make_errors(ERRORS_IDS::THROTTLED_REQUEST));
+
+    // the shortest TTL of the errors' classes is taken
+    errors_map mixed{ make_errors(ERRORS_IDS::INVALID_QUERY) };
+    mixed[ipinfo::constants::AVAILABLE_HOSTS[1u]] = { .code{ ERRORS_IDS::THROTTLED_REQUEST } };
+
+    insert(cache, "13.0.0.4", {}, mixed);
+
+    // errors which aren't classified aren't cached
+    errors_map transient{ make_errors(ERRORS_IDS::INVALID_QUERY) };
+    transient[ipinfo::constants::AVAILABLE_HOSTS[1u]] = { .code{ ERRORS_IDS::REQUEST_TIMEOUT } };
+
+    insert(cache, "13.0.0.5", {}, make_errors(ERRORS_IDS::REQUEST_TIMEOUT));
+    insert(cache, "13.0.0.6", {}, transient);
+
+    ipinfo::srv::types::info info{};
+    errors_map errors{};
+
+    check(find(cache, "13.0.0.1", info, errors), "an invalid query is cached");
+    check(1u == errors.size() and ERRORS_IDS::INVALID_QUERY == errors.begin()->second.code and
+        make_errors(ERRORS_IDS::INVALID_QUERY).begin()->second.desc == errors.begin()->second.desc,
+        "a failed lookup gives its errors back");
+
+    check(find(cache, "13.0.0.2"), "a failed lookup is cached");
+    check(find(cache, "13.0.0.3"), "a throttled request is cached");
+    check(find(cache, "13.0.0.4", info, errors) and 2u == errors.size(), "a lookup with errors of two classes is cached");
+    check(not find(cache, "13.0.0.5"), "a timeout isn't cached");
+    check(not find(cache, "13.0.0.6"), "a lookup with a transient error isn't cached");
+    check(4u == cache.get_stats().negative_hits, "negative hits are counted");
+
+    std::this_thread::sleep_for(80ms);
+
+    check(find(cache, "13.0.0.1") and find(cache, "13.0.0.2"), "failed lookups are kept for their classes' TTLs");
+    check(not find(cache, "13.0.0.3"), "a throttled request is expired by its class's TTL");
+    check(not find(cache, "13.0.0.4"), "a lookup with errors of two classes is expired by the shortest TTL");
+
+    // zero TTL disables the class
+    cache.set_negative_ttl(ipinfo::constants::NEGATIVE_CACHE_CLASSES_IDS::PROVIDER_FAILURE, 0ms);
+    insert(cache, "13.0.0.7", {}, make_errors(ERRORS_IDS::FAILED_LOOKUP));
+
+    check(not find(cache, "13.0.0.7"), "a disabled class isn't cached");
+}
+
+void
+test::check_file()
+{
+    const std::string path {
+        fmt::format("{:s}/ipinfo_cache_test_{:d}.cache",
+            std::filesystem::temp_directory_path().string(), getpid())
+    };
+
+    {
+        ipinfo::usr::cache cache{};
+
+        check(cache.open_file(path), "the file is opened");
+
+        insert(cache, "13.0.0.1", make_info("13.0.0.1", "Berlin"));
+        insert(cache, "14.0.0.1", {}, make_errors(ipinfo::constants::ERRORS_IDS::INVALID_QUERY));
+    }
+
+    // another cache reads results of the file
+    {
+        ipinfo::usr::cache cache{};
+
+        check(cache.open_file(path), "the file is opened again");
+
+        ipinfo::srv::types::info info{};
+        errors_map errors{};
+
+        check(find(cache, "13.0.0.1", info, errors) and "Berlin" == info.city.cont[HOST_ID], "a result is read from the file");
+        check(find(cache, "13.0.0.1") and 1u == cache.get_stats().file_hits, "a result of the file is moved to the memory");
+        check(find(cache, "13.0.0.2", info, errors) and "13.0.0.2" == info.ip.cont[HOST_ID], "the network's result is read from the file");
+        check(not find(cache, "14.0.0.1"), "a failed lookup isn't written to the file");
+
+        cache.invalidate("13.0.0.1");
+    }
+
+    {
+        ipinfo::usr::cache cache{};
+
+        check(cache.open_file(path), "the file is opened once again");
+        check(not find(cache, "13.0.0.1") and not find(cache, "13.0.0.2"), "the invalidated IP is dropped from the file");
+    }
+
+    std::remove(path.c_str());
+}
+
+void
+test::check_flights()
+{
+    using namespace std::chrono_literals;
+
+    ipinfo::usr::cache cache{};
+    cache.set_range_prefixes(0u, 0u);
+
+    bool is_leader{ false };
+    const access::flight_ptr flight{ access::join(cache, "13.0.0.1", is_leader) };
+
+    check(is_leader, "the first miss leads the flight");
+
+    // waiters join the flight and take the leader's result
+    const std::size_t waiters_num{ 8u };
+    std::vector<std::thread> threads{};
+    std::vector<std::string> cities(waiters_num);
+    std::vector<char> are_leaders(waiters_num, 0);
+
+    for (std::size_t i{ 0u }; i < waiters_num; i++)
+    {
+        threads.emplace_back([&, i] ()
+        {
+            bool is_thread_leader{ false };
+            const access::flight_ptr thread_flight{ access::join(cache, "13.0.0.1", is_thread_leader) };
+
+            are_leaders[i] = is_thread_leader;
+
+            ipinfo::srv::types::info info{};
+
+            if (not is_thread_leader and access::wait(thread_flight, std::chrono::steady_clock::time_point::max(), info))
+            {
+                cities[i] = info.city.cont[HOST_ID];
+            }
+        });
+    }
+
+    while (waiters_num > cache.get_stats().coalesced)
+    {
+        std::this_thread::yield();
+    }
+
+    access::land(cache, "13.0.0.1", flight, make_info("13.0.0.1", "Berlin"));
+
+    for (std::thread &thrd : threads)
+    {
+        thrd.join();
+    }
+
+    for (std::size_t i{ 0u }; i < waiters_num; i++)
+    {
+        check(not are_leaders[i], fmt::format("the waiter {:d} doesn't lead the flight", i));
+        check("Berlin" == cities[i], fmt::format("the waiter {:d} takes the leader's result", i));
+    }
+
+    check(find(cache, "13.0.0.1"), "the flight's result is cached");
+
+    // the landed flight is removed, the next miss leads a new one
+    const access::flight_ptr next_flight{ access::join(cache, "13.0.0.1", is_leader) };
+    check(is_leader and next_flight != flight, "a landed flight isn't joined");
+
+    access::land(cache, "13.0.0.1", next_flight, make_info("13.0.0.1", "Berlin"));
+
+    // a waiter gives up at its deadline
+    const access::flight_ptr slow_flight{ access::join(cache, "13.0.0.2", is_leader) };
+    const access::flight_ptr slow_waiter{ access::join(cache, "13.0.0.2", is_leader) };
+
+    ipinfo::srv::types::info info{};
+    const auto begin{ std::chrono::steady_clock::now() };
+
+    check(not is_leader and slow_waiter == slow_flight, "the second miss joins the flight");
+    check(not access::wait(slow_waiter, begin + 20ms, info), "a waiter gives up at its deadline");
+    check(std::chrono::steady_clock::now() - begin >= 20ms, "a waiter waits until its deadline");
+
+    // waiters of an abandoned flight get no result
+    access::abandon(cache, "13.0.0.2", slow_flight);
+
+    check(not access::wait(slow_waiter, std::chrono::steady_clock::time_point::max(), info), "an abandoned flight gives no result");
+    check(not find(cache, "13.0.0.2"), "an abandoned flight caches nothing");
+
+    access::join(cache, "13.0.0.2", is_leader);
+    check(is_leader, "an abandoned flight isn't joined");
+}
+
+void
+test::check_admission()
+{
+    using namespace std::chrono_literals;
+
+    // Popular IPs fill the cache, then a scan of IPs which are seen
+    // once passes through it. A popular IP is looked up a few times
+    // before the scan, an IP of the scan only once.
+
+    const std::size_t entries_num{ 64u };
+    const std::size_t lookups_num{ 8u };
+
+    for (const std::uint8_t admission_id : { ipinfo::constants::CACHE_ADMISSIONS_IDS::ALWAYS, ipinfo::constants::CACHE_ADMISSIONS_IDS::TINY_LFU })
+    {
+        const bool is_tiny_lfu{ ipinfo::constants::CACHE_ADMISSIONS_IDS::TINY_LFU == admission_id };
+        const std::string name{ is_tiny_lfu ? "TinyLFU" : "always" };
+
+        ipinfo::usr::cache cache{ entries_num, MAX_BYTES, 1h, 1u };
+        cache.set_range_prefixes(0u, 0u);
+        cache.set_admission(admission_id);
+
+        for (std::size_t i{ 0u }; i < entries_num; i++)
+        {
+            const std::string ip{ fmt::format("13.0.0.{:d}", i) };
+
+            for (std::size_t n{ 0u }; n < lookups_num; n++)
+            {
+                if (not find(cache, ip))
+                {
+                    insert(cache, ip, make_info(ip, "Berlin"));
+                }
+            }
+        }
+
+        for (std::size_t i{ 0u }; i < entries_num; i++)
+        {
+            const std::string ip{ fmt::format("14.0.0.{:d}", i) };
+
+            if (not find(cache, ip))
+            {
+                insert(cache, ip, make_info(ip, "Berlin"));
+            }
+        }
+
+        std::size_t kept_num{ 0u };
+
+        for (std::size_t i{ 0u }; i < entries_num; i++)
+        {
+            kept_num += find(cache, fmt::format("13.0.0.{:d}", i)) ? 1u : 0u;
+        }
+
+        const ipinfo::usr::types::cache_stats stats{ cache.get_stats() };
+
+        if (is_tiny_lfu)
+        {
+            check(3u * entries_num / 4u <= kept_num, fmt::format("{:s}: {:d} popular results of {:d} outlive the scan", name, kept_num, entries_num));
+            check(0u < stats.rejections, fmt::format("{:s}: results of the scan are rejected", name));
+        }
+        else
+        {
+            check(entries_num / 4u >= kept_num, fmt::format("{:s}: {:d} popular results of {:d} are flushed by the scan", name, kept_num, entries_num));
+            check(0u == stats.rejections, fmt::format("{:s}: nothing is rejected", name));
+        }
+
+        // a new IP which is looked up more often than the victim is admitted
+        for (std::size_t n{ 0u }; n < 2u * lookups_num; n++)
+        {
+            find(cache, "15.0.0.1");
+        }
+
+        insert(cache, "15.0.0.1", make_info("15.0.0.1", "Berlin"));
+        check(find(cache, "15.0.0.1"), fmt::format("{:s}: a popular new result is admitted", name));
+    }
+}
@@ -0,0 +1,196 @@
+#include <ipinfo/ipinfo_classifier.hpp> // ipinfo::srv::classifier
+#include <ipinfo/ipinfo_constants.hpp>  // ipinfo::constants
+#include <ipinfo/ipinfo_fields.hpp>     // ipinfo::srv::is_parsed
+#include <ipinfo/ipinfo_types.hpp>
+
+#include <fmt/core.h>                   // fmt::print, fmt::format
+#include <cstddef>                      // std::size_t
+#include <string>                       // std::string
+#include <utility>                      // std::pair
+#include <vector>                       // std::vector
+
+// The first and the last addresses of the special-purpose ranges must
+// be reserved, the addresses next to the ranges mustn't be. A reserved
+// IP is answered by the local source, other IPs are left to hosts.
+
+namespace test
+{
+    using sample = std::pair<std::string, bool>; // the IP and whether it's reserved
+
+    static std::size_t failures_num{ 0u };
+
+    static void
+    check(const bool is_ok,
+          const std::string &what);
+
+    static std::vector<sample>
+    make_samples();
+
+    static void
+    check_samples();
+
+    static void
+    check_info();
+}
+
+int
+main()
+{
+    test::check_samples();
+    test::check_info();
+
+    if (0u != test::failures_num)
+    {
+        fmt::print("classifier: {:d} checks failed\n", test::failures_num);
+        return 1;
+    }
+
+    fmt::print("classifier: all checks passed\n");
+    return 0;
+}
+
+void
+test::check(
+        const bool is_ok,
+        const std::string &what)
+{
+    if (not is_ok)
+    {
+        failures_num += 1u;
+
+        // a broken range fails many samples, the first ones are enough
+        if (10u >= failures_num)
+        {
+            fmt::print("failed: {:s}\n", what);
+        }
+    }
+}
+
+std::vector<test::sample>
+test::make_samples()
+{
+    return {
+        { "0.0.0.0",                                  true  },
+        { "0.255.255.255",                            true  },
+        { "1.0.0.0",                                  false },
+        { "1.1.1.1",                                  false },
+        { "8.8.8.8",                                  false },
+        { "9.255.255.255",                            false },
+        { "10.0.0.0",                                 true  },
+        { "10.255.255.255",                           true  },
+        { "11.0.0.0",                                 false },
+        { "100.63.255.255",                           false },
+        { "100.64.0.0",                               true  },
+        { "100.127.255.255",                          true  },
+        { "100.128.0.0",                              false },
+        { "127.0.0.1",                                true  },
+        { "128.0.0.0",                                false },
+        { "169.253.255.255",                          false },
+        { "169.254.0.1",                              true  },
+        { "169.255.0.0",                              false },
+        { "172.15.255.255",                           false },
+        { "172.16.0.0",                               true  },
+        { "172.31.255.255",                           true  },
+        { "172.32.0.0",                               false },
+        { "192.0.0.255",                              true  },
+        { "192.0.1.0",                                false },
+        { "192.0.2.1",                                true  },
+        { "192.0.3.0",                                false },
+        { "192.88.99.1",                              true  },
+        { "192.167.255.255",                          false },
+        { "192.168.0.0",                              true  },
+        { "192.168.255.255",                          true  },
+        { "192.169.0.0",                              false },
+        { "198.17.255.255",                           false },
+        { "198.18.0.0",                               true  },
+        { "198.19.255.255",                           true  },
+        { "198.20.0.0",                               false },
+        { "198.51.100.1",                             true  },
+        { "203.0.113.255",                            true  },
+        { "203.0.114.0",                              false },
+        { "223.255.255.255",                          false },
+        { "224.0.0.1",                                true  },
+        { "239.255.255.255",                          true  },
+        { "240.0.0.0",                                true  },
+        { "255.255.255.255",                          true  },
+
+        { "::",                                       true  },
+        { "::1",                                      true  },
+        { "::2",                                      false },
+        { "::ffff:10.0.0.1",                          true  },
+        { "::ffff:8.8.8.8",                           false },
+        { "64:ff9b:1::1",                             true  },
+        { "64:ff9b:2::1",                             false },
+        { "100::1",                                   true  },
+        { "100:0:0:1::1",                             false },
+        { "2001:2::1",                                true  },
+        { "2001:3::1",                                false },
+        { "2001:10::1",                               true  },
+        { "2001:1f:ffff::1",                          true  },
+        { "2001:20::1",                               false },
+        { "2001:db8::1",                              true  },
+        { "2001:db8:ffff:ffff:ffff:ffff:ffff:ffff",   true  },
+        { "2001:db9::",                               false },
+        { "2001:4860:4860::8888",                     false },
+        { "2a00:1450:4001:81c::200e",                 false },
+        { "3fff:fff::1",                              true  },
+        { "3fff:1000::",                              false },
+        { "5f00::1",                                  true  },
+        { "5f01::1",                                  false },
+        { "fbff:ffff::1",                             false },
+        { "fc00::1",                                  true  },
+        { "fdff:ffff::1",                             true  },
+        { "fe00::1",                                  false },
+        { "fe80::1",                                  true  },
+        { "febf:ffff::1",                             true  },
+        { "fec0::1",                                  true  },
+        { "feff:ffff::1",                             true  },
+        { "ff02::1",                                  true  },
+        { "ffff:ffff:ffff:ffff:ffff:ffff:ffff:ffff",  true  }
+    };
+}
+
+void
+test::check_samples()
+{
+    const ipinfo::srv::classifier clsf{};
+
+    for (const auto &[ip, is_reserved] : make_samples())
+    {
+        ipinfo::srv::types::info info{};
+
+        check(is_reserved == clsf.classify(ip, info),
+            fmt::format("{:s} is {:s}reserved", ip, is_reserved ? "" : "not "));
+    }
+}
+
+void
+test::check_info()
+{
+    const ipinfo::srv::classifier clsf{};
+    const std::size_t id{ ipinfo::constants::LOCAL_SOURCE_ID };
+
+    ipinfo::srv::types::info info{};
+
+    check(clsf.classify("192.168.1.1", info), "a private IPv4 is classified");
+    check("192.168.1.1" == info.ip.cont[id] and "IPv4" == info.ip_type.cont[id] and info.is_reserved.cont[id], "the local source has the IPv4");
+
+    check(ipinfo::srv::is_parsed(info, id, ipinfo::constants::INFO_FIELDS_IDS::IP) and
+        ipinfo::srv::is_parsed(info, id, ipinfo::constants::INFO_FIELDS_IDS::IP_TYPE) and
+        ipinfo::srv::is_parsed(info, id, ipinfo::constants::INFO_FIELDS_IDS::IS_RESERVED),
+        "the local source's fields are parsed");
+
+    info = {};
+
+    check(clsf.classify("fe80::1", info), "a link local IPv6 is classified");
+    check("fe80::1" == info.ip.cont[id] and "IPv6" == info.ip_type.cont[id] and info.is_reserved.cont[id], "the local source has the IPv6");
+
+    // hosts answer public IPs, the info isn't changed
+    for (const std::string ip : { "8.8.8.8", "2001:4860:4860::8888", "256.1.1.1", "1.2.3", "fe80::1::1", "" })
+    {
+        info = {};
+
+        check(not clsf.classify(ip, info), fmt::format("'{:s}' isn't classified", ip));
+        check(info.parsed == decltype(info.parsed){}, fmt::format("'{:s}' has no parsed fields", ip));
+    }
+}
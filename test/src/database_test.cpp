@@ -0,0 +1,495 @@
+#include <ipinfo/ipinfo_batch_informer.hpp>  // ipinfo::usr::batch_informer
+#include <ipinfo/ipinfo_constants.hpp>        // ipinfo::constants
+#include <ipinfo/ipinfo_database.hpp>         // ipinfo::usr::database
+#include <ipinfo/ipinfo_database_builder.hpp> // ipinfo::usr::database_builder
+#include <ipinfo/ipinfo_informer.hpp>         // ipinfo::usr::informer
+
+#include <fmt/core.h>                         // fmt::print, fmt::format
+#include <algorithm>                          // std::shuffle
+#include <array>                              // std::array
+#include <cstddef>                            // std::size_t
+#include <cstdint>                            // std::uint8_t, std::uint32_t
+#include <cstdio>                             // std::remove
+#include <filesystem>                         // std::filesystem::temp_directory_path
+#include <fstream>                            // std::ofstream
+#include <iterator>                           // std::prev
+#include <map>                                // std::map
+#include <memory>                             // std::shared_ptr, std::make_shared
+#include <random>                             // std::mt19937_64
+#include <string>                             // std::string
+#include <utility>                            // std::pair
+#include <vector>                             // std::vector
+
+#include <unistd.h>                           // getpid
+
+// A database is built from answers' files, opened and every IP of the
+// probed networks is looked up by informers, the results are checked
+// against a map of the IPs which were added. Later answers override
+// earlier ones, the gaps between IPs of the same network and record are
+// filled, and an incremental rebuild splits the ranges of the previous
+// file. The batch informer's results, which are searched for many IPs
+// at once, must be the same as the ones of single lookups. It's run
+// with a fixed seed, so a failure is repeated by the next run.
+
+namespace test
+{
+    struct record
+    {
+        std::string country_code{};
+        std::string city{};
+        std::string isp{};
+        double latitude{ 0.0 };
+        double longitude{ 0.0 };
+        bool is_hosting{ false };
+    };
+
+    constexpr std::size_t NO_RECORD{ 100u };
+
+    const std::array<record, 6u> RECORDS
+    {{
+        { "DE", "Berlin",    "First ISP",  52.5,   13.375, false },
+        { "DE", "Hamburg",   "First ISP",  53.5,   10.0,   false },
+        { "FR", "Paris",     "Second ISP", 48.875, 2.375,  true  },
+        { "NL", "Amsterdam", "Third ISP",  52.375, 4.875,  false },
+        { "US", "Ashburn",   "Hosting",    39.0,   -77.5,  true  },
+        { "JP", "Tokyo",     "Fourth ISP", 35.75,  139.75, false }
+    }};
+
+    // the IPv4 IPs which were added and their records
+    using known_ips = std::map<std::uint32_t, std::size_t>;
+
+    static std::size_t failures_num{ 0u };
+
+    static void
+    check(const bool is_ok,
+          const std::string &what);
+
+    static std::string
+    to_ip(const std::uint32_t ip);
+
+    static std::string
+    make_answer(const std::string &ip,
+                const std::size_t record_id);
+
+    static void
+    write_lines(const std::string &path,
+                const std::vector<std::string> &lines);
+
+    // The record which the database is expected to have for the IP: the
+    // last one which was added, else the one of both neighbours, if they
+    // have the same one in the same /24 network and gaps are filled.
+    static std::size_t
+    find_expected(const known_ips &known,
+                  const std::uint32_t ip,
+                  const bool is_gaps_filling);
+
+    static void
+    check_lookup(const std::shared_ptr<ipinfo::usr::database> &db,
+                 const std::string &ip,
+                 const std::size_t record_id,
+                 const std::string &what);
+
+    static void
+    check_lookups(const std::shared_ptr<ipinfo::usr::database> &db,
+                  const std::vector<std::uint32_t> &ips,
+                  const std::vector<std::size_t> &record_ids,
+                  const std::vector<std::pair<std::string, std::size_t>> &v6_ips,
+                  const std::string &what);
+
+    // the IPs are shuffled, and invalid and reserved ones are added
+    static void
+    check_batch(const std::shared_ptr<ipinfo::usr::database> &db,
+                const std::vector<std::string> &ips,
+                std::mt19937_64 &rnd,
+                const std::string &what);
+
+    static void
+    check_round_trip();
+}
+
+int
+main()
+{
+    test::check_round_trip();
+
+    if (0u != test::failures_num)
+    {
+        fmt::print("database: {:d} checks failed\n", test::failures_num);
+        return 1;
+    }
+
+    fmt::print("database: all checks passed\n");
+    return 0;
+}
+
+void
+test::check(
+        const bool is_ok,
+        const std::string &what)
+{
+    if (not is_ok)
+    {
+        failures_num += 1u;
+
+        // a broken database fails many lookups, the first ones are enough
+        if (10u >= failures_num)
+        {
+            fmt::print("failed: {:s}\n", what);
+        }
+    }
+}
+
+std::string
+test::to_ip(const std::uint32_t ip)
+{
+    return fmt::format("{:d}.{:d}.{:d}.{:d}", ip >> 24u, (ip >> 16u) & 0xFFu, (ip >> 8u) & 0xFFu, ip & 0xFFu);
+}
+
+std::string
+test::make_answer(
+        const std::string &ip,
+        const std::size_t record_id)
+{
+    const record &rec{ RECORDS.at(record_id) };
+
+    return fmt::format(
+        R"({{"status":"success","countryCode":"{:s}","city":"{:s}","isp":"{:s}",)"
+        R"("lat":{},"lon":{},"hosting":{},"query":"{:s}"}})",
+        rec.country_code, rec.city, rec.isp, rec.latitude, rec.longitude, rec.is_hosting, ip);
+}
+
+void
+test::write_lines(
+        const std::string &path,
+        const std::vector<std::string> &lines)
+{
+    std::ofstream out{ path, std::ios::trunc };
+
+    for (const std::string &line : lines)
+    {
+        out << line << '\n';
+    }
+}
+
+std::size_t
+test::find_expected(
+        const known_ips &known,
+        const std::uint32_t ip,
+        const bool is_gaps_filling)
+{
+    const auto next{ known.lower_bound(ip) };
+
+    if (known.end() != next and ip == next->first)
+    {
+        return next->second;
+    }
+
+    if (not is_gaps_filling or known.end() == next or known.begin() == next)
+    {
+        return NO_RECORD;
+    }
+
+    const auto prev{ std::prev(next) };
+
+    const bool is_filled {
+        prev->second == next->second and (prev->first >> 8u) == (next->first >> 8u)
+    };
+
+    return is_filled ? prev->second : NO_RECORD;
+}
+
+void
+test::check_lookup(
+        const std::shared_ptr<ipinfo::usr::database> &db,
+        const std::string &ip,
+        const std::size_t record_id,
+        const std::string &what)
+{
+    ipinfo::usr::informer infr{ ip, std::string{} };
+
+    infr.set_database(db, ipinfo::constants::DATABASE_MODES_IDS::EXCLUSIVE);
+    infr.run();
+
+    // an IP which isn't in the database has only the local source's error
+    if (NO_RECORD == record_id)
+    {
+        check(1u == infr.get_errors_num() and not infr.get_city_ex().is_parsed, fmt::format("{:s}: {:s} is missed", what, ip));
+        return;
+    }
+
+    const record &rec{ RECORDS.at(record_id) };
+
+    const bool is_matched {
+        0u == infr.get_errors_num() and
+        ipinfo::constants::LOCAL_SOURCE == infr.get_city_ex().host and
+        ip == infr.get_ip() and
+        rec.country_code == infr.get_country_code() and
+        rec.city == infr.get_city() and
+        rec.isp == infr.get_isp() and
+        rec.latitude == infr.get_latitude() and
+        rec.longitude == infr.get_longitude() and
+        rec.is_hosting == infr.get_hosting_status()
+    };
+
+    check(is_matched, fmt::format("{:s}: {:s} is {:s}", what, ip, rec.city));
+}
+
+void
+test::check_lookups(
+        const std::shared_ptr<ipinfo::usr::database> &db,
+        const std::vector<std::uint32_t> &ips,
+        const std::vector<std::size_t> &record_ids,
+        const std::vector<std::pair<std::string, std::size_t>> &v6_ips,
+        const std::string &what)
+{
+    for (std::size_t i{ 0u }; i < ips.size(); i++)
+    {
+        check_lookup(db, to_ip(ips[i]), record_ids[i], what);
+    }
+
+    for (const auto &[ip, record_id] : v6_ips)
+    {
+        check_lookup(db, ip, record_id, what);
+    }
+
+    // reserved IPs are answered by the classifier, even if they're added
+    ipinfo::usr::informer infr{ "10.0.0.1", std::string{} };
+
+    infr.set_database(db, ipinfo::constants::DATABASE_MODES_IDS::EXCLUSIVE);
+    infr.run();
+
+    check(infr.get_reserved_status() and not infr.get_city_ex().is_parsed, fmt::format("{:s}: 10.0.0.1 is reserved", what));
+}
+
+void
+test::check_batch(
+        const std::shared_ptr<ipinfo::usr::database> &db,
+        const std::vector<std::string> &ips,
+        std::mt19937_64 &rnd,
+        const std::string &what)
+{
+    std::vector<std::string> batch_ips{ ips };
+
+    batch_ips.insert(batch_ips.end(), { "10.0.0.1", "127.0.0.1", "::1", "256.1.1.1", "5.1.1", "not an IP", "" });
+    std::shuffle(batch_ips.begin(), batch_ips.end(), rnd);
+
+    ipinfo::usr::batch_informer batch{};
+
+    batch.set_ips(batch_ips);
+    batch.set_database(db, ipinfo::constants::DATABASE_MODES_IDS::EXCLUSIVE);
+    batch.run();
+
+    const std::vector<ipinfo::usr::informer> &results{ batch.get_results() };
+
+    check(batch_ips.size() == results.size(), fmt::format("{:s}: the batch has all results", what));
+
+    for (std::size_t i{ 0u }; i < batch_ips.size() and i < results.size(); i++)
+    {
+        const ipinfo::usr::informer &result{ results[i] };
+        ipinfo::usr::informer infr{ batch_ips[i], std::string{} };
+
+        infr.set_database(db, ipinfo::constants::DATABASE_MODES_IDS::EXCLUSIVE);
+        infr.run();
+
+        const bool is_same {
+            infr.get_errors_num() == result.get_errors_num() and
+            infr.get_city_ex().is_parsed == result.get_city_ex().is_parsed and
+            infr.get_city_ex().host == result.get_city_ex().host and
+            infr.get_ip() == result.get_ip() and
+            infr.get_country_code() == result.get_country_code() and
+            infr.get_city() == result.get_city() and
+            infr.get_isp() == result.get_isp() and
+            infr.get_latitude() == result.get_latitude() and
+            infr.get_longitude() == result.get_longitude() and
+            infr.get_hosting_status() == result.get_hosting_status() and
+            infr.get_reserved_status() == result.get_reserved_status()
+        };
+
+        check(is_same, fmt::format("{:s}: the batch's result of '{:s}' is the single one", what, batch_ips[i]));
+    }
+}
+
+void
+test::check_round_trip()
+{
+    const std::string dir{ std::filesystem::temp_directory_path().string() };
+    const std::string prefix{ fmt::format("{:s}/ipinfo_database_test.{:d}", dir, ::getpid()) };
+
+    const std::string first_answers_path{ prefix + ".first.ndjson" };
+    const std::string second_answers_path{ prefix + ".second.ndjson" };
+    const std::string db_path{ prefix + ".db" };
+
+    std::mt19937_64 rnd{ 20261017u };
+
+    const std::uint32_t hand_net{ 0x05010000u }; // 5.1.0.0/16, the hand-made cases
+    const std::uint32_t bulk_net{ 0x05020000u }; // 5.2.0.0/16, random IPs
+
+    // The first answers. 5.1.1.2 is overridden by a later line, the
+    // gap 5.1.1.6-19 is filled, the one between 5.1.1.250 and 5.1.2.5
+    // isn't (other networks), nor 5.1.3.1-9 (other records). A failed
+    // answer, a reserved IP and a broken line aren't added.
+
+    known_ips first_known{};
+    std::vector<std::string> lines{};
+
+    const auto add {
+        [&] (known_ips &known, const std::uint32_t ip, const std::size_t record_id) {
+            lines.push_back(make_answer(to_ip(ip), record_id));
+            known[ip] = record_id;
+        }
+    };
+
+    add(first_known, hand_net | 0x0101u, 0u);
+    add(first_known, hand_net | 0x0102u, 0u);
+    add(first_known, hand_net | 0x0103u, 0u);
+    add(first_known, hand_net | 0x0104u, 1u);
+    add(first_known, hand_net | 0x0105u, 0u);
+    add(first_known, hand_net | 0x0114u, 0u);
+    add(first_known, hand_net | 0x01FAu, 2u);
+    add(first_known, hand_net | 0x0205u, 2u);
+    add(first_known, hand_net | 0x0301u, 3u);
+    add(first_known, hand_net | 0x030Au, 4u);
+    add(first_known, hand_net | 0x0102u, 3u);
+
+    lines.push_back(R"({"status":"fail","message":"private range","query":"5.1.3.5"})");
+    lines.push_back(make_answer("10.0.0.1", 0u));
+    lines.push_back(R"({"status":"success","city":"Broken","query":"5.1.3.6")");
+
+    // a batch answer is an array on one line
+    lines.push_back(fmt::format("[{:s},{:s}]", make_answer("5.1.4.1", 5u), make_answer("5.1.4.3", 5u)));
+    first_known[hand_net | 0x0401u] = 5u;
+    first_known[hand_net | 0x0403u] = 5u;
+
+    // enough ranges for the index of the starts to have some entries
+    for (std::size_t i{ 0u }; i < 1500u; i++)
+    {
+        add(first_known, bulk_net | static_cast<std::uint32_t>(rnd() % 4096u), static_cast<std::size_t>(rnd() % 3u));
+    }
+
+    lines.push_back(make_answer("2a00:1::1", 4u));
+    lines.push_back(make_answer("2a00:1::9", 4u));
+    lines.push_back(make_answer("2a00:2::1", 5u));
+
+    write_lines(first_answers_path, lines);
+
+    ipinfo::usr::database_builder first_builder{};
+    first_builder.set_gaps_filling(true);
+
+    check(first_builder.add_answers(first_answers_path, "ip-api.com"), "the first answers are added");
+    check(first_builder.write(db_path), "the first database is written");
+
+    auto first_db{ std::make_shared<ipinfo::usr::database>() };
+
+    check(first_db->open(db_path), "the first database is opened");
+    check(first_builder.get_ranges_num() == first_db->get_ranges_num(), "the first database has its ranges");
+
+    std::vector<std::uint32_t> ips{};
+
+    for (std::uint32_t ip{ hand_net }; ip < (hand_net | 0x0600u); ip++)
+    {
+        ips.push_back(ip);
+    }
+
+    for (std::uint32_t ip{ bulk_net }; ip < (bulk_net | 0x1100u); ip++)
+    {
+        ips.push_back(ip);
+    }
+
+    std::vector<std::size_t> first_ids{};
+
+    for (const std::uint32_t ip : ips)
+    {
+        first_ids.push_back(find_expected(first_known, ip, true));
+    }
+
+    const std::vector<std::pair<std::string, std::size_t>> first_v6_ips {
+        { "2a00:1::",          NO_RECORD },
+        { "2a00:1::1",         4u        },
+        { "2a00:1::5",         4u        },
+        { "2a00:1::9",         4u        },
+        { "2a00:1::a",         NO_RECORD },
+        { "2a00:1:ffff::1",    NO_RECORD },
+        { "2a00:2::1",         5u        },
+        { "2a00:2::2",         NO_RECORD }
+    };
+
+    check(0u == first_ids[0x0106u] and 0u == first_ids[0x0113u], "a gap of the same record is filled");
+    check(NO_RECORD == first_ids[0x01FFu] and NO_RECORD == first_ids[0x0305u], "other gaps aren't filled");
+
+    check_lookups(first_db, ips, first_ids, first_v6_ips, "the first database");
+
+    std::vector<std::string> batch_ips{};
+
+    for (const std::uint32_t ip : ips)
+    {
+        batch_ips.push_back(to_ip(ip));
+    }
+
+    for (const auto &[ip, _] : first_v6_ips)
+    {
+        batch_ips.push_back(ip);
+    }
+
+    check_batch(first_db, batch_ips, rnd, "the first database");
+
+    // The incremental rebuild: the first database and new answers,
+    // which split its ranges. Gaps aren't filled any more, so new IPs
+    // of the same record stay apart. The file is replaced under the
+    // open database, which keeps reading the previous one.
+
+    known_ips second_known{};
+    lines.clear();
+
+    add(second_known, hand_net | 0x0103u, 5u);
+    add(second_known, hand_net | 0x010Fu, 1u);
+    add(second_known, hand_net | 0x0501u, 2u);
+    add(second_known, hand_net | 0x050Au, 2u);
+
+    for (std::size_t i{ 0u }; i < 200u; i++)
+    {
+        add(second_known, bulk_net | static_cast<std::uint32_t>(rnd() % 4096u), static_cast<std::size_t>(3u + rnd() % 3u));
+    }
+
+    lines.push_back(make_answer("2a00:1::5", 1u));
+
+    write_lines(second_answers_path, lines);
+
+    ipinfo::usr::database_builder second_builder{};
+
+    check(second_builder.add_database(db_path), "the first database is added");
+    check(second_builder.add_answers(second_answers_path, "ip-api.com"), "the second answers are added");
+    check(second_builder.write(db_path), "the second database is written");
+
+    auto second_db{ std::make_shared<ipinfo::usr::database>() };
+
+    check(second_db->open(db_path), "the second database is opened");
+    check(second_builder.get_ranges_num() == second_db->get_ranges_num(), "the second database has its ranges");
+
+    std::vector<std::size_t> second_ids{};
+
+    for (std::size_t i{ 0u }; i < ips.size(); i++)
+    {
+        const std::size_t record_id{ find_expected(second_known, ips[i], false) };
+        second_ids.push_back((NO_RECORD == record_id) ? first_ids[i] : record_id);
+    }
+
+    const std::vector<std::pair<std::string, std::size_t>> second_v6_ips {
+        { "2a00:1::",          NO_RECORD },
+        { "2a00:1::4",         4u        },
+        { "2a00:1::5",         1u        },
+        { "2a00:1::6",         4u        },
+        { "2a00:1::a",         NO_RECORD },
+        { "2a00:2::1",         5u        }
+    };
+
+    check(0u == second_ids[0x010Eu] and 1u == second_ids[0x010Fu] and 0u == second_ids[0x0110u], "a filled range is split");
+    check(NO_RECORD == second_ids[0x0505u], "gaps aren't filled, if it's disabled");
+
+    check_lookups(second_db, ips, second_ids, second_v6_ips, "the second database");
+    check_batch(second_db, batch_ips, rnd, "the second database");
+    check_lookups(first_db, ips, first_ids, first_v6_ips, "the replaced database");
+
+    std::remove(first_answers_path.c_str());
+    std::remove(second_answers_path.c_str());
+    std::remove(db_path.c_str());
+}
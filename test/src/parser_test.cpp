@@ -0,0 +1,307 @@
+#include <ipinfo/ipinfo_constants.hpp>     // ipinfo::constants
+#include <ipinfo/ipinfo_fields.hpp>        // ipinfo::srv::visit_field, ipinfo::srv::is_parsed
+#include <ipinfo/ipinfo_parser.hpp>        // ipinfo::srv::parser
+#include <ipinfo/ipinfo_stream_parser.hpp> // ipinfo::srv::stream_parser
+#include <ipinfo/ipinfo_types.hpp>
+
+#include <fmt/core.h>                      // fmt::print, fmt::format
+#include <cstddef>                         // std::size_t
+#include <cstdint>                         // std::uint8_t
+#include <string>                          // std::string
+#include <type_traits>                     // std::is_same_v
+#include <utility>                         // std::pair
+#include <vector>                          // std::vector
+
+// The same answers are given to the cJSON parser and to the streaming
+// one, both must parse the same fields to the same values. Every cut of
+// an answer and a few malformed ones must be reported by both parsers,
+// informers rely on the error to not take a partial info as a result.
+
+namespace test
+{
+    using answer = std::pair<std::string, std::string>; // the host and its answer
+
+    static std::size_t failures_num{ 0u };
+
+    static void
+    check(const bool is_ok,
+          const std::string &what);
+
+    // the fields which are parsed and their values are the same
+    static bool
+    is_same_info(const ipinfo::srv::types::info &a,
+                 const ipinfo::srv::types::info &b);
+
+    static std::vector<answer>
+    make_answers();
+
+    static void
+    check_answers();
+
+    static void
+    check_batches();
+
+    static void
+    check_broken_answers();
+}
+
+int
+main()
+{
+    test::check_answers();
+    test::check_batches();
+    test::check_broken_answers();
+
+    if (0u != test::failures_num)
+    {
+        fmt::print("parser: {:d} checks failed\n", test::failures_num);
+        return 1;
+    }
+
+    fmt::print("parser: all checks passed\n");
+    return 0;
+}
+
+void
+test::check(
+        const bool is_ok,
+        const std::string &what)
+{
+    if (not is_ok)
+    {
+        failures_num += 1u;
+
+        // every cut of a broken answer fails, the first ones are enough
+        if (10u >= failures_num)
+        {
+            fmt::print("failed: {:s}\n", what);
+        }
+    }
+}
+
+bool
+test::is_same_info(
+        const ipinfo::srv::types::info &a,
+        const ipinfo::srv::types::info &b)
+{
+    bool is_same{ a.parsed == b.parsed };
+
+    for (std::uint8_t id{ 0u }; id < ipinfo::constants::INFO_FIELDS_NUM and is_same; id++)
+    {
+        ipinfo::srv::visit_field(a, id, [&] (const auto &a_node)
+        {
+            ipinfo::srv::visit_field(b, id, [&] (const auto &b_node)
+            {
+                if constexpr (std::is_same_v<decltype(a_node), decltype(b_node)>)
+                {
+                    for (std::size_t i{ 0u }; i < ipinfo::constants::INFO_SOURCES_NUM; i++)
+                    {
+                        if (ipinfo::srv::is_parsed(a, i, id) and a_node.cont[i] != b_node.cont[i])
+                        {
+                            is_same = false;
+                        }
+                    }
+                }
+            });
+        });
+    }
+
+    return is_same;
+}
+
+std::vector<test::answer>
+test::make_answers()
+{
+    const std::string ip_api{ "ip-api.com" };
+    const std::string ipwhois{ "ipwhois.app" };
+
+    return {
+        {
+            ip_api,
+            R"({"status":"success","continent":"Europe","continentCode":"EU","country":"Germany",)"
+            R"("countryCode":"DE","region":"BE","regionName":"Land Berlin","city":"Berlin",)"
+            R"("district":"","zip":"10115","lat":52.5244,"lon":13.4105,"timezone":"Europe/Berlin",)"
+            R"("offset":7200,"currency":"EUR","isp":"Deutsche Telekom AG","org":"","as":"AS3320 Deutsche Telekom AG",)"
+            R"("reverse":"p5b0a0c1d.dip0.t-ipconnect.de","mobile":false,"proxy":false,"hosting":false,"query":"91.10.12.29"})"
+        },
+        {
+            ip_api,
+            // escapes, an unknown nested value and fields of wrong types
+            " \r\n{ \"query\" : \"8.8.8.8\" , \"city\":\"Mount\\u00e9 \\\"View\\\" \\\\ \\/ \\ud83d\\ude00\",\n"
+            "  \"extra\":{\"a\":[1,2,{\"b\":\"}]\"}],\"c\":null},\"lat\":\"37.4056\",\"lon\":-1.22e2,"
+            "\"offset\":\"-25200\",\"hosting\":\"true\",\"proxy\":null,\"mobile\":1,\"isp\":42,"
+            "\"country\":[\"United States\"],\"zip\":null } \n"
+        },
+        {
+            ip_api,
+            R"({"status":"fail","message":"invalid query","query":"999.1.1.1"})"
+        },
+        {
+            ip_api,
+            R"({"offset":3000000000.5,"lat":-0.0,"lon":1e-300,"city":""})"
+        },
+        {
+            ipwhois,
+            R"({"ip":"1.1.1.1","success":true,"type":"IPv4","continent":"Oceania","continent_code":"OC",)"
+            R"("country":"Australia","country_code":"AU","country_capital":"Canberra","country_phone":"+61",)"
+            R"("country_neighbours":"","region":"New South Wales","city":"Sydney","latitude":"-33.8688197",)"
+            R"("longitude":"151.2092955","asn":"AS13335","org":"APNIC and Cloudflare DNS Resolver project",)"
+            R"("isp":"Cloudflare, Inc.","timezone":"Australia/Sydney","timezone_name":"Australian Eastern Standard Time",)"
+            R"("timezone_dstOffset":"0","timezone_gmtOffset":"36000","timezone_gmt":"GMT +10:00",)"
+            R"("currency":"Australian Dollar","currency_code":"AUD","currency_symbol":"$","currency_rates":"1.358",)"
+            R"("currency_plural":"Australian dollars","completed_requests":12})"
+        },
+        {
+            ipwhois,
+            R"({"ip":"10.0.0.1","success":false,"message":"reserved range"})"
+        },
+        {
+            ipwhois,
+            R"({})"
+        }
+    };
+}
+
+void
+test::check_answers()
+{
+    for (const auto &[host, json] : make_answers())
+    {
+        ipinfo::srv::types::info cjson_info{};
+        ipinfo::srv::types::info stream_info{};
+        ipinfo::srv::parser cjson_prsr{};
+        ipinfo::srv::stream_parser stream_prsr{};
+
+        cjson_prsr.parse(json, cjson_info, host);
+        stream_prsr.parse(json, stream_info, host);
+
+        check(ipinfo::constants::ERRORS_IDS::NO_ERRORS == cjson_prsr.get_last_error().code, fmt::format("cJSON parses '{:s}'", json));
+        check(ipinfo::constants::ERRORS_IDS::NO_ERRORS == stream_prsr.get_last_error().code, fmt::format("the stream parser parses '{:s}'", json));
+        check(is_same_info(cjson_info, stream_info), fmt::format("both parsers have the same fields of '{:s}'", json));
+    }
+
+    // the values of the main answer, in case both parsers are wrong the same way
+    ipinfo::srv::types::info info{};
+    ipinfo::srv::stream_parser{}.parse(make_answers().front().second, info, "ip-api.com");
+
+    const std::size_t host_id{ ipinfo::constants::AVAILABLE_HOSTS_IDS::IP_API_COM };
+
+    check(
+        "Berlin" == info.city.cont[host_id] and
+        52.5244 == info.latitude.cont[host_id] and
+        7200 == info.gmt_offset.cont[host_id] and
+        not info.is_hosting.cont[host_id] and
+        ipinfo::srv::is_parsed(info, host_id, ipinfo::constants::INFO_FIELDS_IDS::IS_HOSTING) and
+        not ipinfo::srv::is_parsed(info, host_id, ipinfo::constants::INFO_FIELDS_IDS::CITY_DISTRICT),
+        "the values of the answer are parsed");
+}
+
+void
+test::check_batches()
+{
+    std::string json{ "[" };
+
+    for (const auto &[host, answ] : make_answers())
+    {
+        if ("ip-api.com" == host)
+        {
+            json += answ + ",";
+        }
+    }
+
+    // elements which aren't objects are skipped, but keep their places
+    json += "null,\"text\",[1,{}],{\"query\":\"1.0.0.1\"}]";
+
+    std::vector<ipinfo::srv::types::info> cjson_infos{};
+    std::vector<ipinfo::srv::types::info> stream_infos{};
+    ipinfo::srv::parser cjson_prsr{};
+    ipinfo::srv::stream_parser stream_prsr{};
+
+    cjson_prsr.parse_batch(json, cjson_infos, "ip-api.com");
+    stream_prsr.parse_batch(json, stream_infos, "ip-api.com");
+
+    check(ipinfo::constants::ERRORS_IDS::NO_ERRORS == cjson_prsr.get_last_error().code, "cJSON parses the batch");
+    check(ipinfo::constants::ERRORS_IDS::NO_ERRORS == stream_prsr.get_last_error().code, "the stream parser parses the batch");
+    check(8u == cjson_infos.size() and cjson_infos.size() == stream_infos.size(), "both batches have all elements");
+
+    for (std::size_t i{ 0u }; i < cjson_infos.size() and i < stream_infos.size(); i++)
+    {
+        check(is_same_info(cjson_infos[i], stream_infos[i]), fmt::format("both parsers have the same fields of the batch's element {:d}", i));
+    }
+}
+
+void
+test::check_broken_answers()
+{
+    std::vector<std::string> jsons{};
+
+    for (const auto &[host, answ] : make_answers())
+    {
+        jsons.push_back(answ);
+    }
+
+    // every cut of an answer is broken, even the one before the last brace
+    for (const std::string &json : jsons)
+    {
+        const std::size_t last{ json.find_last_of('}') };
+
+        for (std::size_t n{ 0u }; n <= last; n++)
+        {
+            const std::string cut{ json.substr(0u, n) };
+
+            ipinfo::srv::types::info info{};
+            ipinfo::srv::parser cjson_prsr{};
+            ipinfo::srv::stream_parser stream_prsr{};
+
+            cjson_prsr.parse(cut, info, "ip-api.com");
+            stream_prsr.parse(cut, info, "ip-api.com");
+
+            check(ipinfo::constants::ERRORS_IDS::NO_ERRORS != cjson_prsr.get_last_error().code, fmt::format("cJSON fails '{:s}'", cut));
+            check(ipinfo::constants::ERRORS_IDS::NO_ERRORS != stream_prsr.get_last_error().code, fmt::format("the stream parser fails '{:s}'", cut));
+        }
+    }
+
+    const std::vector<std::string> malformed {
+        R"({"query":"1.1.1.1" "city":"Sydney"})",
+        R"({"query":"1.1.1.1","city":})",
+        R"({"query":"1.1.1.1","hosting":tru})",
+        R"({"query":"1.1.1.1,"city":"Sydney"})",
+        R"({"query":"1.1.1.1","city":"\x"})",
+        R"({"query":"1.1.1.1","city":"\u12g4"})",
+        R"({query:"1.1.1.1"})",
+        R"(["1.1.1.1"])"
+    };
+
+    for (const std::string &json : malformed)
+    {
+        ipinfo::srv::types::info info{};
+        ipinfo::srv::parser cjson_prsr{};
+        ipinfo::srv::stream_parser stream_prsr{};
+
+        cjson_prsr.parse(json, info, "ip-api.com");
+        stream_prsr.parse(json, info, "ip-api.com");
+
+        check(ipinfo::constants::ERRORS_IDS::NO_ERRORS != cjson_prsr.get_last_error().code, fmt::format("cJSON fails '{:s}'", json));
+        check(ipinfo::constants::ERRORS_IDS::NO_ERRORS != stream_prsr.get_last_error().code, fmt::format("the stream parser fails '{:s}'", json));
+    }
+
+    // a batch which is cut or isn't an array
+    const std::vector<std::string> batches {
+        R"([{"query":"1.1.1.1"},{"query":"1.0.0.1")",
+        R"([{"query":"1.1.1.1"},)",
+        R"({"query":"1.1.1.1"})"
+    };
+
+    for (const std::string &json : batches)
+    {
+        std::vector<ipinfo::srv::types::info> infos{};
+        ipinfo::srv::parser cjson_prsr{};
+        ipinfo::srv::stream_parser stream_prsr{};
+
+        cjson_prsr.parse_batch(json, infos, "ip-api.com");
+        stream_prsr.parse_batch(json, infos, "ip-api.com");
+
+        check(ipinfo::constants::ERRORS_IDS::NO_ERRORS != cjson_prsr.get_last_error().code, fmt::format("cJSON fails the batch '{:s}'", json));
+        check(ipinfo::constants::ERRORS_IDS::NO_ERRORS != stream_prsr.get_last_error().code, fmt::format("the stream parser fails the batch '{:s}'", json));
+    }
+}
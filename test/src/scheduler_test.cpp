@@ -0,0 +1,279 @@
+#include <ipinfo/ipinfo_scheduler.hpp> // ipinfo::srv::scheduler
+#include <ipinfo/ipinfo_types.hpp>
+
+#include <fmt/core.h>                  // fmt::print, fmt::format
+#include <atomic>                      // std::atomic
+#include <chrono>
+#include <cstddef>                     // std::size_t
+#include <string>                      // std::string
+#include <thread>                      // std::thread, std::this_thread
+#include <vector>                      // std::vector
+
+// Token buckets of made-up hosts are drained and refilled: a bucket
+// gives its limit at once and then a token per the limit's share of a
+// minute, the host's own numbers override the bucket until its window
+// is reset, and a throttled host isn't requested until the time it
+// gives. A waiting acquisition gives up at once if the deadline comes
+// before the next token. Windows of a second are waited for, so the
+// check takes a bit more than one.
+
+namespace test
+{
+    using scheduler = ipinfo::srv::scheduler;
+    using clock = scheduler::clock;
+
+    static std::size_t failures_num{ 0u };
+
+    static void
+    check(const bool is_ok,
+          const std::string &what);
+
+    // tokens which are taken without waiting
+    static std::size_t
+    drain(const std::string &host);
+
+    static void
+    check_bucket();
+
+    static void
+    check_refill();
+
+    static void
+    check_limits();
+
+    static void
+    check_concurrent_drain();
+
+    // the host's window and the throttling are waited for together
+    static void
+    check_windows();
+}
+
+int
+main()
+{
+    test::check_bucket();
+    test::check_refill();
+    test::check_limits();
+    test::check_concurrent_drain();
+    test::check_windows();
+
+    if (0u != test::failures_num)
+    {
+        fmt::print("scheduler: {:d} checks failed\n", test::failures_num);
+        return 1;
+    }
+
+    fmt::print("scheduler: all checks passed\n");
+    return 0;
+}
+
+void
+test::check(
+        const bool is_ok,
+        const std::string &what)
+{
+    if (not is_ok)
+    {
+        failures_num += 1u;
+
+        if (10u >= failures_num)
+        {
+            fmt::print("failed: {:s}\n", what);
+        }
+    }
+}
+
+std::size_t
+test::drain(const std::string &host)
+{
+    clock::duration wait{};
+    std::size_t n{ 0u };
+
+    while (scheduler::instance().try_acquire(host, wait))
+    {
+        n += 1u;
+    }
+
+    return n;
+}
+
+void
+test::check_bucket()
+{
+    using namespace std::chrono_literals;
+
+    scheduler &schd{ scheduler::instance() };
+    const std::string host{ "bucket.test" };
+
+    schd.set_limit(host, 60u);
+
+    ipinfo::usr::types::quota quota{ schd.get_quota(host) };
+    check(quota.is_limited and 60u == quota.limit and 60u == quota.remaining, "a new bucket is full");
+
+    check(60u == drain(host), "a full bucket gives its limit at once");
+
+    // a token per second is refilled
+    clock::duration wait{};
+
+    check(not schd.try_acquire(host, wait), "an empty bucket gives nothing");
+    check(0ms < wait and wait <= 1s, "the next token is in a second");
+
+    quota = schd.get_quota(host);
+    check(0u == quota.remaining and 0ms < quota.reset_in and quota.reset_in <= 1s, "the quota of an empty bucket is reported");
+
+    // the deadline is before the next token, nothing is waited for
+    const auto begin{ clock::now() };
+
+    check(not schd.acquire(host, begin + 100ms), "a token isn't taken after the deadline");
+    check(clock::now() - begin < 100ms, "a token which won't come isn't waited for");
+}
+
+void
+test::check_refill()
+{
+    using namespace std::chrono_literals;
+
+    scheduler &schd{ scheduler::instance() };
+    const std::string host{ "refill.test" };
+
+    // a hundred tokens per second
+    schd.set_limit(host, 6000u);
+    drain(host);
+
+    const auto begin{ clock::now() };
+
+    check(schd.acquire(host, begin + 1s), "a token is waited for");
+    check(clock::now() - begin < 500ms, "a token is waited for until it's refilled");
+
+    drain(host);
+    std::this_thread::sleep_for(100ms);
+
+    const std::size_t n{ drain(host) };
+    check(5u <= n and n <= 30u, fmt::format("{:d} tokens are refilled by 100 ms instead of 10", n));
+}
+
+void
+test::check_limits()
+{
+    scheduler &schd{ scheduler::instance() };
+    clock::duration wait{};
+
+    // a host without the known limit isn't limited
+    const std::string free_host{ "free.test" };
+
+    check(not schd.get_quota(free_host).is_limited, "an unknown host isn't limited");
+
+    std::size_t taken_num{ 0u };
+
+    for (std::size_t i{ 0u }; i < 1000u; i++)
+    {
+        taken_num += schd.try_acquire(free_host, wait) ? 1u : 0u;
+    }
+
+    check(1000u == taken_num, "an unlimited host is always requested");
+
+    // a lower limit cuts the tokens, a higher one doesn't add them
+    const std::string host{ "limits.test" };
+
+    schd.set_limit(host, 60u);
+    schd.set_limit(host, 10u);
+
+    ipinfo::usr::types::quota quota{ schd.get_quota(host) };
+    check(10u == quota.limit and 10u == quota.remaining, "a lower limit cuts the tokens");
+
+    schd.set_limit(host, 100u);
+
+    quota = schd.get_quota(host);
+    check(100u == quota.limit and 10u == quota.remaining, "a higher limit keeps the tokens");
+
+    // numbers which aren't numbers are ignored
+    schd.update(host, "none", "60");
+    schd.update(host, "5", "-1");
+
+    check(10u == schd.get_quota(host).remaining, "broken numbers of the host are ignored");
+
+    schd.update(free_host, "0", "60");
+    check(schd.try_acquire(free_host, wait), "numbers of an unlimited host are ignored");
+}
+
+void
+test::check_concurrent_drain()
+{
+    scheduler &schd{ scheduler::instance() };
+    const std::string host{ "shared.test" };
+
+    schd.set_limit(host, 600u);
+
+    std::atomic<std::size_t> taken_num{ 0u };
+    std::vector<std::thread> threads{};
+
+    for (std::size_t i{ 0u }; i < 8u; i++)
+    {
+        threads.emplace_back([&] ()
+        {
+            clock::duration wait{};
+
+            for (std::size_t n{ 0u }; n < 200u; n++)
+            {
+                if (schd.try_acquire(host, wait))
+                {
+                    taken_num.fetch_add(1u);
+                }
+            }
+        });
+    }
+
+    for (std::thread &thrd : threads)
+    {
+        thrd.join();
+    }
+
+    // tokens which are refilled while the threads run are counted too
+    check(600u <= taken_num and taken_num <= 620u, fmt::format("{:d} tokens of 600 are taken by threads", taken_num.load()));
+}
+
+void
+test::check_windows()
+{
+    using namespace std::chrono_literals;
+
+    scheduler &schd{ scheduler::instance() };
+    clock::duration wait{};
+
+    // the host has 3 requests left in the window of a second
+    const std::string host{ "window.test" };
+
+    schd.set_limit(host, 100u);
+    schd.update(host, "3", "1");
+
+    ipinfo::usr::types::quota quota{ schd.get_quota(host) };
+    check(3u == quota.remaining and 0ms < quota.reset_in and quota.reset_in <= 1s, "the host's numbers are taken");
+
+    check(3u == drain(host), "the host's remaining requests are taken");
+    check(not schd.try_acquire(host, wait) and 0ms < wait and wait <= 1s, "the next token is at the window's reset");
+
+    // an unlimited host throttles us for a second
+    const std::string free_host{ "throttled.test" };
+    const auto begin{ clock::now() };
+
+    schd.throttle(free_host, "1");
+
+    check(not schd.try_acquire(free_host, wait) and 0ms < wait and wait <= 1s, "a throttled host isn't requested");
+    check(not schd.acquire(free_host, begin + 100ms), "a throttled host isn't waited for after the deadline");
+
+    check(schd.acquire(free_host, begin + 2s), "a throttled host is waited for");
+    check(clock::now() - begin >= 900ms, "a throttled host is waited for until the reset");
+
+    // the window is reset, the bucket is full again
+    std::this_thread::sleep_until(begin + 1100ms);
+
+    const std::size_t n{ drain(host) };
+    check(100u <= n and n <= 101u, fmt::format("{:d} tokens of 100 are taken after the window's reset", n));
+
+    // a throttling without the time is for a minute
+    const std::string slow_host{ "slow.test" };
+
+    schd.throttle(slow_host, "soon");
+    check(not schd.try_acquire(slow_host, wait) and 30s < wait, "a throttling without the time is long");
+}
@@ -0,0 +1,453 @@
+#include <ipinfo/ipinfo_constants.hpp> // ipinfo::constants
+#include <ipinfo/ipinfo_fields.hpp>    // ipinfo::srv::visit_field, ipinfo::srv::set_parsed
+#include <ipinfo/ipinfo_store.hpp>     // ipinfo::srv::store
+#include <ipinfo/ipinfo_types.hpp>
+
+#include <fmt/core.h>                  // fmt::print, fmt::format
+#include <chrono>
+#include <cstddef>                     // std::size_t
+#include <cstdint>                     // std::uint8_t, std::uintmax_t
+#include <cstdio>                      // std::remove
+#include <filesystem>                  // std::filesystem::file_size, std::filesystem::resize_file
+#include <fstream>                     // std::fstream
+#include <string>                      // std::string
+#include <string_view>                 // std::string_view
+#include <type_traits>                 // std::is_same_v
+#include <vector>                      // std::vector
+
+#include <unistd.h>                    // getpid
+
+// Records are appended to a file, then the file is broken the ways a
+// crash and a bad disk break it: a record's tail is torn off, a byte of
+// a record or of the header is flipped. The store must keep the records
+// before the broken one, drop the rest and go on appending. The
+// compaction must keep only live records, and a serialized info must
+// be read back as it was.
+
+namespace test
+{
+    using store = ipinfo::srv::store;
+
+    constexpr std::size_t HOST_ID{ ipinfo::constants::AVAILABLE_HOSTS_IDS::IP_API_COM };
+
+    static std::size_t failures_num{ 0u };
+
+    static void
+    check(const bool is_ok,
+          const std::string &what);
+
+    static std::string
+    make_path(const std::string &name);
+
+    static ipinfo::srv::types::info
+    make_info(const std::string &city);
+
+    // the fields which are parsed and their values are the same
+    static bool
+    is_same_info(const ipinfo::srv::types::info &a,
+                 const ipinfo::srv::types::info &b);
+
+    // the record is found and it has the city
+    static bool
+    has_record(const store &s,
+               const std::string &key,
+               const std::string &city);
+
+    static bool
+    insert(store &s,
+           const std::string &key,
+           const std::string &city);
+
+    static void
+    flip_byte(const std::string &path,
+              const std::uintmax_t offset);
+
+    static void
+    check_torn_tail();
+
+    static void
+    check_broken_records();
+
+    static void
+    check_broken_header();
+
+    static void
+    check_compaction();
+
+    static void
+    check_serialization();
+}
+
+int
+main()
+{
+    test::check_torn_tail();
+    test::check_broken_records();
+    test::check_broken_header();
+    test::check_compaction();
+    test::check_serialization();
+
+    if (0u != test::failures_num)
+    {
+        fmt::print("store: {:d} checks failed\n", test::failures_num);
+        return 1;
+    }
+
+    fmt::print("store: all checks passed\n");
+    return 0;
+}
+
+void
+test::check(
+        const bool is_ok,
+        const std::string &what)
+{
+    if (not is_ok)
+    {
+        failures_num += 1u;
+
+        // a broken file fails many lookups, the first ones are enough
+        if (10u >= failures_num)
+        {
+            fmt::print("failed: {:s}\n", what);
+        }
+    }
+}
+
+std::string
+test::make_path(const std::string &name)
+{
+    return fmt::format("{:s}/ipinfo_store_test_{:d}.{:s}",
+        std::filesystem::temp_directory_path().string(), getpid(), name);
+}
+
+ipinfo::srv::types::info
+test::make_info(const std::string &city)
+{
+    ipinfo::srv::types::info info{};
+
+    info.city.cont[HOST_ID] = city;
+    info.latitude.cont[HOST_ID] = 52.5;
+    info.gmt_offset.cont[HOST_ID] = 7200;
+    info.is_hosting.cont[HOST_ID] = true;
+
+    ipinfo::srv::set_parsed(info, HOST_ID, ipinfo::constants::INFO_FIELDS_IDS::CITY, true);
+    ipinfo::srv::set_parsed(info, HOST_ID, ipinfo::constants::INFO_FIELDS_IDS::LATITUDE, true);
+    ipinfo::srv::set_parsed(info, HOST_ID, ipinfo::constants::INFO_FIELDS_IDS::GMT_OFFSET, true);
+    ipinfo::srv::set_parsed(info, HOST_ID, ipinfo::constants::INFO_FIELDS_IDS::IS_HOSTING, true);
+
+    return info;
+}
+
+bool
+test::is_same_info(
+        const ipinfo::srv::types::info &a,
+        const ipinfo::srv::types::info &b)
+{
+    bool is_same{ a.parsed == b.parsed };
+
+    for (std::uint8_t id{ 0u }; id < ipinfo::constants::INFO_FIELDS_NUM and is_same; id++)
+    {
+        ipinfo::srv::visit_field(a, id, [&] (const auto &a_node)
+        {
+            ipinfo::srv::visit_field(b, id, [&] (const auto &b_node)
+            {
+                if constexpr (std::is_same_v<decltype(a_node), decltype(b_node)>)
+                {
+                    for (std::size_t i{ 0u }; i < ipinfo::constants::INFO_SOURCES_NUM; i++)
+                    {
+                        if (ipinfo::srv::is_parsed(a, i, id) and a_node.cont[i] != b_node.cont[i])
+                        {
+                            is_same = false;
+                        }
+                    }
+                }
+            });
+        });
+    }
+
+    return is_same;
+}
+
+bool
+test::has_record(
+        const store &s,
+        const std::string &key,
+        const std::string &city)
+{
+    ipinfo::srv::types::info info{};
+    store::clock::time_point expires_at{};
+
+    return s.find(key, info, expires_at) and is_same_info(make_info(city), info);
+}
+
+bool
+test::insert(
+        store &s,
+        const std::string &key,
+        const std::string &city)
+{
+    return s.insert(key, make_info(city), store::clock::now() + std::chrono::hours{ 1 });
+}
+
+void
+test::flip_byte(
+        const std::string &path,
+        const std::uintmax_t offset)
+{
+    std::fstream file{ path, std::ios::in | std::ios::out | std::ios::binary };
+    char c{ 0 };
+
+    file.seekg(static_cast<std::streamoff>(offset));
+    file.get(c);
+
+    file.seekp(static_cast<std::streamoff>(offset));
+    file.put(static_cast<char>(c ^ 0x5A));
+}
+
+void
+test::check_torn_tail()
+{
+    const std::string path{ make_path("torn") };
+    std::remove(path.c_str());
+
+    store s{};
+
+    check(s.open(path), "a new file is opened");
+    check(insert(s, "k1", "Berlin") and insert(s, "k2", "Hamburg"), "records are appended");
+
+    const std::uintmax_t size{ std::filesystem::file_size(path) };
+
+    check(insert(s, "k3", "Paris"), "the last record is appended");
+
+    const std::uintmax_t full_size{ std::filesystem::file_size(path) };
+
+    s.close();
+
+    // the write of the last record is torn by a crash
+    std::filesystem::resize_file(path, full_size - 5u);
+
+    check(s.open_read_only(path), "a torn file is opened to be read");
+    check(has_record(s, "k1", "Berlin") and has_record(s, "k2", "Hamburg"), "records before the torn one are read");
+    check(not has_record(s, "k3", "Paris"), "the torn record isn't read");
+    check(full_size - 5u == std::filesystem::file_size(path), "a file which is read isn't cut");
+
+    check(s.open(path), "a torn file is opened");
+    check(has_record(s, "k1", "Berlin") and has_record(s, "k2", "Hamburg"), "records before the torn one are kept");
+    check(not has_record(s, "k3", "Paris"), "the torn record is dropped");
+    check(size == std::filesystem::file_size(path), "the torn record is cut off");
+
+    // the next record is appended in place of the torn one
+    check(insert(s, "k3", "Paris"), "a record is appended after the cut");
+    s.close();
+
+    check(s.open(path), "the file is opened after the cut");
+    check(has_record(s, "k1", "Berlin") and has_record(s, "k2", "Hamburg") and has_record(s, "k3", "Paris"), "all records are read after the cut");
+    check(full_size == std::filesystem::file_size(path), "nothing is left of the torn record");
+
+    s.close();
+    std::remove(path.c_str());
+}
+
+void
+test::check_broken_records()
+{
+    const std::string path{ make_path("broken") };
+    std::remove(path.c_str());
+
+    std::vector<std::uintmax_t> ends{};
+    store s{};
+
+    check(s.open(path), "a new file is opened");
+
+    ends.push_back(std::filesystem::file_size(path));
+
+    for (const std::string key : { "k1", "k2", "k3" })
+    {
+        check(insert(s, key, "Berlin"), fmt::format("the record {:s} is appended", key));
+        ends.push_back(std::filesystem::file_size(path));
+    }
+
+    s.close();
+
+    // a byte of the last record's value is flipped, its CRC doesn't match
+    flip_byte(path, ends[3] - 3u);
+
+    check(s.open(path), "a file with a broken record is opened");
+    check(has_record(s, "k1", "Berlin") and has_record(s, "k2", "Berlin"), "records before the broken one are kept");
+    check(not has_record(s, "k3", "Berlin"), "the broken record is dropped");
+    check(ends[2] == std::filesystem::file_size(path), "the broken record is cut off");
+
+    s.close();
+
+    // The scan stops at the first broken record, records after
+    // it can't be trusted, their offsets come from broken sizes.
+    flip_byte(path, (ends[0] + ends[1]) / 2u);
+
+    check(s.open(path), "a file with a broken first record is opened");
+    check(not has_record(s, "k1", "Berlin") and not has_record(s, "k2", "Berlin"), "records from the broken one are dropped");
+    check(ends[0] == std::filesystem::file_size(path), "records from the broken one are cut off");
+    check(insert(s, "k1", "Hamburg") and has_record(s, "k1", "Hamburg"), "records are appended after the cut");
+
+    s.close();
+    std::remove(path.c_str());
+}
+
+void
+test::check_broken_header()
+{
+    const std::string path{ make_path("header") };
+    std::remove(path.c_str());
+
+    store s{};
+
+    check(s.open(path) and insert(s, "k1", "Berlin"), "a record is appended");
+    s.close();
+
+    const std::uintmax_t size{ std::filesystem::file_size(path) };
+
+    flip_byte(path, 10u);
+
+    check(not s.open(path), "a file with a broken header isn't opened");
+    check(ipinfo::constants::ERRORS_IDS::CORRUPTED_FILE == s.get_last_error().code, "the broken header is reported");
+    check(not s.is_open() and not has_record(s, "k1", "Berlin"), "nothing is read from a broken file");
+    check(size == std::filesystem::file_size(path), "a broken file isn't changed");
+
+    // the file is shorter than its header
+    std::filesystem::resize_file(path, 8u);
+
+    check(not s.open(path), "a file without a header isn't opened");
+    check(ipinfo::constants::ERRORS_IDS::CORRUPTED_FILE == s.get_last_error().code, "the missing header is reported");
+
+    check(not s.open(make_path("missing/store")), "a file in a missing directory isn't opened");
+    check(ipinfo::constants::ERRORS_IDS::FAILED_FILE_ACCESS == s.get_last_error().code, "the failed access is reported");
+
+    std::remove(path.c_str());
+}
+
+void
+test::check_compaction()
+{
+    const std::string path{ make_path("compact") };
+    std::remove(path.c_str());
+
+    store s{};
+
+    check(s.open(path), "a new file is opened");
+
+    for (const std::string key : { "k1", "k2", "k3", "k4" })
+    {
+        check(insert(s, key, "Berlin"), fmt::format("the record {:s} is appended", key));
+    }
+
+    check(insert(s, "k1", "Hamburg"), "a record is replaced");
+    check(s.erase_prefix("k2"), "a record is erased");
+    check(s.insert("k5", make_info("Paris"), store::clock::now() - std::chrono::seconds{ 1 }), "an expired record is appended");
+
+    check(s.compact(), "the file is compacted");
+    check(has_record(s, "k1", "Hamburg") and has_record(s, "k3", "Berlin") and has_record(s, "k4", "Berlin"), "live records are kept");
+    check(not has_record(s, "k2", "Berlin") and not has_record(s, "k5", "Paris"), "erased and expired records are dropped");
+
+    std::vector<std::string> keys{};
+
+    s.for_each([&keys] (const std::string_view key, const ipinfo::srv::types::info &)
+    {
+        keys.emplace_back(key);
+    });
+
+    check(std::vector<std::string>{ "k1", "k3", "k4" } == keys, "live records are walked in the keys' order");
+
+    // a record of the tail is torn, the table isn't touched
+    const std::uintmax_t size{ std::filesystem::file_size(path) };
+
+    check(insert(s, "k6", "Paris"), "a record is appended after the table");
+    s.close();
+
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 1u);
+
+    check(s.open(path), "a compacted file with a torn tail is opened");
+    check(has_record(s, "k1", "Hamburg") and has_record(s, "k3", "Berlin"), "records of the table are kept");
+    check(not has_record(s, "k6", "Paris"), "the torn record of the tail is dropped");
+    check(size == std::filesystem::file_size(path), "the torn record of the tail is cut off");
+
+    s.close();
+
+    // the table itself is cut
+    std::filesystem::resize_file(path, size - 1u);
+
+    check(not s.open(path), "a file with a cut table isn't opened");
+    check(ipinfo::constants::ERRORS_IDS::CORRUPTED_FILE == s.get_last_error().code, "the cut table is reported");
+
+    std::remove(path.c_str());
+
+    check(s.open(path) and insert(s, "k1", "Berlin") and s.compact(), "a new file is compacted");
+
+    // a reader keeps the old file, it isn't cut under its mapping
+    store reader{};
+
+    check(reader.open_read_only(path), "the file is opened by a reader");
+    check(s.clear(), "the file is cleared");
+    check(not has_record(s, "k1", "Berlin"), "the cleared file has no records");
+    check(has_record(reader, "k1", "Berlin"), "the reader's records are kept by the clearing");
+
+    reader.close();
+
+    check(insert(s, "k2", "Berlin") and has_record(s, "k2", "Berlin"), "records are appended to the cleared file");
+
+    s.close();
+
+    check(not s.is_open() and not has_record(s, "k2", "Berlin") and not insert(s, "k3", "Berlin"), "a closed store has no file");
+
+    check(s.open(path) and has_record(s, "k2", "Berlin") and not has_record(s, "k1", "Berlin"), "the cleared file is opened");
+
+    s.close();
+    std::remove(path.c_str());
+}
+
+void
+test::check_serialization()
+{
+    ipinfo::srv::types::info info{ make_info("Berlin") };
+    const std::size_t local_id{ ipinfo::constants::LOCAL_SOURCE_ID };
+
+    info.ip.cont[local_id] = "10.0.0.1";
+    info.is_reserved.cont[local_id] = true;
+    info.is_proxy.cont[HOST_ID] = false;
+    info.city.cont[local_id] = "not parsed";
+
+    ipinfo::srv::set_parsed(info, local_id, ipinfo::constants::INFO_FIELDS_IDS::IP, true);
+    ipinfo::srv::set_parsed(info, local_id, ipinfo::constants::INFO_FIELDS_IDS::IS_RESERVED, true);
+    ipinfo::srv::set_parsed(info, HOST_ID, ipinfo::constants::INFO_FIELDS_IDS::IS_PROXY, true);
+
+    std::string data{};
+    store::serialize(info, data);
+
+    ipinfo::srv::types::info read{};
+
+    check(store::deserialize(data, read), "a serialized info is read");
+    check(is_same_info(info, read), "a serialized info is read as it was");
+    check(not ipinfo::srv::is_parsed(read, local_id, ipinfo::constants::INFO_FIELDS_IDS::CITY), "values which aren't parsed aren't written");
+
+    // a byte of a bool which isn't 0 or 1 is read as true
+    ipinfo::srv::types::info flag{};
+    std::string flag_data{};
+
+    flag.is_reserved.cont[local_id] = true;
+    ipinfo::srv::set_parsed(flag, local_id, ipinfo::constants::INFO_FIELDS_IDS::IS_RESERVED, true);
+
+    store::serialize(flag, flag_data);
+    flag_data.back() = '\x7f';
+
+    read = {};
+
+    check(store::deserialize(flag_data, read) and true == read.is_reserved.cont[local_id], "a bool of any byte but 0 is true");
+
+    // every cut of the data is too short for its values
+    for (std::size_t n{ 0u }; n < data.size(); n++)
+    {
+        ipinfo::srv::types::info cut{};
+
+        check(not store::deserialize(std::string_view{ data }.substr(0u, n), cut), fmt::format("a cut of {:d} bytes isn't read", n));
+        check(cut.parsed == decltype(cut.parsed){}, fmt::format("a cut of {:d} bytes has no parsed values", n));
+    }
+}
@@ -0,0 +1,444 @@
+#include <ipinfo/ipinfo_trie.hpp> // ipinfo::srv::trie
+#include <ipinfo/ipinfo_types.hpp>
+
+#include <fmt/core.h>             // fmt::print
+#include <cstddef>                // std::size_t
+#include <cstdint>                // std::uint8_t, std::uint32_t, std::uint64_t
+#include <cstring>                // std::memcpy
+#include <random>                 // std::mt19937_64
+#include <string>                 // std::string
+#include <string_view>            // std::string_view
+#include <utility>                // std::pair
+#include <vector>                 // std::vector
+
+// The trie is checked against a linear scan of the prefixes on random
+// overlapping sets of both families, the serialized trie is viewed and
+// checked the same way, and broken files mustn't be viewed. It's run
+// with a fixed seed, so a failure is repeated by the next run.
+
+namespace test
+{
+    using prefix = ipinfo::srv::trie::prefix;
+
+    constexpr std::uint64_t V4_MAPPED_LO{ std::uint64_t{ 0xFFFFu } << 32u };
+
+    static std::size_t failures_num{ 0u };
+
+    static void
+    check(const bool is_ok,
+          const std::string &what);
+
+    // the first 'len' bits of both addresses are equal
+    static bool
+    is_matched(const prefix &pfx,
+               const std::uint64_t hi,
+               const std::uint64_t lo);
+
+    // the longest prefix wins, of equal ones the last one
+    static std::uint32_t
+    find_linearly(const std::vector<prefix> &prefixes,
+                  const std::uint64_t hi,
+                  const std::uint64_t lo);
+
+    static std::vector<prefix>
+    make_prefixes(std::mt19937_64 &rnd,
+                  const std::size_t n);
+
+    // addresses near the prefixes and random ones
+    static std::vector<std::pair<std::uint64_t, std::uint64_t>>
+    make_addresses(std::mt19937_64 &rnd,
+                   const std::vector<prefix> &prefixes,
+                   const std::size_t n);
+
+    static void
+    check_lookups(const ipinfo::srv::trie &t,
+                  const std::vector<prefix> &prefixes,
+                  const std::vector<std::pair<std::uint64_t, std::uint64_t>> &addrs,
+                  const std::string &what);
+
+    static void
+    check_random_sets();
+
+    static void
+    check_address_lookups();
+
+    static void
+    check_broken_files();
+}
+
+int
+main()
+{
+    test::check_random_sets();
+    test::check_address_lookups();
+    test::check_broken_files();
+
+    if (0u != test::failures_num)
+    {
+        fmt::print("trie: {:d} checks failed\n", test::failures_num);
+        return 1;
+    }
+
+    fmt::print("trie: all checks passed\n");
+    return 0;
+}
+
+void
+test::check(
+        const bool is_ok,
+        const std::string &what)
+{
+    if (not is_ok)
+    {
+        failures_num += 1u;
+
+        // a broken trie fails many lookups, the first ones are enough
+        if (10u >= failures_num)
+        {
+            fmt::print("failed: {:s}\n", what);
+        }
+    }
+}
+
+bool
+test::is_matched(
+        const prefix &pfx,
+        const std::uint64_t hi,
+        const std::uint64_t lo)
+{
+    const auto get_mask {
+        [] (const std::size_t bits_num) -> std::uint64_t {
+            return (0u == bits_num) ? 0u : (~std::uint64_t{ 0u } << (64u - bits_num));
+        }
+    };
+
+    if (64u >= pfx.len)
+    {
+        return 0u == ((pfx.hi ^ hi) & get_mask(pfx.len));
+    }
+
+    return pfx.hi == hi and 0u == ((pfx.lo ^ lo) & get_mask(pfx.len - 64u));
+}
+
+std::uint32_t
+test::find_linearly(
+        const std::vector<prefix> &prefixes,
+        const std::uint64_t hi,
+        const std::uint64_t lo)
+{
+    std::uint32_t value{ ipinfo::srv::trie::NO_VALUE };
+    int len{ -1 };
+
+    for (const prefix &pfx : prefixes)
+    {
+        // such values aren't taken by the trie
+        if (ipinfo::srv::trie::NO_VALUE == pfx.value or 0u != (pfx.value & 0x80000000u) or 128u < pfx.len)
+        {
+            continue;
+        }
+
+        if (static_cast<int>(pfx.len) >= len and is_matched(pfx, hi, lo))
+        {
+            value = pfx.value;
+            len = pfx.len;
+        }
+    }
+
+    return value;
+}
+
+std::vector<test::prefix>
+test::make_prefixes(
+        std::mt19937_64 &rnd,
+        const std::size_t n)
+{
+    // Prefixes are taken around a few networks, so they overlap and
+    // share nodes. Bits after a prefix's length are random, the trie
+    // must ignore them.
+
+    const std::uint64_t v4_nets[] {
+        V4_MAPPED_LO | 0x0A000000u, // 10.0.0.0
+        V4_MAPPED_LO | 0xC0A80000u, // 192.168.0.0
+        V4_MAPPED_LO | 0x05010000u  // 5.1.0.0
+    };
+
+    const std::uint64_t v6_nets[] {
+        0x20010DB800000000u,
+        0x2A00145000000000u,
+        0x0000000000000000u         // covers '::ffff:0:0/96'
+    };
+
+    std::vector<prefix> prefixes{};
+
+    for (std::size_t i{ 0u }; i < n; i++)
+    {
+        const std::uint32_t value{ 1u + static_cast<std::uint32_t>(rnd() % 1000u) };
+
+        if (0u == rnd() % 2u)
+        {
+            const std::uint64_t bits{ rnd() & ((0u == rnd() % 4u) ? 0xFFFFFFFFu : 0xFFFFu) };
+
+            prefixes.push_back({
+                .hi{ 0u },
+                .lo{ v4_nets[rnd() % 3u] ^ bits },
+                .len{ static_cast<std::uint8_t>(96u + rnd() % 33u) },
+                .value{ value }
+            });
+        }
+        else
+        {
+            const std::uint64_t net{ v6_nets[rnd() % 3u] };
+
+            // the null network gets short prefixes and mapped IPv4
+            prefixes.push_back({
+                .hi{ (0u == net) ? 0u : (net ^ (rnd() & 0xFFFFFFFFFu)) },
+                .lo{ (0u == net) ? (V4_MAPPED_LO ^ (rnd() & 0xFFFF00000000u)) : rnd() },
+                .len{ static_cast<std::uint8_t>((0u == net) ? rnd() % 97u : rnd() % 129u) },
+                .value{ value }
+            });
+        }
+    }
+
+    // values which are skipped by the trie
+    prefixes.push_back({ .hi{ 0u }, .lo{ V4_MAPPED_LO | 0x0A000000u }, .len{ 104u }, .value{ 0u } });
+    prefixes.push_back({ .hi{ 0u }, .lo{ V4_MAPPED_LO | 0x0A000000u }, .len{ 104u }, .value{ 0x80000001u } });
+
+    return prefixes;
+}
+
+std::vector<std::pair<std::uint64_t, std::uint64_t>>
+test::make_addresses(
+        std::mt19937_64 &rnd,
+        const std::vector<prefix> &prefixes,
+        const std::size_t n)
+{
+    std::vector<std::pair<std::uint64_t, std::uint64_t>> addrs{};
+
+    for (std::size_t i{ 0u }; i < n; i++)
+    {
+        const prefix &pfx{ prefixes[rnd() % prefixes.size()] };
+
+        switch (rnd() % 4u)
+        {
+            // inside the prefix, after its length
+            case 0u:
+            {
+                if (96u <= pfx.len and 0u == pfx.hi)
+                {
+                    addrs.emplace_back(0u, pfx.lo ^ (rnd() & 0xFFu));
+                }
+                else
+                {
+                    addrs.emplace_back(pfx.hi, pfx.lo ^ rnd());
+                }
+
+                break;
+            }
+
+            // near the prefix's boundary
+            case 1u:
+            {
+                addrs.emplace_back(pfx.hi, pfx.lo ^ (std::uint64_t{ 1u } << (rnd() % 32u)));
+                break;
+            }
+
+            case 2u:
+            {
+                addrs.emplace_back(0u, V4_MAPPED_LO | (rnd() & 0xFFFFFFFFu));
+                break;
+            }
+
+            default:
+            {
+                addrs.emplace_back(rnd(), rnd());
+                break;
+            }
+        }
+    }
+
+    return addrs;
+}
+
+void
+test::check_lookups(
+        const ipinfo::srv::trie &t,
+        const std::vector<prefix> &prefixes,
+        const std::vector<std::pair<std::uint64_t, std::uint64_t>> &addrs,
+        const std::string &what)
+{
+    for (const auto &[hi, lo] : addrs)
+    {
+        const std::uint32_t expected{ find_linearly(prefixes, hi, lo) };
+        const std::uint32_t found{ t.find(hi, lo) };
+
+        check(expected == found,
+            fmt::format("{:s}: {:016x}{:016x} is {:d}, not {:d}", what, hi, lo, found, expected));
+    }
+}
+
+void
+test::check_random_sets()
+{
+    std::mt19937_64 rnd{ 20261017u };
+
+    for (const std::size_t n : { 0u, 1u, 10u, 100u, 1000u, 5000u })
+    {
+        std::vector<prefix> prefixes{ make_prefixes(rnd, n) };
+        const auto addrs{ make_addresses(rnd, prefixes, 20000u) };
+
+        const ipinfo::srv::trie built{ prefixes };
+        check_lookups(built, prefixes, addrs, fmt::format("built of {:d}", n));
+
+        // The view needs 8 bytes' alignment, a string's data may
+        // have less, so the serialized trie is copied to words.
+
+        std::string data{};
+        built.serialize(data);
+
+        std::vector<std::uint64_t> words((data.size() + 7u) / 8u);
+        std::memcpy(words.data(), data.data(), data.size());
+
+        ipinfo::srv::trie viewed{};
+        const bool is_viewed{ viewed.view({ reinterpret_cast<const char *>(words.data()), data.size() }) };
+
+        check(is_viewed, fmt::format("view of {:d}", n));
+        check(built.get_size() == viewed.get_size(), fmt::format("size of the view of {:d}", n));
+
+        if (is_viewed)
+        {
+            check_lookups(viewed, prefixes, addrs, fmt::format("viewed of {:d}", n));
+        }
+    }
+}
+
+void
+test::check_address_lookups()
+{
+    // '10.1.0.0/16' as IPv4, '2001:db8::/32' and '::/0' as IPv6
+    const ipinfo::srv::trie t{ std::vector<prefix>{
+        { .hi{ 0u }, .lo{ V4_MAPPED_LO | 0x0A010000u }, .len{ 112u }, .value{ 1u } },
+        { .hi{ 0x20010DB800000000u }, .lo{ 0u }, .len{ 32u }, .value{ 2u } },
+        { .hi{ 0u }, .lo{ 0u }, .len{ 0u }, .value{ 3u } }
+    } };
+
+    const auto find {
+        [&t] (const std::vector<std::uint8_t> &bytes, const bool is_v4) -> std::uint32_t {
+            ipinfo::srv::types::address addr{ .is_v4{ is_v4 } };
+
+            for (std::size_t i{ 0u }; i < bytes.size(); i++)
+            {
+                addr.bytes[16u - bytes.size() + i] = bytes[i];
+            }
+
+            if (is_v4)
+            {
+                addr.bytes[10u] = 0xFFu;
+                addr.bytes[11u] = 0xFFu;
+            }
+
+            return t.find(addr);
+        }
+    };
+
+    check(1u == find({ 10u, 1u, 2u, 3u }, true), "10.1.2.3");
+    check(3u == find({ 10u, 2u, 2u, 3u }, true), "10.2.2.3 is covered by ::/0");
+
+    check(2u == find({ 0x20u, 0x01u, 0x0Du, 0xB8u, 0u, 0u, 0u, 0u,
+                       0u, 0u, 0u, 0u, 0u, 0u, 0u, 1u }, false), "2001:db8::1");
+
+    check(ipinfo::srv::trie::NO_VALUE == ipinfo::srv::trie{}.find(0u, V4_MAPPED_LO),
+        "an empty trie");
+}
+
+void
+test::check_broken_files()
+{
+    std::mt19937_64 rnd{ 17u };
+
+    std::vector<prefix> prefixes{ make_prefixes(rnd, 2000u) };
+    const auto addrs{ make_addresses(rnd, prefixes, 2000u) };
+
+    std::string data{};
+    ipinfo::srv::trie{ prefixes }.serialize(data);
+
+    const std::size_t words_num{ (data.size() + 7u) / 8u };
+
+    // the trie views the words, they must outlive its lookups
+    std::vector<std::uint64_t> words(words_num);
+
+    const auto view {
+        [&words] (const std::string &bytes, ipinfo::srv::trie &t) -> bool {
+            std::memcpy(words.data(), bytes.data(), bytes.size());
+            return t.view({ reinterpret_cast<const char *>(words.data()), bytes.size() });
+        }
+    };
+
+    // the header is the magic, the version, and numbers of nodes and leaves
+    const std::size_t nodes_num_offset{ 16u }, leaves_num_offset{ 24u };
+    const std::size_t table_offset{ 32u };
+
+    {
+        std::string broken{ data };
+        broken[0u] = 'X';
+
+        ipinfo::srv::trie t{};
+        check(not view(broken, t), "a wrong magic is viewed");
+    }
+
+    {
+        std::string broken{ data };
+        broken[8u] += 1;
+
+        ipinfo::srv::trie t{};
+        check(not view(broken, t), "a wrong version is viewed");
+    }
+
+    {
+        ipinfo::srv::trie t{};
+        check(not view(data.substr(0u, data.size() - 1u), t), "a cut file is viewed");
+        check(not view(data.substr(0u, table_offset + 100u), t), "a file without the table is viewed");
+    }
+
+    for (const std::size_t offset : { nodes_num_offset, leaves_num_offset })
+    {
+        std::string broken{ data };
+        const std::uint64_t n{ 0xFFFFFFFFFFu };
+        std::memcpy(broken.data() + offset, &n, sizeof(n));
+
+        ipinfo::srv::trie t{};
+        check(not view(broken, t), fmt::format("a huge number at {:d} is viewed", offset));
+    }
+
+    {
+        // a node's index out of the nodes
+        std::string broken{ data };
+        const std::uint32_t entry{ 0x80000000u | 0x7FFFFFFFu };
+        std::memcpy(broken.data() + table_offset, &entry, sizeof(entry));
+
+        ipinfo::srv::trie t{};
+        check(not view(broken, t), "a wrong node's index is viewed");
+    }
+
+    // Random damage may be viewed, if indexes stay in bounds, then
+    // lookups are wrong but mustn't read out of the data.
+
+    for (std::size_t i{ 0u }; i < 200u; i++)
+    {
+        std::string broken{ data };
+
+        for (std::size_t k{ 0u }; k < 8u; k++)
+        {
+            broken[table_offset + rnd() % (broken.size() - table_offset)] = static_cast<char>(rnd());
+        }
+
+        ipinfo::srv::trie t{};
+
+        if (view(broken, t))
+        {
+            for (const auto &[hi, lo] : addrs)
+            {
+                static_cast<void>(t.find(hi, lo));
+            }
+        }
+    }
+}
@@ -26,6 +26,9 @@ $make --makefile=Makefile \
 $make --makefile=Makefile \
       --always-make &&
 
+$make --makefile=Makefile \
+      check &&
+
 for bundle in "${test_bundles[@]}"
 do
     $echo -e "Args: ${colors[0]}\"$bundle\"${colors[1]}:"